@@ -0,0 +1,309 @@
+#include "include/actorstore.h"
+#include "include/constants.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+static const Uint16 InvalidEvent = 0xFFFF;
+
+// Each array in turn for SaveState() and RestoreState(), advancing through the blob
+template <class T> static void SaveArray(Uint8 *&pState, const T *pArray, Uint16 count)
+{
+    SDL_memcpy(pState, pArray, count * sizeof(T));
+    pState += count * sizeof(T);
+}
+
+template <class T> static void RestoreArray(const Uint8 *&pState, T *pArray, Uint16 count)
+{
+    SDL_memcpy(pArray, pState, count * sizeof(T));
+    pState += count * sizeof(T);
+}
+
+ActorStore::ActorStore(AnimationRegistry *pAnimations) :
+    _pAnimations(pAnimations),
+    _cCapacity(0),
+    _cActors(0),
+    _clockTicks(0),
+    _pX(nullptr),
+    _pY(nullptr),
+    _pDX(nullptr),
+    _pDY(nullptr),
+    _pPrevX(nullptr),
+    _pPrevY(nullptr),
+    _tileSize(0),
+    _pTileRow(nullptr),
+    _pTileCol(nullptr),
+    _pTileEvents(nullptr),
+    _pTileEventIndex(nullptr),
+    _cTileEvents(0),
+    _pRow(nullptr),
+    _pCol(nullptr),
+    _pMode(nullptr),
+    _pClip(nullptr),
+    _pFrameIndex(nullptr),
+    _pAnimationCounter(nullptr)
+#ifdef ENABLE_PROFILER
+    , _pTrace(nullptr)
+#endif
+{
+    SDL_memset(&_mapBounds, 0, sizeof(_mapBounds));
+}
+
+// The arrays belong to the arena
+ActorStore::~ActorStore()
+{
+}
+
+// Every array is allocated up front, so an ActorId (index) stays valid for the life of the store
+bool ActorStore::Reserve(Uint16 cCapacity, Arena *pArena)
+{
+    SDL_assert(_cCapacity == 0);
+    SDL_assert(cCapacity > 0);
+
+    _cCapacity = cCapacity;
+    _pX = pArena->Allocate<Coord>(_cCapacity);
+    _pY = pArena->Allocate<Coord>(_cCapacity);
+    _pDX = pArena->Allocate<Coord>(_cCapacity);
+    _pDY = pArena->Allocate<Coord>(_cCapacity);
+    _pPrevX = pArena->Allocate<Coord>(_cCapacity);
+    _pPrevY = pArena->Allocate<Coord>(_cCapacity);
+    _pTileRow = pArena->Allocate<Uint16>(_cCapacity);
+    _pTileCol = pArena->Allocate<Uint16>(_cCapacity);
+    _pTileEvents = pArena->Allocate<TileEnteredEvent>(_cCapacity);
+    _pTileEventIndex = pArena->Allocate<Uint16>(_cCapacity);
+    _pRow = pArena->Allocate<Uint16>(_cCapacity);
+    _pCol = pArena->Allocate<Uint16>(_cCapacity);
+    _pMode = pArena->Allocate<Uint8>(_cCapacity);
+    _pClip = pArena->Allocate<ClipId>(_cCapacity);
+    _pFrameIndex = pArena->Allocate<Uint16>(_cCapacity);
+    _pAnimationCounter = pArena->Allocate<Uint16>(_cCapacity);
+    return true;
+}
+
+size_t ActorStore::ArenaBytes(Uint16 cCapacity)
+{
+    return (6 * Arena::Bytes<Coord>(cCapacity)) + (7 * Arena::Bytes<Uint16>(cCapacity)) +
+        Arena::Bytes<TileEnteredEvent>(cCapacity) + Arena::Bytes<Uint8>(cCapacity) + Arena::Bytes<ClipId>(cCapacity);
+}
+
+ActorId ActorStore::Add()
+{
+    // Running out of slots is a programming error, the capacity is known up front
+    SDL_assert(_cActors < _cCapacity);
+    ActorId id = _cActors++;
+
+    _pX[id] = 0;
+    _pY[id] = 0;
+    _pDX[id] = 0;
+    _pDY[id] = 0;
+    _pPrevX[id] = 0;
+    _pPrevY[id] = 0;
+    _pTileRow[id] = OffMap;
+    _pTileCol[id] = OffMap;
+    _pTileEventIndex[id] = InvalidEvent;
+    _pRow[id] = 0;
+    _pCol[id] = 0;
+    _pMode[id] = 0;
+    _pClip[id] = AnimationRegistry::InvalidClip;
+    _pFrameIndex[id] = 0;
+    _pAnimationCounter[id] = 0;
+    return id;
+}
+
+// Movement integration and animation for every actor.  Each field is walked in its own loop so the
+// compiler is free to vectorize the position updates
+void ActorStore::Update()
+{
+    _clockTicks += Constants::TicksPerFrame;
+
+    for (Uint16 i = 0; i < _cActors; i++)
+    {
+        _pPrevX[i] = _pX[i];
+        _pX[i] += _pDX[i];
+    }
+
+    for (Uint16 i = 0; i < _cActors; i++)
+    {
+        _pPrevY[i] = _pY[i];
+        _pY[i] += _pDY[i];
+    }
+
+    for (Uint16 i = 0; i < _cActors; i++)
+    {
+        UpdateTile(i);
+    }
+
+    for (Uint16 i = 0; i < _cActors; i++)
+    {
+        // Not animated
+        if (_pClip[i] == AnimationRegistry::InvalidClip)
+        {
+            continue;
+        }
+
+        // Assumes we don't foolishly set the delay to max Uint16 value
+        const SpriteAnimation &clip = _pAnimations->Clip(_pClip[i]);
+        _pAnimationCounter[i]++;
+        if (_pAnimationCounter[i] >= clip.speed)
+        {
+            _pAnimationCounter[i] = 0;
+
+            // Just advance while we're 1 or more away from the end
+            // we're 0 indexed so this is -2 from the total
+            if (_pFrameIndex[i] <= (clip.cFrames - 2))
+            {
+                _pFrameIndex[i]++;
+            }
+            else if (clip.type == AnimationType::Loop)
+            {
+                // Now if looping, start the animation over, otherwise do nothing
+                _pFrameIndex[i] = 0;
+            }
+        }
+    }
+}
+
+void ActorStore::SetTileLayout(const SDL_Rect &bounds, Uint16 tileSize)
+{
+    SDL_assert(tileSize > 0);
+    _mapBounds = bounds;
+    _tileSize = tileSize;
+
+    for (Uint16 i = 0; i < _cActors; i++)
+    {
+        UpdateTile(i);
+    }
+}
+
+bool ActorStore::TileAt(Coord x, Coord y, Uint16 &row, Uint16 &col)
+{
+    // Truncated to whole pixels first, exactly as the callers of GetTileRowCol() always have
+    int xPixel = CoordToInt(x) - _mapBounds.x;
+    int yPixel = CoordToInt(y) - _mapBounds.y;
+    if ((_tileSize == 0) || (xPixel < 0) || (yPixel < 0) || (xPixel >= _mapBounds.w) || (yPixel >= _mapBounds.h))
+    {
+        return false;
+    }
+
+    row = static_cast<Uint16>(yPixel / _tileSize);
+    col = static_cast<Uint16>(xPixel / _tileSize);
+    return true;
+}
+
+// Called whenever the position changes.  Cheap when the actor stays in its tile (the common case),
+// otherwise the new tile is stored and an event raised
+void ActorStore::UpdateTile(ActorId id)
+{
+    Uint16 row = OffMap;
+    Uint16 col = OffMap;
+    TileAt(_pX[id], _pY[id], row, col);
+    if ((row == _pTileRow[id]) && (col == _pTileCol[id]))
+    {
+        return;
+    }
+
+    _pTileRow[id] = row;
+    _pTileCol[id] = col;
+
+    // Reuse the actor's pending event if it has one, only where it ended up matters
+    if (_pTileEventIndex[id] == InvalidEvent)
+    {
+        SDL_assert(_cTileEvents < _cCapacity);
+        _pTileEventIndex[id] = _cTileEvents++;
+    }
+    _pTileEvents[_pTileEventIndex[id]] = { id, row, col };
+}
+
+void ActorStore::ClearTileEvents()
+{
+    for (Uint16 i = 0; i < _cTileEvents; i++)
+    {
+        _pTileEventIndex[_pTileEvents[i].id] = InvalidEvent;
+    }
+    _cTileEvents = 0;
+}
+
+// FNV-1a over each array in turn, cheap enough to run every tick for a normal sized roster
+Uint32 ActorStore::Checksum()
+{
+    struct Hasher
+    {
+        Uint32 hash;
+        void Add(const void *pData, size_t cb)
+        {
+            const Uint8 *pBytes = static_cast<const Uint8*>(pData);
+            for (size_t i = 0; i < cb; i++)
+            {
+                hash = (hash ^ pBytes[i]) * 16777619u;
+            }
+        }
+    };
+
+    Hasher hasher = { 2166136261u };
+    hasher.Add(&_clockTicks, sizeof(_clockTicks));
+    hasher.Add(_pX, _cActors * sizeof(*_pX));
+    hasher.Add(_pY, _cActors * sizeof(*_pY));
+    hasher.Add(_pDX, _cActors * sizeof(*_pDX));
+    hasher.Add(_pDY, _cActors * sizeof(*_pDY));
+    hasher.Add(_pRow, _cActors * sizeof(*_pRow));
+    hasher.Add(_pCol, _cActors * sizeof(*_pCol));
+    hasher.Add(_pMode, _cActors * sizeof(*_pMode));
+    hasher.Add(_pClip, _cActors * sizeof(*_pClip));
+    hasher.Add(_pFrameIndex, _cActors * sizeof(*_pFrameIndex));
+    return hasher.hash;
+}
+
+size_t ActorStore::StateBytes(Uint16 cActors)
+{
+    return sizeof(Uint32) + sizeof(Uint16) + (cActors * ((6 * sizeof(Coord)) + (7 * sizeof(Uint16)) +
+        sizeof(TileEnteredEvent) + sizeof(Uint8) + sizeof(ClipId)));
+}
+
+// The events past the pending ones are left over from earlier ticks, they're zeroed so two saves of the
+// same state compare equal byte for byte
+void ActorStore::SaveState(Uint8 *pState)
+{
+    SaveArray(pState, &_clockTicks, 1);
+    SaveArray(pState, &_cTileEvents, 1);
+    SaveArray(pState, _pX, _cActors);
+    SaveArray(pState, _pY, _cActors);
+    SaveArray(pState, _pDX, _cActors);
+    SaveArray(pState, _pDY, _cActors);
+    SaveArray(pState, _pPrevX, _cActors);
+    SaveArray(pState, _pPrevY, _cActors);
+    SaveArray(pState, _pTileRow, _cActors);
+    SaveArray(pState, _pTileCol, _cActors);
+    SaveArray(pState, _pTileEvents, _cTileEvents);
+    SDL_memset(pState, 0, (_cActors - _cTileEvents) * sizeof(TileEnteredEvent));
+    pState += (_cActors - _cTileEvents) * sizeof(TileEnteredEvent);
+    SaveArray(pState, _pTileEventIndex, _cActors);
+    SaveArray(pState, _pRow, _cActors);
+    SaveArray(pState, _pCol, _cActors);
+    SaveArray(pState, _pMode, _cActors);
+    SaveArray(pState, _pClip, _cActors);
+    SaveArray(pState, _pFrameIndex, _cActors);
+    SaveArray(pState, _pAnimationCounter, _cActors);
+}
+
+// The actors have to have been added already, in the same order as when it was saved
+void ActorStore::RestoreState(const Uint8 *pState)
+{
+    RestoreArray(pState, &_clockTicks, 1);
+    RestoreArray(pState, &_cTileEvents, 1);
+    SDL_assert(_cTileEvents <= _cActors);
+    RestoreArray(pState, _pX, _cActors);
+    RestoreArray(pState, _pY, _cActors);
+    RestoreArray(pState, _pDX, _cActors);
+    RestoreArray(pState, _pDY, _cActors);
+    RestoreArray(pState, _pPrevX, _cActors);
+    RestoreArray(pState, _pPrevY, _cActors);
+    RestoreArray(pState, _pTileRow, _cActors);
+    RestoreArray(pState, _pTileCol, _cActors);
+    RestoreArray(pState, _pTileEvents, _cActors);
+    RestoreArray(pState, _pTileEventIndex, _cActors);
+    RestoreArray(pState, _pRow, _cActors);
+    RestoreArray(pState, _pCol, _cActors);
+    RestoreArray(pState, _pMode, _cActors);
+    RestoreArray(pState, _pClip, _cActors);
+    RestoreArray(pState, _pFrameIndex, _cActors);
+    RestoreArray(pState, _pAnimationCounter, _cActors);
+}
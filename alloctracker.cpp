@@ -0,0 +1,154 @@
+#include "include/alloctracker.h"
+
+#ifdef ENABLE_ALLOC_TRACKER
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    const int SubsystemCount = static_cast<int>(AllocSubsystem::Count);
+    const Uint32 MaxFramesReported = 10;    // After that the bad frames are only counted
+
+    std::atomic<Uint64> s_cAllocations(0);
+    std::atomic<Uint64> s_cBytes(0);
+    std::atomic<Uint64> s_cFrees(0);
+    std::atomic<Uint64> s_subsystemAllocations[SubsystemCount];
+
+    thread_local AllocSubsystem t_subsystem = AllocSubsystem::Other;
+    thread_local bool t_fInFrame = false;
+
+    // The current frame, only touched by the game loop's thread
+    bool s_fSteadyState = false;
+    Uint64 s_frame = 0;
+    Uint32 s_cFrameAllocations = 0;
+    Uint64 s_cFrameBytes = 0;
+    Uint32 s_frameSubsystemAllocations[SubsystemCount];
+    Uint32 s_cBadFrames = 0;
+}
+
+const char* XplatGameTutorial::PacManClone::AllocSubsystemName(AllocSubsystem subsystem)
+{
+    static const char *Names[] = { "Other", "Loading", "Level", "Input", "Players", "Ghosts", "Collision", "Render" };
+    static_assert(SDL_arraysize(Names) == SubsystemCount, "Every subsystem needs a name");
+    return Names[static_cast<int>(subsystem)];
+}
+
+void AllocationTracker::BeginFrame(bool fSteadyState)
+{
+    t_fInFrame = true;
+    s_fSteadyState = fSteadyState;
+    s_cFrameAllocations = 0;
+    s_cFrameBytes = 0;
+    SDL_zero(s_frameSubsystemAllocations);
+}
+
+void AllocationTracker::EndFrame()
+{
+    SDL_assert(t_fInFrame);
+    t_fInFrame = false;
+    if (s_fSteadyState && (s_cFrameAllocations > 0))
+    {
+        s_cBadFrames++;
+        if (s_cBadFrames <= MaxFramesReported)
+        {
+            printf("Frame %llu allocated %u times (%llu bytes) during gameplay:", static_cast<unsigned long long>(s_frame),
+                s_cFrameAllocations, static_cast<unsigned long long>(s_cFrameBytes));
+            for (int i = 0; i < SubsystemCount; i++)
+            {
+                if (s_frameSubsystemAllocations[i] > 0)
+                {
+                    printf(" %s %u", AllocSubsystemName(static_cast<AllocSubsystem>(i)), s_frameSubsystemAllocations[i]);
+                }
+            }
+            printf("\n");
+        }
+        SDL_assert(s_cFrameAllocations == 0);
+    }
+    s_frame++;
+}
+
+void AllocationTracker::Report()
+{
+    printf("Allocations: %llu (%llu bytes), frees: %llu\n", static_cast<unsigned long long>(s_cAllocations.load()),
+        static_cast<unsigned long long>(s_cBytes.load()), static_cast<unsigned long long>(s_cFrees.load()));
+    for (int i = 0; i < SubsystemCount; i++)
+    {
+        printf("  %-10s %llu\n", AllocSubsystemName(static_cast<AllocSubsystem>(i)),
+            static_cast<unsigned long long>(s_subsystemAllocations[i].load()));
+    }
+    printf("Frames that allocated during gameplay: %u of %llu\n", s_cBadFrames, static_cast<unsigned long long>(s_frame));
+}
+
+Uint64 AllocationTracker::TotalAllocations()
+{
+    return s_cAllocations.load(std::memory_order_relaxed);
+}
+
+Uint64 AllocationTracker::TotalBytes()
+{
+    return s_cBytes.load(std::memory_order_relaxed);
+}
+
+// Must not allocate itself
+void AllocationTracker::OnAllocate(size_t cb)
+{
+    s_cAllocations.fetch_add(1, std::memory_order_relaxed);
+    s_cBytes.fetch_add(cb, std::memory_order_relaxed);
+    s_subsystemAllocations[static_cast<int>(t_subsystem)].fetch_add(1, std::memory_order_relaxed);
+    if (t_fInFrame)
+    {
+        s_cFrameAllocations++;
+        s_cFrameBytes += cb;
+        s_frameSubsystemAllocations[static_cast<int>(t_subsystem)]++;
+    }
+}
+
+void AllocationTracker::OnFree()
+{
+    s_cFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+AllocationScope::AllocationScope(AllocSubsystem subsystem) :
+    _prevSubsystem(t_subsystem)
+{
+    t_subsystem = subsystem;
+}
+
+AllocationScope::~AllocationScope()
+{
+    t_subsystem = _prevSubsystem;
+}
+
+void* operator new(size_t cb)
+{
+    AllocationTracker::OnAllocate(cb);
+    void *p = malloc((cb > 0) ? cb : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t cb)
+{
+    return operator new(cb);
+}
+
+void operator delete(void *p) noexcept
+{
+    if (p != nullptr)
+    {
+        AllocationTracker::OnFree();
+        free(p);
+    }
+}
+
+void operator delete[](void *p) noexcept
+{
+    operator delete(p);
+}
+#endif
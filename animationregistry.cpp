@@ -0,0 +1,68 @@
+#include "include/animationregistry.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+AnimationRegistry::AnimationRegistry() :
+    _cClips(0)
+{
+    for (size_t i = 0; i < SDL_arraysize(_pFrameTables); i++)
+    {
+        _pFrameTables[i] = nullptr;
+        _cFrameTableSize[i] = 0;
+    }
+
+    for (size_t i = 0; i < SDL_arraysize(_clipSetBase); i++)
+    {
+        _clipSetBase[i] = InvalidClip;
+    }
+    SDL_memset(_clips, 0, sizeof(_clips));
+}
+
+AnimationRegistry::~AnimationRegistry()
+{
+    for (size_t i = 0; i < SDL_arraysize(_pFrameTables); i++)
+    {
+        delete[] _pFrameTables[i];
+        _pFrameTables[i] = nullptr;
+    }
+}
+
+SDL_Rect* AnimationRegistry::FrameTable(FrameTableId id, Uint16 cFrames, bool *pfNeedsLoad)
+{
+    size_t index = static_cast<size_t>(id);
+    *pfNeedsLoad = false;
+    if (_pFrameTables[index] == nullptr)
+    {
+        _pFrameTables[index] = new SDL_Rect[cFrames]{ {0,0,0,0} };
+        _cFrameTableSize[index] = cFrames;
+        *pfNeedsLoad = true;
+    }
+
+    // Everyone sharing the table should agree on its size
+    SDL_assert(_cFrameTableSize[index] == cFrames);
+    return _pFrameTables[index];
+}
+
+ClipId AnimationRegistry::ClipSet(ClipSetId id, Uint16 cClips, bool *pfNeedsLoad)
+{
+    size_t index = static_cast<size_t>(id);
+    *pfNeedsLoad = false;
+    if (_clipSetBase[index] == InvalidClip)
+    {
+        // The set of clips is fixed at compile time, so running out is a programming error
+        SDL_assert(_cClips + cClips <= c_maxClips);
+        _clipSetBase[index] = _cClips;
+        _cClips += cClips;
+        *pfNeedsLoad = true;
+    }
+    return _clipSetBase[index];
+}
+
+void AnimationRegistry::SetClip(ClipId clipId, const int* pSequence, Uint16 cFrames, AnimationType animationType, Uint16 animationSpeed)
+{
+    SDL_assert(clipId < _cClips);
+    _clips[clipId].pSequence = pSequence;
+    _clips[clipId].cFrames = cFrames;
+    _clips[clipId].speed = animationSpeed;
+    _clips[clipId].type = animationType;
+}
@@ -0,0 +1,51 @@
+#include "include/arena.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+Arena::Arena() :
+    _pBase(nullptr),
+    _cbCapacity(0),
+    _cbUsed(0),
+    _cbHighWater(0)
+{
+}
+
+Arena::~Arena()
+{
+    delete[] _pBase;
+}
+
+bool Arena::Reserve(size_t cbCapacity)
+{
+    SDL_assert(_pBase == nullptr);
+    SDL_assert(cbCapacity > 0);
+
+    // new[] hands back memory aligned for any fundamental type, the offsets are aligned from there
+    _pBase = new Uint8[cbCapacity];
+    _cbCapacity = cbCapacity;
+    _cbUsed = 0;
+    return true;
+}
+
+void Arena::Rewind(size_t mark)
+{
+    SDL_assert(mark <= _cbUsed);
+    _cbUsed = mark;
+}
+
+void* Arena::AllocateBytes(size_t cb, size_t alignment)
+{
+    SDL_assert((alignment & (alignment - 1)) == 0);
+    size_t offset = (_cbUsed + alignment - 1) & ~(alignment - 1);
+    SDL_assert((_pBase != nullptr) && (offset + cb <= _cbCapacity));
+    if ((_pBase == nullptr) || (offset + cb > _cbCapacity))
+    {
+        return nullptr;
+    }
+
+    _cbUsed = offset + cb;
+    _cbHighWater = SDL_max(_cbHighWater, _cbUsed);
+    void *p = _pBase + offset;
+    SDL_memset(p, 0, cb);
+    return p;
+}
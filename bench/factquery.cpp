@@ -0,0 +1,545 @@
+// factquery.cpp : Builds a fact file (see factstore.h) from recorded sessions, by playing each one back
+// headless, and answers questions about the games in it.  The queries map the file and scan its segments
+// on every core, each thread into a result of its own which are added up at the end, e.g.
+//   factquery build games.pmcf session1.pmcr session2.pmcr
+//   factquery --after 3000 deaths games.pmcf
+//   factquery scatter games.pmcf
+//   factquery --layer ghosts heatmap games.pmcf
+//
+#include "../include/gameharness.h"
+#include <stdlib.h>
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    const Uint32 ExitFailed = 1;
+    const Uint32 NoRun = 0xFFFFFFFF;
+
+    // Scatter runs are counted in half second buckets, the last takes anything longer
+    const Uint32 ScatterBucketTicks = Constants::FramesPerSecond / 2;
+    const Uint32 ScatterBuckets = 48;
+
+    struct QueryOptions
+    {
+        QueryOptions() :
+            cThreads(0),
+            after(-1),
+            cTop(10),
+            layer(HeatmapLayer::Players),
+            szCommand(nullptr),
+            szFactFile(nullptr),
+            cReplays(0),
+            pszReplays(nullptr)
+        {
+        }
+
+        Uint32 cThreads;                    // 0 is one per core
+        Sint64 after;                       // Only events after this tick of their game
+        Uint32 cTop;                        // Tiles listed by deaths
+        HeatmapLayer layer;                 // Drawn by heatmap
+        const char *szCommand;
+        const char *szFactFile;
+        int cReplays;                       // build only
+        char **pszReplays;                  // Points into argv
+    };
+
+    // Each thread's share of a query, added up once they're done
+    struct SummaryContext
+    {
+        Uint64 cEvents[static_cast<int>(FactEvent::Count)];
+        Uint64 cStressTicks;
+        Uint16 maxLevel;
+    };
+
+    struct DeathsContext
+    {
+        Sint64 after;
+        Uint32 cCells;
+        Uint32 *pCounts;                    // Per cell, and one more for off the map
+        Uint64 cDeaths;
+    };
+
+    struct ScatterContext
+    {
+        Uint32 *pRunStart;                  // Per ghost of the game being scanned, NoRun if it isn't scattering
+        Uint64 histogram[ScatterBuckets];
+        Uint64 cRuns;
+        Uint64 cRunTicks;
+        Uint32 longestRun;
+        Uint64 cUnfinished;                 // Still scattering when the game ended
+    };
+
+    void PrintUsage(const char *szExe)
+    {
+        printf("usage: %s build <facts> <replay>...   play the replays (see --record in the game) and store their facts\n", szExe);
+        printf("       %s [options] <query> <facts>\n", szExe);
+        printf("queries:\n");
+        printf("  summary                       games, ticks and events\n");
+        printf("  deaths                        the tiles players are caught on (stress mode games)\n");
+        printf("  scatter                       how long the ghosts' scatter mode lasts\n");
+        printf("  heatmap                       one of the heatmaps the game overlays with --heatmap, as text\n");
+        printf("options:\n");
+        printf("  --threads <n>                 threads to scan with (default one per core)\n");
+        printf("  --after <tick>                deaths, only those after this tick of their game\n");
+        printf("  --top <n>                     deaths, how many tiles to list (default 10)\n");
+        printf("  --layer <name>                heatmap, players (the default), ghosts, pellets or collisions\n");
+    }
+
+    bool ParseQueryOptions(int argc, char* argv[], QueryOptions *pOptions)
+    {
+        int i = 1;
+        for (; (i < argc) && (argv[i][0] == '-'); i++)
+        {
+            bool fHasValue = (i + 1 < argc);
+            if ((SDL_strcmp(argv[i], "--threads") == 0) && fHasValue)
+            {
+                pOptions->cThreads = static_cast<Uint32>(SDL_strtoul(argv[++i], nullptr, 10));
+            }
+            else if ((SDL_strcmp(argv[i], "--after") == 0) && fHasValue)
+            {
+                pOptions->after = SDL_strtoll(argv[++i], nullptr, 10);
+            }
+            else if ((SDL_strcmp(argv[i], "--top") == 0) && fHasValue)
+            {
+                pOptions->cTop = static_cast<Uint32>(SDL_strtoul(argv[++i], nullptr, 10));
+            }
+            else if ((SDL_strcmp(argv[i], "--layer") == 0) && fHasValue)
+            {
+                const char *szLayer = argv[++i];
+                int layer = 0;
+                while ((layer < static_cast<int>(HeatmapLayer::Count)) && (SDL_strcmp(szLayer, HeatmapLayerName(static_cast<HeatmapLayer>(layer))) != 0))
+                {
+                    layer++;
+                }
+                if (layer == static_cast<int>(HeatmapLayer::Count))
+                {
+                    PrintUsage(argv[0]);
+                    return false;
+                }
+                pOptions->layer = static_cast<HeatmapLayer>(layer);
+            }
+            else
+            {
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }
+
+        if (i + 2 > argc)
+        {
+            PrintUsage(argv[0]);
+            return false;
+        }
+        pOptions->szCommand = argv[i];
+        pOptions->szFactFile = argv[i + 1];
+        pOptions->cReplays = argc - (i + 2);
+        pOptions->pszReplays = &argv[i + 2];
+        bool fBuild = (SDL_strcmp(pOptions->szCommand, "build") == 0);
+        if (fBuild != (pOptions->cReplays > 0))
+        {
+            PrintUsage(argv[0]);
+            return false;
+        }
+        return true;
+    }
+
+    // Sequential, each game needs a harness of its own and they're quick to play headless
+    int Build(const QueryOptions &options)
+    {
+        FactWriter facts;
+        if (!facts.Open(options.szFactFile, Constants::MapRows, Constants::MapCols))
+        {
+            return ExitFailed;
+        }
+
+        Uint32 cDiverged = 0;
+        Uint64 cTicks = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (int i = 0; i < options.cReplays; i++)
+        {
+            Replay replay;
+            if (!replay.Load(options.pszReplays[i]))
+            {
+                return ExitFailed;
+            }
+            GameOptions gameOptions;
+            gameOptions.fStress = replay.Info().fStress;
+            gameOptions.cPlayers = replay.Info().cPlayers;
+            gameOptions.cGhosts = replay.Info().cGhosts;
+            GameHarness gameHarness(gameOptions);
+            if (gameHarness.InitializeHeadless() != SDL_TRUE)
+            {
+                return ExitFailed;
+            }
+
+            facts.BeginGame(replay.Info().cPlayers, replay.Info().cGhosts, replay.Info().fStress);
+            gameHarness.SetFactWriter(&facts);
+            Uint32 checksum = gameHarness.RunHeadless(replay.Info().cTicks, &replay);
+            facts.EndGame();
+            cTicks += replay.Info().cTicks;
+            if (checksum != replay.Info().checksum)
+            {
+                // Its facts are still stored, but they're of some other game than the one recorded
+                printf("%s diverged from the recording (checksum %08x, recorded %08x)\n", options.pszReplays[i], checksum, replay.Info().checksum);
+                cDiverged++;
+            }
+        }
+
+        double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+        printf("Played %d replays, %.0f ticks/sec\n", options.cReplays, cTicks / seconds);
+        if (!facts.Close())
+        {
+            return ExitFailed;
+        }
+        return (cDiverged > 0) ? ExitFailed : 0;
+    }
+
+    void PrintScanTime(Uint64 start, Uint64 cRows, const char *szRows, Uint32 cThreads)
+    {
+        double ms = ((SDL_GetPerformanceCounter() - start) * 1000.0) / SDL_GetPerformanceFrequency();
+        printf("Scanned %llu %s in %.2f ms on %u thread%s (%.0f M rows/sec)\n", static_cast<unsigned long long>(cRows), szRows,
+            ms, cThreads, (cThreads == 1) ? "" : "s", (ms > 0.0) ? cRows / (ms * 1000.0) : 0.0);
+    }
+
+    void ScanSummary(const FactStore &store, const FactSegment &segment, void *pContext)
+    {
+        SummaryContext *pSummary = static_cast<SummaryContext*>(pContext);
+        Uint64 cEvents[static_cast<int>(FactEvent::Count)] = { 0 };
+        for (Uint32 i = 0; i < segment.cEvents; i++)
+        {
+            if (segment.pEventKind[i] < static_cast<Uint8>(FactEvent::Count))
+            {
+                cEvents[segment.pEventKind[i]]++;
+            }
+        }
+        for (int kind = 0; kind < static_cast<int>(FactEvent::Count); kind++)
+        {
+            pSummary->cEvents[kind] += cEvents[kind];
+        }
+
+        Uint16 maxLevel = 0;
+        for (Uint32 i = 0; i < segment.cTicks; i++)
+        {
+            maxLevel = SDL_max(maxLevel, segment.pLevel[i]);
+        }
+        pSummary->maxLevel = SDL_max(pSummary->maxLevel, maxLevel);
+        for (Uint32 game = 0; game < segment.cGames; game++)
+        {
+            if ((segment.pGameFlags[game] & FactStore::FlagStress) != 0)
+            {
+                pSummary->cStressTicks += segment.pGameTicks[game];
+            }
+        }
+    }
+
+    void Summary(const FactStore &store, Uint32 cThreads)
+    {
+        SummaryContext *pContexts = new SummaryContext[cThreads];
+        void **ppContexts = new void*[cThreads];
+        for (Uint32 i = 0; i < cThreads; i++)
+        {
+            SDL_zero(pContexts[i]);
+            ppContexts[i] = &pContexts[i];
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        store.Scan(cThreads, ScanSummary, ppContexts);
+        for (Uint32 i = 1; i < cThreads; i++)
+        {
+            for (int kind = 0; kind < static_cast<int>(FactEvent::Count); kind++)
+            {
+                pContexts[0].cEvents[kind] += pContexts[i].cEvents[kind];
+            }
+            pContexts[0].cStressTicks += pContexts[i].cStressTicks;
+            pContexts[0].maxLevel = SDL_max(pContexts[0].maxLevel, pContexts[i].maxLevel);
+        }
+        PrintScanTime(start, store.TickCount(), "ticks", cThreads);
+
+        const SummaryContext &total = pContexts[0];
+        printf("games               %llu in %u segments\n", static_cast<unsigned long long>(store.GameCount()), store.SegmentCount());
+        printf("ticks               %llu (%llu in stress mode)\n", static_cast<unsigned long long>(store.TickCount()),
+            static_cast<unsigned long long>(total.cStressTicks));
+        printf("actor rows          %llu\n", static_cast<unsigned long long>(store.ActorRowCount()));
+        printf("furthest level      %u\n", total.maxLevel + 1);
+        printf("pellets eaten       %llu\n", static_cast<unsigned long long>(total.cEvents[static_cast<int>(FactEvent::PelletEaten)]));
+        printf("power pellets eaten %llu\n", static_cast<unsigned long long>(total.cEvents[static_cast<int>(FactEvent::PowerPellet)]));
+        printf("players caught      %llu\n", static_cast<unsigned long long>(total.cEvents[static_cast<int>(FactEvent::Caught)]));
+        printf("levels completed    %llu\n", static_cast<unsigned long long>(total.cEvents[static_cast<int>(FactEvent::LevelComplete)]));
+        delete[] ppContexts;
+        delete[] pContexts;
+    }
+
+    // Only the event columns are read
+    void ScanDeaths(const FactStore &store, const FactSegment &segment, void *pContext)
+    {
+        DeathsContext *pDeaths = static_cast<DeathsContext*>(pContext);
+        Uint64 cDeaths = 0;
+        for (Uint32 i = 0; i < segment.cEvents; i++)
+        {
+            if ((segment.pEventKind[i] == static_cast<Uint8>(FactEvent::Caught)) && (segment.pEventTick[i] > pDeaths->after))
+            {
+                Uint16 cell = segment.pEventCell[i];
+                pDeaths->pCounts[(cell < pDeaths->cCells) ? cell : pDeaths->cCells]++;
+                cDeaths++;
+            }
+        }
+        pDeaths->cDeaths += cDeaths;
+    }
+
+    void Deaths(const FactStore &store, Uint32 cThreads, const QueryOptions &options)
+    {
+        Uint32 cCells = store.MapRows() * store.MapCols();
+        DeathsContext *pContexts = new DeathsContext[cThreads];
+        void **ppContexts = new void*[cThreads];
+        for (Uint32 i = 0; i < cThreads; i++)
+        {
+            pContexts[i].after = options.after;
+            pContexts[i].cCells = cCells;
+            pContexts[i].pCounts = new Uint32[cCells + 1];
+            SDL_memset(pContexts[i].pCounts, 0, (cCells + 1) * sizeof(Uint32));
+            pContexts[i].cDeaths = 0;
+            ppContexts[i] = &pContexts[i];
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        store.Scan(cThreads, ScanDeaths, ppContexts);
+        Uint32 *pCounts = pContexts[0].pCounts;
+        for (Uint32 i = 1; i < cThreads; i++)
+        {
+            for (Uint32 cell = 0; cell <= cCells; cell++)
+            {
+                pCounts[cell] += pContexts[i].pCounts[cell];
+            }
+            pContexts[0].cDeaths += pContexts[i].cDeaths;
+        }
+        PrintScanTime(start, store.EventCount(), "events", cThreads);
+
+        Uint64 cDeaths = pContexts[0].cDeaths;
+        if (options.after >= 0)
+        {
+            printf("%llu players caught after tick %lld\n", static_cast<unsigned long long>(cDeaths), static_cast<long long>(options.after));
+        }
+        else
+        {
+            printf("%llu players caught\n", static_cast<unsigned long long>(cDeaths));
+        }
+
+        // The busiest few, picked out one at a time (and zeroed so they aren't picked again)
+        for (Uint32 rank = 0; (rank < options.cTop) && (cDeaths > 0); rank++)
+        {
+            Uint32 busiest = 0;
+            for (Uint32 cell = 1; cell <= cCells; cell++)
+            {
+                busiest = (pCounts[cell] > pCounts[busiest]) ? cell : busiest;
+            }
+            if (pCounts[busiest] == 0)
+            {
+                break;
+            }
+            if (busiest == cCells)
+            {
+                printf("  off the map   %8u  %5.1f%%\n", pCounts[busiest], (pCounts[busiest] * 100.0) / cDeaths);
+            }
+            else
+            {
+                printf("  row %2u col %2u %8u  %5.1f%%\n", busiest / store.MapCols(), busiest % store.MapCols(), pCounts[busiest],
+                    (pCounts[busiest] * 100.0) / cDeaths);
+            }
+            pCounts[busiest] = 0;
+        }
+
+        for (Uint32 i = 0; i < cThreads; i++)
+        {
+            delete[] pContexts[i].pCounts;
+        }
+        delete[] ppContexts;
+        delete[] pContexts;
+    }
+
+    void AddScatterRun(ScatterContext *pScatter, Uint32 cTicks)
+    {
+        pScatter->histogram[SDL_min(cTicks / ScatterBucketTicks, ScatterBuckets - 1)]++;
+        pScatter->cRuns++;
+        pScatter->cRunTicks += cTicks;
+        pScatter->longestRun = SDL_max(pScatter->longestRun, cTicks);
+    }
+
+    // Only the actor modes are read, a tick's worth at a time, following each ghost in and out of scatter
+    void ScanScatter(const FactStore &store, const FactSegment &segment, void *pContext)
+    {
+        ScatterContext *pScatter = static_cast<ScatterContext*>(pContext);
+        const Uint8 *pModes = segment.pActorMode;
+        for (Uint32 game = 0; game < segment.cGames; game++)
+        {
+            Uint16 cPlayers = segment.pGamePlayers[game];
+            Uint16 cGhosts = segment.pGameGhosts[game];
+            Uint32 cActors = cPlayers + cGhosts;
+            Uint32 cTicks = segment.pGameTicks[game];
+            for (Uint16 g = 0; g < cGhosts; g++)
+            {
+                pScatter->pRunStart[g] = NoRun;
+            }
+
+            for (Uint32 tick = 0; tick < cTicks; tick++)
+            {
+                const Uint8 *pGhostModes = pModes + (static_cast<Uint64>(tick) * cActors) + cPlayers;
+                for (Uint16 g = 0; g < cGhosts; g++)
+                {
+                    bool fScattering = ((pGhostModes[g] & FactStore::ModeScattering) != 0);
+                    if (fScattering && (pScatter->pRunStart[g] == NoRun))
+                    {
+                        pScatter->pRunStart[g] = tick;
+                    }
+                    else if (!fScattering && (pScatter->pRunStart[g] != NoRun))
+                    {
+                        AddScatterRun(pScatter, tick - pScatter->pRunStart[g]);
+                        pScatter->pRunStart[g] = NoRun;
+                    }
+                }
+            }
+            for (Uint16 g = 0; g < cGhosts; g++)
+            {
+                pScatter->cUnfinished += (pScatter->pRunStart[g] != NoRun) ? 1 : 0;
+            }
+            pModes += static_cast<Uint64>(cTicks) * cActors;
+        }
+    }
+
+    void Scatter(const FactStore &store, Uint32 cThreads)
+    {
+        ScatterContext *pContexts = new ScatterContext[cThreads];
+        void **ppContexts = new void*[cThreads];
+        for (Uint32 i = 0; i < cThreads; i++)
+        {
+            SDL_zero(pContexts[i]);
+            pContexts[i].pRunStart = new Uint32[SDL_max(store.MaxActors(), static_cast<Uint16>(1))];
+            ppContexts[i] = &pContexts[i];
+        }
+
+        Uint64 start = SDL_GetPerformanceCounter();
+        store.Scan(cThreads, ScanScatter, ppContexts);
+        ScatterContext &total = pContexts[0];
+        for (Uint32 i = 1; i < cThreads; i++)
+        {
+            for (Uint32 bucket = 0; bucket < ScatterBuckets; bucket++)
+            {
+                total.histogram[bucket] += pContexts[i].histogram[bucket];
+            }
+            total.cRuns += pContexts[i].cRuns;
+            total.cRunTicks += pContexts[i].cRunTicks;
+            total.longestRun = SDL_max(total.longestRun, pContexts[i].longestRun);
+            total.cUnfinished += pContexts[i].cUnfinished;
+        }
+        PrintScanTime(start, store.ActorRowCount(), "actor rows", cThreads);
+
+        printf("%llu scatters (and %llu still going when their game ended)\n", static_cast<unsigned long long>(total.cRuns),
+            static_cast<unsigned long long>(total.cUnfinished));
+        if (total.cRuns > 0)
+        {
+            double secondsPerTick = 1.0 / Constants::FramesPerSecond;
+            printf("mean %.2f s, longest %.2f s\n", (total.cRunTicks * secondsPerTick) / total.cRuns, total.longestRun * secondsPerTick);
+            Uint64 cMost = 0;
+            for (Uint32 bucket = 0; bucket < ScatterBuckets; bucket++)
+            {
+                cMost = SDL_max(cMost, total.histogram[bucket]);
+            }
+            for (Uint32 bucket = 0; bucket < ScatterBuckets; bucket++)
+            {
+                if (total.histogram[bucket] == 0)
+                {
+                    continue;
+                }
+                char szBar[41];
+                int cchBar = static_cast<int>((total.histogram[bucket] * 40) / cMost);
+                SDL_memset(szBar, '#', cchBar);
+                szBar[cchBar] = '\0';
+                double from = bucket * ScatterBucketTicks * secondsPerTick;
+                if (bucket == ScatterBuckets - 1)
+                {
+                    printf("  %5.1f s +      %8llu  %s\n", from, static_cast<unsigned long long>(total.histogram[bucket]), szBar);
+                }
+                else
+                {
+                    printf("  %5.1f-%5.1f s  %8llu  %s\n", from, from + (ScatterBucketTicks * secondsPerTick),
+                        static_cast<unsigned long long>(total.histogram[bucket]), szBar);
+                }
+            }
+        }
+
+        for (Uint32 i = 0; i < cThreads; i++)
+        {
+            delete[] pContexts[i].pRunStart;
+        }
+        delete[] ppContexts;
+        delete[] pContexts;
+    }
+
+    // A character per tile, darker to brighter, blank where there's nothing
+    void PrintHeatmap(const FactStore &store, Uint32 cThreads, const QueryOptions &options)
+    {
+        static const char Shades[] = ".:-=+*#%@";
+        const int cShades = sizeof(Shades) - 1;
+        Heatmap heatmap;
+        heatmap.Build(store, cThreads);
+
+        char szLine[128];
+        heatmap.Describe(options.layer, szLine, sizeof(szLine));
+        printf("%s\n", szLine);
+        for (Uint16 row = 0; row < heatmap.Rows(); row++)
+        {
+            for (Uint16 col = 0; col < heatmap.Cols(); col++)
+            {
+                float level = heatmap.Level(options.layer, row, col);
+                char shade = (level < 0.0f) ? ' ' : Shades[SDL_min(static_cast<int>(level * cShades), cShades - 1)];
+                printf("%c%c", shade, shade);
+            }
+            printf("\n");
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    QueryOptions options;
+    if (!ParseQueryOptions(argc, argv, &options))
+    {
+        return ExitFailed;
+    }
+    if (SDL_strcmp(options.szCommand, "build") == 0)
+    {
+        return Build(options);
+    }
+
+    FactStore store;
+    if (!store.Open(options.szFactFile))
+    {
+        return ExitFailed;
+    }
+    // No more threads than there are segments to go round
+    Uint32 cThreads = (options.cThreads > 0) ? options.cThreads : static_cast<Uint32>(SDL_GetCPUCount());
+    cThreads = SDL_max(SDL_min(cThreads, store.SegmentCount()), 1u);
+
+    if (SDL_strcmp(options.szCommand, "summary") == 0)
+    {
+        Summary(store, cThreads);
+    }
+    else if (SDL_strcmp(options.szCommand, "deaths") == 0)
+    {
+        Deaths(store, cThreads, options);
+    }
+    else if (SDL_strcmp(options.szCommand, "scatter") == 0)
+    {
+        Scatter(store, cThreads);
+    }
+    else if (SDL_strcmp(options.szCommand, "heatmap") == 0)
+    {
+        PrintHeatmap(store, cThreads, options);
+    }
+    else
+    {
+        PrintUsage(argv[0]);
+        return ExitFailed;
+    }
+    return 0;
+}
@@ -0,0 +1,506 @@
+// microbench.cpp : Microbenchmarks for the hot paths of the game (maze queries, ghost AI, animation, rendering, pixel rasterizing and file output).
+// Each benchmark is calibrated to a batch of operations that takes a few ms, then timed over a number of batches,
+// and reported as ns/op with the spread across the batches.  Use --csv or --json to feed the numbers to a script,
+// e.g. to compare a change against a baseline run
+//
+#include "../include/gameharness.h"
+#include "../include/pixelrasterizer.h"
+#include <math.h>
+#include <algorithm>
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    struct BenchOptions
+    {
+        BenchOptions() :
+            cSamples(15),
+            sampleMs(10),
+            szFilter(nullptr),
+            szRenderFrame(nullptr),
+            format(Format::Text)
+        {
+        }
+
+        enum class Format
+        {
+            Text,
+            Csv,
+            Json
+        };
+
+        Uint32 cSamples;            // Timed batches per benchmark
+        Uint32 sampleMs;            // Target length of a batch, the op count is calibrated to this
+        const char *szFilter;       // Only run benchmarks with this in their name
+        const char *szRenderFrame;  // Frame captured by the game (--capture-frame) to draw
+        Format format;
+    };
+
+    struct BenchResult
+    {
+        const char *szName;
+        Uint64 cOpsPerSample;
+        Uint32 cSamples;
+        double meanNs;              // Per op, over the batches
+        double stddevNs;
+        double minNs;
+        double medianNs;
+    };
+
+    static const Uint32 MaxSamples = 1000;
+    static const Uint32 MaxResults = 32;
+
+    // Everything the benchmarks poke at, set up the same way the harness does for a level
+    struct BenchWorld
+    {
+        SDL_Surface *pSDLSurface;
+        SDL_Renderer *pSDLRenderer;
+        TextureWrapper *pTilesTexture;
+        TextureWrapper *pSpriteTexture;
+        TextureWrapper *pTitleTexture;
+        Arena *pArena;              // Backs the maze and the ActorStore
+        AnimationRegistry *pAnimations;
+        ActorStore *pActorStore;
+        Maze *pMaze;
+        Player *pPlayer;
+        Ghost *pGhosts[4];          // Blinky, Pinky, Inky, Clyde
+        Uint16 *pOpenTiles;         // row << 8 | col of every open tile not on the edge of the map
+        Uint16 cOpenTiles;
+        Uint16 *pIntersections;     // Same for the intersections, where the ghosts make their decisions
+        Uint16 cIntersections;
+    };
+
+    // Ghost::ShortestDirectionToTarget is for the ghosts' own use, this opens it up to the benchmark
+    class BenchBlinky : public Blinky
+    {
+    public:
+        BenchBlinky(TextureWrapper* pTextureWrapper, ActorStore* pActorStore) : Blinky(pTextureWrapper, pActorStore)
+        {
+        }
+
+        using Ghost::ShortestDirectionToTarget;
+    };
+
+    template <class T> T* CreateSprite(BenchWorld *pWorld)
+    {
+        T *p = new T(pWorld->pSpriteTexture, pWorld->pActorStore);
+        p->Initialize();
+        p->Reset(pWorld->pMaze);
+        return p;
+    }
+
+    // Ops are numbered so each call can pick a different input, the result is folded in here so the
+    // optimizer can't throw the work away
+    volatile Uint32 g_sink = 0;
+
+    template <class TOp> Uint64 TimeOps(TOp &op, Uint64 cOps)
+    {
+        Uint32 sink = 0;
+        Uint64 start = SDL_GetPerformanceCounter();
+        for (Uint64 i = 0; i < cOps; i++)
+        {
+            sink += op(i);
+        }
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+        g_sink += sink;
+        return elapsed;
+    }
+
+    template <class TOp> bool RunBenchmark(const char *szName, const BenchOptions &options, TOp op, BenchResult *pResult)
+    {
+        if ((options.szFilter != nullptr) && (SDL_strstr(szName, options.szFilter) == nullptr))
+        {
+            return false;
+        }
+
+        // Double the batch until it takes long enough to time accurately, this doubles as the warm up
+        const double nsPerTick = 1000000000.0 / SDL_GetPerformanceFrequency();
+        const double targetNs = options.sampleMs * 1000000.0;
+        Uint64 cOps = 1;
+        while ((TimeOps(op, cOps) * nsPerTick < targetNs) && (cOps < (1ull << 40)))
+        {
+            cOps *= 2;
+        }
+
+        static double samples[MaxSamples];
+        double total = 0.0;
+        for (Uint32 i = 0; i < options.cSamples; i++)
+        {
+            samples[i] = (TimeOps(op, cOps) * nsPerTick) / cOps;
+            total += samples[i];
+        }
+
+        pResult->szName = szName;
+        pResult->cOpsPerSample = cOps;
+        pResult->cSamples = options.cSamples;
+        pResult->meanNs = total / options.cSamples;
+
+        double sumSquares = 0.0;
+        for (Uint32 i = 0; i < options.cSamples; i++)
+        {
+            sumSquares += (samples[i] - pResult->meanNs) * (samples[i] - pResult->meanNs);
+        }
+        pResult->stddevNs = (options.cSamples > 1) ? sqrt(sumSquares / (options.cSamples - 1)) : 0.0;
+
+        std::sort(samples, samples + options.cSamples);
+        pResult->minNs = samples[0];
+        pResult->medianNs = samples[options.cSamples / 2];
+        return true;
+    }
+
+    bool CreateWorld(BenchWorld *pWorld)
+    {
+        SDL_zerop(pWorld);
+        if (!InitializeSDLHeadless(&pWorld->pSDLSurface, &pWorld->pSDLRenderer))
+        {
+            return false;
+        }
+
+        SDL_Color colorKey = Constants::SDLColorMagenta;
+        pWorld->pTilesTexture = new TextureWrapper(Constants::TilesImage, SDL_strlen(Constants::TilesImage), pWorld->pSDLRenderer, nullptr);
+        pWorld->pSpriteTexture = new TextureWrapper(Constants::SpritesImage, SDL_strlen(Constants::SpritesImage), pWorld->pSDLRenderer, &colorKey);
+        pWorld->pTitleTexture = new TextureWrapper(Constants::TitleImage, SDL_strlen(Constants::TitleImage), pWorld->pSDLRenderer, nullptr);
+        if (pWorld->pTilesTexture->IsNull() || pWorld->pSpriteTexture->IsNull() || pWorld->pTitleTexture->IsNull())
+        {
+            printf("Failed to load one or more textures\n");
+            return false;
+        }
+
+        SDL_Rect textureRect{ 0, 0, Constants::TileTextureWidth, Constants::TileTextureHeight };
+        SDL_Rect tileRect{ 0, 0, Constants::TileWidth, Constants::TileHeight };
+        pWorld->pArena = new Arena();
+        pWorld->pArena->Reserve(TiledMap::ArenaBytes(textureRect, tileRect, Constants::MapRows * Constants::MapCols) +
+            ActorStore::ArenaBytes(Constants::MaxGhosts));
+
+        pWorld->pMaze = new Maze(Constants::MapRows, Constants::MapCols, Constants::ScreenWidth, Constants::ScreenHeight);
+        pWorld->pMaze->Initialize(textureRect, tileRect, pWorld->pTilesTexture->Ptr(),
+            Constants::MapIndicies, Constants::MapRows * Constants::MapCols, pWorld->pArena);
+
+        pWorld->pAnimations = new AnimationRegistry();
+        pWorld->pActorStore = new ActorStore(pWorld->pAnimations);
+        pWorld->pActorStore->Reserve(Constants::MaxGhosts, pWorld->pArena);
+        pWorld->pActorStore->SetTileLayout(pWorld->pMaze->GetMapBounds(), Constants::TileWidth);
+
+        pWorld->pPlayer = CreateSprite<Player>(pWorld);
+        pWorld->pGhosts[0] = CreateSprite<BenchBlinky>(pWorld);
+        pWorld->pGhosts[1] = CreateSprite<Pinky>(pWorld);
+        Inky *pInky = new Inky(pWorld->pSpriteTexture, pWorld->pActorStore);
+        pInky->Initialize();
+        pInky->SetBlinkyReference(pWorld->pGhosts[0]);
+        pInky->Reset(pWorld->pMaze);
+        pWorld->pGhosts[2] = pInky;
+        pWorld->pGhosts[3] = CreateSprite<Clyde>(pWorld);
+
+        pWorld->pOpenTiles = new Uint16[Constants::MapRows * Constants::MapCols];
+        pWorld->pIntersections = new Uint16[Constants::MapRows * Constants::MapCols];
+        for (Uint16 row = 1; row < Constants::MapRows - 1; row++)
+        {
+            for (Uint16 col = 1; col < Constants::MapCols - 1; col++)
+            {
+                if (!pWorld->pMaze->IsTileSolid(row, col))
+                {
+                    pWorld->pOpenTiles[pWorld->cOpenTiles++] = (row << 8) | col;
+                    if (pWorld->pMaze->IsTileIntersection(row, col))
+                    {
+                        pWorld->pIntersections[pWorld->cIntersections++] = (row << 8) | col;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // cOpenTiles is not a power of 2, a stride that's prime to it visits every tile in a scrambled order
+    Uint16 TileForOp(const Uint16 *pTiles, Uint16 cTiles, Uint64 op)
+    {
+        return pTiles[(op * 7919) % cTiles];
+    }
+
+    void PrintResults(const BenchResult *pResults, Uint32 cResults, BenchOptions::Format format)
+    {
+        switch (format)
+        {
+        case BenchOptions::Format::Text:
+            printf("%-48s %12s %12s %8s %12s %12s %14s\n", "benchmark", "ns/op", "stddev", "cv%", "min", "median", "ops/sample");
+            for (Uint32 i = 0; i < cResults; i++)
+            {
+                const BenchResult &r = pResults[i];
+                printf("%-48s %12.2f %12.2f %8.2f %12.2f %12.2f %14llu\n", r.szName, r.meanNs, r.stddevNs,
+                    (r.meanNs > 0.0) ? (100.0 * r.stddevNs / r.meanNs) : 0.0, r.minNs, r.medianNs,
+                    static_cast<unsigned long long>(r.cOpsPerSample));
+            }
+            break;
+        case BenchOptions::Format::Csv:
+            printf("benchmark,ns_per_op,stddev_ns,variance_ns2,min_ns,median_ns,samples,ops_per_sample\n");
+            for (Uint32 i = 0; i < cResults; i++)
+            {
+                const BenchResult &r = pResults[i];
+                printf("\"%s\",%.3f,%.3f,%.3f,%.3f,%.3f,%u,%llu\n", r.szName, r.meanNs, r.stddevNs, r.stddevNs * r.stddevNs,
+                    r.minNs, r.medianNs, r.cSamples, static_cast<unsigned long long>(r.cOpsPerSample));
+            }
+            break;
+        case BenchOptions::Format::Json:
+            printf("{\"benchmarks\":[\n");
+            for (Uint32 i = 0; i < cResults; i++)
+            {
+                const BenchResult &r = pResults[i];
+                printf("  {\"name\":\"%s\",\"ns_per_op\":%.3f,\"stddev_ns\":%.3f,\"variance_ns2\":%.3f,\"min_ns\":%.3f,"
+                    "\"median_ns\":%.3f,\"samples\":%u,\"ops_per_sample\":%llu}%s\n", r.szName, r.meanNs, r.stddevNs,
+                    r.stddevNs * r.stddevNs, r.minNs, r.medianNs, r.cSamples, static_cast<unsigned long long>(r.cOpsPerSample),
+                    (i + 1 < cResults) ? "," : "");
+            }
+            printf("]}\n");
+            break;
+        }
+    }
+
+    void PrintUsage(const char *szExe)
+    {
+        printf("usage: %s [options]\n", szExe);
+        printf("  --filter <text>       only run the benchmarks with text in their name\n");
+        printf("  --samples <n>         timed batches per benchmark (default 15, max %u)\n", MaxSamples);
+        printf("  --sample-ms <n>       target length of each batch (default 10)\n");
+        printf("  --csv | --json        machine readable output\n");
+        printf("  --render-frame <file> also draw a frame captured by the game (--capture-frame)\n");
+    }
+
+    bool ParseBenchOptions(int argc, char* argv[], BenchOptions *pOptions)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            bool fHasValue = (i + 1 < argc);
+            if ((SDL_strcmp(argv[i], "--filter") == 0) && fHasValue)
+            {
+                pOptions->szFilter = argv[++i];
+            }
+            else if ((SDL_strcmp(argv[i], "--samples") == 0) && fHasValue)
+            {
+                pOptions->cSamples = SDL_atoi(argv[++i]);
+            }
+            else if ((SDL_strcmp(argv[i], "--sample-ms") == 0) && fHasValue)
+            {
+                pOptions->sampleMs = SDL_atoi(argv[++i]);
+            }
+            else if ((SDL_strcmp(argv[i], "--render-frame") == 0) && fHasValue)
+            {
+                pOptions->szRenderFrame = argv[++i];
+            }
+            else if (SDL_strcmp(argv[i], "--csv") == 0)
+            {
+                pOptions->format = BenchOptions::Format::Csv;
+            }
+            else if (SDL_strcmp(argv[i], "--json") == 0)
+            {
+                pOptions->format = BenchOptions::Format::Json;
+            }
+            else
+            {
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }
+
+        if ((pOptions->cSamples < 1) || (pOptions->cSamples > MaxSamples) || (pOptions->sampleMs < 1))
+        {
+            PrintUsage(argv[0]);
+            return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    BenchOptions options;
+    if (!ParseBenchOptions(argc, argv, &options))
+    {
+        return 1;
+    }
+
+    BenchWorld world;
+    if (!CreateWorld(&world))
+    {
+        return 1;
+    }
+
+    // Progress goes to stderr so stdout is only the results
+    static BenchResult results[MaxResults];
+    Uint32 cResults = 0;
+    Maze *pMaze = world.pMaze;
+    Player *pPlayer = world.pPlayer;
+    SDL_Rect mapBounds = pMaze->GetMapBounds();
+
+    fprintf(stderr, "Running benchmarks...\n");
+    cResults += RunBenchmark("Maze::IsTileIntersection", options, [&](Uint64 op)
+    {
+        Uint16 tile = TileForOp(world.pOpenTiles, world.cOpenTiles, op);
+        return static_cast<Uint32>(pMaze->IsTileIntersection(tile >> 8, tile & 0xFF));
+    }, &results[cResults]);
+
+    cResults += RunBenchmark("TiledMap::GetTileRowCol", options, [&](Uint64 op)
+    {
+        // Points all over the map, with a border of misses around it
+        SDL_Point point = { mapBounds.x - 8 + static_cast<int>((op * 7919) % (mapBounds.w + 16)),
+            mapBounds.y - 8 + static_cast<int>((op * 104729) % (mapBounds.h + 16)) };
+        Uint16 row = 0;
+        Uint16 col = 0;
+        return pMaze->GetTileRowCol(point, row, col) ? static_cast<Uint32>(row + col) : 0u;
+    }, &results[cResults]);
+
+    BenchBlinky *pBlinky = static_cast<BenchBlinky*>(world.pGhosts[0]);
+    cResults += RunBenchmark("Ghost::ShortestDirectionToTarget", options, [&](Uint64 op)
+    {
+        Uint16 origin = TileForOp(world.pOpenTiles, world.cOpenTiles, op);
+        Uint16 target = TileForOp(world.pOpenTiles, world.cOpenTiles, op + 101);
+        return static_cast<Uint32>(pBlinky->ShortestDirectionToTarget(origin >> 8, origin & 0xFF, target >> 8, target & 0xFF, pMaze));
+    }, &results[cResults]);
+
+    const char *decisionNames[] =
+    {
+        "Blinky::MakeBranchDecision",
+        "Pinky::MakeBranchDecision",
+        "Inky::MakeBranchDecision",
+        "Clyde::MakeBranchDecision"
+    };
+    for (size_t i = 0; i < SDL_arraysize(world.pGhosts); i++)
+    {
+        Ghost *pGhost = world.pGhosts[i];
+        cResults += RunBenchmark(decisionNames[i], options, [&](Uint64 op)
+        {
+            Uint16 tile = TileForOp(world.pIntersections, world.cIntersections, op);
+            return static_cast<Uint32>(pGhost->MakeBranchDecision(tile >> 8, tile & 0xFF, pPlayer, pMaze));
+        }, &results[cResults]);
+    }
+
+    cResults += RunBenchmark("Player::GetTilePlayerFacingWithOriginalBug", options, [&](Uint64 op)
+    {
+        Uint16 row = 0;
+        Uint16 col = 0;
+        pPlayer->GetTilePlayerFacingWithOriginalBug(pMaze, static_cast<Uint16>(op & 7), row, col);
+        return static_cast<Uint32>(row + col);
+    }, &results[cResults]);
+
+    // Animation playback moved from SpriteAnimation into the ActorStore, which advances every actor's
+    // clip (and movement) in one pass.  Fill the store with stationary ghosts so nothing wanders off
+    ActorStore *pActorStore = world.pActorStore;
+    while (pActorStore->Count() < pActorStore->Capacity())
+    {
+        Ghost *pGhost = CreateSprite<Pinky>(&world);
+        pActorStore->SetVelocity(pGhost->Id(), 0, 0);
+    }
+    cResults += RunBenchmark("ActorStore::Update (per actor)", options, [&](Uint64 op)
+    {
+        // One op is one actor's share of an update
+        if ((op % pActorStore->Count()) == 0)
+        {
+            pActorStore->Update();
+            pActorStore->ClearTileEvents();
+        }
+        return 1u;
+    }, &results[cResults]);
+
+    cResults += RunBenchmark("TiledMap::Render (software renderer)", options, [&](Uint64 /*op*/)
+    {
+        pMaze->Render(world.pSDLRenderer);
+        return 1u;
+    }, &results[cResults]);
+
+    // Frames for the pixel rasterizer, the real sprite frames scattered over the open tiles (off the tile
+    // grid too, so the rows don't all start aligned)
+    static const Uint32 RasterFrames = 256;
+    static const Uint32 RasterSprites = 5;
+    SpriteDraw *pRasterSprites = new SpriteDraw[RasterFrames * RasterSprites];
+    RenderSnapshot *pRasterSnapshots = new RenderSnapshot[RasterFrames];
+    Uint16 *pRasterMap = new Uint16[Constants::MapRows * Constants::MapCols];
+    SDL_memcpy(pRasterMap, pMaze->MapIndicies(), Constants::MapRows * Constants::MapCols * sizeof(Uint16));
+    Sprite *pSprites[RasterSprites] = { pPlayer, world.pGhosts[0], world.pGhosts[1], world.pGhosts[2], world.pGhosts[3] };
+    for (Uint32 i = 0; i < RasterFrames; i++)
+    {
+        for (Uint32 j = 0; j < RasterSprites; j++)
+        {
+            SpriteDraw &draw = pRasterSprites[(i * RasterSprites) + j];
+            Uint16 tile = TileForOp(world.pOpenTiles, world.cOpenTiles, (i * RasterSprites) + j);
+            draw.fVisible = pSprites[j]->GetDraw(&draw.source, &draw.target);
+            draw.target.x = mapBounds.x + ((tile & 0xFF) * Constants::TileWidth) - (draw.target.w / 4) + static_cast<int>(i % 7);
+            draw.target.y = mapBounds.y + ((tile >> 8) * Constants::TileHeight) - (draw.target.h / 4) + static_cast<int>(j % 3);
+        }
+        RenderSnapshot &snapshot = pRasterSnapshots[i];
+        SDL_zero(snapshot);
+        snapshot.mapBounds = mapBounds;
+        snapshot.pMapIndicies = pRasterMap;
+        snapshot.cPlayers = 1;
+        snapshot.cGhosts = RasterSprites - 1;
+        snapshot.pSprites = &pRasterSprites[i * RasterSprites];
+    }
+
+    PixelRasterizer rasterizer;
+    if (!rasterizer.Initialize(Constants::TilesImage, Constants::SpritesImage, mapBounds,
+        Constants::MapRows, Constants::MapCols, Constants::TileWidth, 2))
+    {
+        return 1;
+    }
+    Uint8 *pRasterPixels = new Uint8[RasterFrames * rasterizer.FrameBytes()];
+    cResults += RunBenchmark("PixelRasterizer::Draw (1/2 scale)", options, [&](Uint64 op)
+    {
+        rasterizer.Draw(pRasterSnapshots[op % RasterFrames], pRasterPixels);
+        return static_cast<Uint32>(pRasterPixels[op % rasterizer.FrameBytes()]);
+    }, &results[cResults]);
+
+    // One op is one frame's share of a batch drawn across every core
+    RasterPool rasterPool;
+    if (!rasterPool.Start(SDL_GetCPUCount()))
+    {
+        return 1;
+    }
+    static char szPoolName[64];
+    SDL_snprintf(szPoolName, sizeof(szPoolName), "RasterPool::DrawAll (per frame, %d threads)", rasterPool.ThreadCount());
+    cResults += RunBenchmark(szPoolName, options, [&](Uint64 op)
+    {
+        if ((op % RasterFrames) == 0)
+        {
+            rasterPool.DrawAll(rasterizer, pRasterSnapshots, RasterFrames, pRasterPixels);
+        }
+        return 1u;
+    }, &results[cResults]);
+    rasterPool.Stop();
+
+    // What a latency CSV line costs the loop that writes it, the writer thread does the disk
+    static const char DiskBenchFile[] = "microbench-diskwriter.tmp";
+    DiskWriter diskWriter;
+    DiskStream *pDiskStream = diskWriter.Open(DiskBenchFile, 1024 * 1024, DiskStream::Overflow::Wait);
+    if (pDiskStream == nullptr)
+    {
+        return 1;
+    }
+    static const char DiskLine[] = "123,4567,left,0,16.250,16.500,32.750\n";
+    cResults += RunBenchmark("DiskStream::Write (CSV line)", options, [&](Uint64 /*op*/)
+    {
+        return pDiskStream->Write(DiskLine, sizeof(DiskLine) - 1) ? 1u : 0u;
+    }, &results[cResults]);
+    diskWriter.Close(pDiskStream, nullptr, 0);
+    diskWriter.Shutdown();
+    remove(DiskBenchFile);
+
+    // The same frame the game drew, with no simulation behind it
+    if (options.szRenderFrame != nullptr)
+    {
+        RenderCommandList frame;
+        if (!frame.Load(options.szRenderFrame))
+        {
+            return 1;
+        }
+        SDL_Texture *pTextures[static_cast<int>(RenderTexture::Count)] =
+            { nullptr, world.pTilesTexture->Ptr(), world.pSpriteTexture->Ptr(), world.pTitleTexture->Ptr() };
+        fprintf(stderr, "%s: %u commands, %u points\n", options.szRenderFrame, frame.Count(), frame.PointCount());
+        cResults += RunBenchmark("RenderCommandList::Execute (captured frame)", options, [&](Uint64 /*op*/)
+        {
+            frame.Execute(world.pSDLRenderer, pTextures);
+            return 1u;
+        }, &results[cResults]);
+    }
+
+    SDL_assert(cResults <= MaxResults);
+    PrintResults(results, cResults, options.format);
+    return 0;
+}
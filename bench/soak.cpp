@@ -0,0 +1,397 @@
+// soak.cpp : Headless soak benchmark.  Plays a corpus of recorded sessions (see --record in the game) back
+// to back until it has run the requested number of ticks, checking each one ends exactly where the recording
+// did.  Reports ticks/second, time per phase, peak RSS and heap allocations per tick, and exits non-zero if
+// a replay diverged or a result is worse than the thresholds file allows
+//
+#include "../include/gameharness.h"
+#include <new>
+#include <atomic>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+using namespace XplatGameTutorial::PacManClone;
+
+// Every heap allocation the game makes with new goes through here, so we can count them.  The allocation
+// tracker (ENABLE_ALLOC_TRACKER) already replaces operator new, so use its count instead
+#ifdef ENABLE_ALLOC_TRACKER
+static Uint64 AllocationCount()
+{
+    return AllocationTracker::TotalAllocations();
+}
+#else
+static std::atomic<Uint64> g_cAllocations(0);
+
+static Uint64 AllocationCount()
+{
+    return g_cAllocations.load(std::memory_order_relaxed);
+}
+
+// Every form of new and delete goes through these two, so the compiler sees malloc() paired with free()
+static void* CountedAlloc(size_t cb)
+{
+    g_cAllocations.fetch_add(1, std::memory_order_relaxed);
+    void *p = malloc((cb > 0) ? cb : 1);
+    if (p == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+static void CountedFree(void *p)
+{
+    free(p);
+}
+
+void* operator new(size_t cb)
+{
+    return CountedAlloc(cb);
+}
+
+void* operator new[](size_t cb)
+{
+    return CountedAlloc(cb);
+}
+
+void operator delete(void *p) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    CountedFree(p);
+}
+
+void operator delete[](void *p, size_t) noexcept
+{
+    CountedFree(p);
+}
+#endif
+
+namespace
+{
+    const Uint32 ExitRegressed = 2;     // Ran fine, but worse than the thresholds
+    const Uint32 ExitFailed = 1;        // Couldn't run, or a replay diverged
+
+    struct SoakOptions
+    {
+        SoakOptions() :
+            cTicks(1000000),
+            szThresholdsFile(nullptr),
+            szWriteThresholdsFile(nullptr),
+            cReplays(0),
+            pszReplays(nullptr)
+        {
+        }
+
+        Uint64 cTicks;                      // Keep going round the corpus until at least this many
+        const char *szThresholdsFile;       // Limits to check the results against
+        const char *szWriteThresholdsFile;  // Save this run's results (with some headroom) as the limits
+        int cReplays;
+        char **pszReplays;                  // Points into argv
+    };
+
+    // Lower ticks/sec, or higher anything else, is a regression.  0 means don't check
+    struct SoakThresholds
+    {
+        double minTicksPerSecond;
+        double maxAllocationsPerTick;
+        double maxPeakRssKB;
+    };
+
+    struct SoakResults
+    {
+        Uint64 cTicks;
+        Uint32 cReplaysPlayed;
+        Uint32 cDiverged;
+        Uint32 cLevelsCompleted;
+        Uint32 cPowerPelletsEaten;
+        Uint64 cAllocations;
+        Uint64 elapsedTicks;                // SDL_GetPerformanceCounter()
+#ifdef ENABLE_PROFILER
+        FrameSample phaseTotals;
+#endif
+    };
+
+    double PeakRssKB()
+    {
+#ifdef _WIN32
+        PROCESS_MEMORY_COUNTERS counters;
+        GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+        return counters.PeakWorkingSetSize / 1024.0;
+#else
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+        return usage.ru_maxrss / 1024.0;    // Bytes on macOS
+#else
+        return static_cast<double>(usage.ru_maxrss);
+#endif
+#endif
+    }
+
+    void PrintUsage(const char *szExe)
+    {
+        printf("usage: %s [options] replay...\n", szExe);
+        printf("  --ticks <n>                   ticks to run in total, the corpus is repeated as needed (default 1000000)\n");
+        printf("  --thresholds <file>           fail (exit %u) if the results are worse than these\n", ExitRegressed);
+        printf("  --write-thresholds <file>     save this run's results, with headroom, as thresholds\n");
+    }
+
+    bool ParseSoakOptions(int argc, char* argv[], SoakOptions *pOptions)
+    {
+        int i = 1;
+        for (; (i < argc) && (argv[i][0] == '-'); i++)
+        {
+            bool fHasValue = (i + 1 < argc);
+            if ((SDL_strcmp(argv[i], "--ticks") == 0) && fHasValue)
+            {
+                pOptions->cTicks = SDL_strtoull(argv[++i], nullptr, 10);
+            }
+            else if ((SDL_strcmp(argv[i], "--thresholds") == 0) && fHasValue)
+            {
+                pOptions->szThresholdsFile = argv[++i];
+            }
+            else if ((SDL_strcmp(argv[i], "--write-thresholds") == 0) && fHasValue)
+            {
+                pOptions->szWriteThresholdsFile = argv[++i];
+            }
+            else
+            {
+                PrintUsage(argv[0]);
+                return false;
+            }
+        }
+
+        pOptions->cReplays = argc - i;
+        pOptions->pszReplays = &argv[i];
+        if ((pOptions->cReplays == 0) || (pOptions->cTicks == 0))
+        {
+            PrintUsage(argv[0]);
+            return false;
+        }
+        return true;
+    }
+
+    // "name value" per line, # starts a comment
+    bool LoadThresholds(const char *szFileName, SoakThresholds *pThresholds)
+    {
+        FILE *pFile = fopen(szFileName, "r");
+        if (pFile == nullptr)
+        {
+            printf("Failed to open thresholds file %s\n", szFileName);
+            return false;
+        }
+
+        bool fResult = true;
+        char szLine[256];
+        while (fResult && (fgets(szLine, sizeof(szLine), pFile) != nullptr))
+        {
+            char szName[64];
+            double value = 0.0;
+            if ((szLine[0] == '#') || (sscanf(szLine, "%63s %lf", szName, &value) != 2))
+            {
+                continue;
+            }
+
+            if (SDL_strcmp(szName, "min_ticks_per_sec") == 0)
+            {
+                pThresholds->minTicksPerSecond = value;
+            }
+            else if (SDL_strcmp(szName, "max_allocs_per_tick") == 0)
+            {
+                pThresholds->maxAllocationsPerTick = value;
+            }
+            else if (SDL_strcmp(szName, "max_peak_rss_kb") == 0)
+            {
+                pThresholds->maxPeakRssKB = value;
+            }
+            else
+            {
+                printf("Unknown threshold %s in %s\n", szName, szFileName);
+                fResult = false;
+            }
+        }
+        fclose(pFile);
+        return fResult;
+    }
+
+    // 20% headroom so run to run noise doesn't trip them
+    bool WriteThresholds(const char *szFileName, double ticksPerSecond, double allocationsPerTick, double peakRssKB)
+    {
+        FILE *pFile = fopen(szFileName, "w");
+        if (pFile == nullptr)
+        {
+            printf("Failed to create thresholds file %s\n", szFileName);
+            return false;
+        }
+
+        fprintf(pFile, "# Written by the soak benchmark, checked with --thresholds\n");
+        fprintf(pFile, "min_ticks_per_sec %.0f\n", ticksPerSecond * 0.8);
+        fprintf(pFile, "max_allocs_per_tick %.4f\n", allocationsPerTick * 1.2);
+        fprintf(pFile, "max_peak_rss_kb %.0f\n", peakRssKB * 1.2);
+        fclose(pFile);
+        return true;
+    }
+
+    // A fresh harness for each replay, so it starts from the same state the recording did
+    bool PlayReplay(const char *szFileName, const Replay &replay, Uint64 cTicksLeft, SoakResults *pResults)
+    {
+        GameOptions options;
+        options.fStress = replay.Info().fStress;
+        options.cPlayers = replay.Info().cPlayers;
+        options.cGhosts = replay.Info().cGhosts;
+
+        GameHarness gameHarness(options);
+        if (gameHarness.InitializeHeadless() != SDL_TRUE)
+        {
+            return false;
+        }
+
+        // The corpus may not divide the tick count evenly, the last one can stop early (and then can't be checked)
+        Uint32 cTicks = static_cast<Uint32>(SDL_min(static_cast<Uint64>(replay.Info().cTicks), cTicksLeft));
+        Uint64 cAllocations = AllocationCount();
+        Uint64 start = SDL_GetPerformanceCounter();
+        Uint32 checksum = gameHarness.RunHeadless(cTicks, &replay);
+        pResults->elapsedTicks += SDL_GetPerformanceCounter() - start;
+        pResults->cAllocations += AllocationCount() - cAllocations;
+
+        pResults->cTicks += cTicks;
+        pResults->cReplaysPlayed++;
+        pResults->cLevelsCompleted += gameHarness.LevelsCompleted();
+        pResults->cPowerPelletsEaten += gameHarness.PowerPelletsEaten();
+#ifdef ENABLE_PROFILER
+        const FrameSample &totals = gameHarness.Profiler().Totals();
+        for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); phase++)
+        {
+            pResults->phaseTotals.phaseTicks[phase] += totals.phaseTicks[phase];
+        }
+        pResults->phaseTotals.frameTicks += totals.frameTicks;
+#endif
+
+        if ((cTicks == replay.Info().cTicks) && (checksum != replay.Info().checksum))
+        {
+            printf("%s diverged from the recording (checksum %08x, recorded %08x)\n", szFileName, checksum, replay.Info().checksum);
+            pResults->cDiverged++;
+        }
+        return true;
+    }
+
+    // Plays the replays, already allocated, until the tick count is reached then reports and checks the results
+    int RunSoak(const SoakOptions &options, const SoakThresholds &thresholds, Replay *pReplays)
+    {
+        for (int i = 0; i < options.cReplays; i++)
+        {
+            if (!pReplays[i].Load(options.pszReplays[i]))
+            {
+                return ExitFailed;
+            }
+            if (pReplays[i].Info().cTicks == 0)
+            {
+                printf("%s is empty\n", options.pszReplays[i]);
+                return ExitFailed;
+            }
+        }
+
+        SoakResults results;
+        SDL_zero(results);
+        for (int i = 0; results.cTicks < options.cTicks; i = (i + 1) % options.cReplays)
+        {
+            if (!PlayReplay(options.pszReplays[i], pReplays[i], options.cTicks - results.cTicks, &results))
+            {
+                return ExitFailed;
+            }
+        }
+
+        double seconds = static_cast<double>(results.elapsedTicks) / SDL_GetPerformanceFrequency();
+        double ticksPerSecond = results.cTicks / seconds;
+        double allocationsPerTick = static_cast<double>(results.cAllocations) / results.cTicks;
+        double peakRssKB = PeakRssKB();
+
+        printf("replays played      %u (%u diverged)\n", results.cReplaysPlayed, results.cDiverged);
+        printf("levels completed    %u\n", results.cLevelsCompleted);
+        printf("power pellets eaten %u\n", results.cPowerPelletsEaten);
+        printf("ticks               %llu\n", static_cast<unsigned long long>(results.cTicks));
+        printf("ticks/sec           %.0f\n", ticksPerSecond);
+        printf("us/tick             %.3f\n", (seconds * 1000000.0) / results.cTicks);
+#ifdef ENABLE_PROFILER
+        double usPerCounterTick = 1000000.0 / SDL_GetPerformanceFrequency();
+        for (int phase = 0; phase < static_cast<int>(ProfilePhase::Count); phase++)
+        {
+            if (results.phaseTotals.phaseTicks[phase] > 0)
+            {
+                printf("  %-17s %.3f us/tick\n", ProfilePhaseName(static_cast<ProfilePhase>(phase)),
+                    (results.phaseTotals.phaseTicks[phase] * usPerCounterTick) / results.cTicks);
+            }
+        }
+#else
+        printf("  (per phase times need ENABLE_PROFILER, which the makefile defines for the soak test)\n");
+#endif
+        printf("peak rss            %.0f KB\n", peakRssKB);
+        printf("allocations/tick    %.4f\n", allocationsPerTick);
+
+        if ((options.szWriteThresholdsFile != nullptr) &&
+            !WriteThresholds(options.szWriteThresholdsFile, ticksPerSecond, allocationsPerTick, peakRssKB))
+        {
+            return ExitFailed;
+        }
+
+        if (results.cDiverged > 0)
+        {
+            return ExitFailed;
+        }
+
+        int exitCode = 0;
+        if ((thresholds.minTicksPerSecond > 0) && (ticksPerSecond < thresholds.minTicksPerSecond))
+        {
+            printf("REGRESSION: ticks/sec %.0f is below %.0f\n", ticksPerSecond, thresholds.minTicksPerSecond);
+            exitCode = ExitRegressed;
+        }
+        if ((thresholds.maxAllocationsPerTick > 0) && (allocationsPerTick > thresholds.maxAllocationsPerTick))
+        {
+            printf("REGRESSION: allocations/tick %.4f is above %.4f\n", allocationsPerTick, thresholds.maxAllocationsPerTick);
+            exitCode = ExitRegressed;
+        }
+        if ((thresholds.maxPeakRssKB > 0) && (peakRssKB > thresholds.maxPeakRssKB))
+        {
+            printf("REGRESSION: peak rss %.0f KB is above %.0f KB\n", peakRssKB, thresholds.maxPeakRssKB);
+            exitCode = ExitRegressed;
+        }
+        return exitCode;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    SoakOptions options;
+    if (!ParseSoakOptions(argc, argv, &options))
+    {
+        return ExitFailed;
+    }
+
+    SoakThresholds thresholds;
+    SDL_zero(thresholds);
+    if ((options.szThresholdsFile != nullptr) && !LoadThresholds(options.szThresholdsFile, &thresholds))
+    {
+        return ExitFailed;
+    }
+
+    // RunSoak's early returns all come back through here to free them
+    Replay *pReplays = new Replay[options.cReplays];
+    int exitCode = RunSoak(options, thresholds, pReplays);
+    delete[] pReplays;
+    return exitCode;
+}
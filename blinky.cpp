@@ -3,18 +3,17 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-Blinky::Blinky(TextureWrapper* pTextureWrapper) :
-    Ghost(pTextureWrapper, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
+Blinky::Blinky(TextureWrapper* pTextureWrapper, ActorStore* pActorStore) :
+    Ghost(pTextureWrapper, pActorStore, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
         Constants::GhostTotalFrameCount, Constants::GhostTotalAnimationCount)
 {
 }
 
 bool Blinky::Initialize()
 {
-    // Each ghost will have its own set of frames, so each will override this method and implement
-    // the specific loading data
-    InitializeCommon();
-    LoadFrames(0, 0, 64, 8);
+    // Each ghost will have its own set of frames (shared by every ghost of the same type), so each will
+    // override this method and implement the specific loading data
+    InitializeCommon(AnimationRegistry::FrameTableId::Blinky, 64);
     _scatterRow = Constants::BlinkyScatterRow;
     _scatterCol = Constants::BlinkyScatterCol;
     _targetColor = Constants::BlinkyDrawColor;
@@ -29,16 +28,13 @@ bool Blinky::Reset(Maze *pMaze)
     // There is no "penned" mode, just placement will take care of that.  Blinky is the only
     // ghost that is supposed to start outside of the pen, but since he's the only one for now
     // put him inside to test out that code path.
-    _currentRow = Constants::GhostPenRow-3;
-    _currentCol = Constants::GhostPenCol;
-    ResetPosition(playerStartCoord.x, playerStartCoord.y);
-    SetVelocity(Constants::GhostBaseSpeed * -1.75, 0);
+    SetCurrentCell(Constants::GhostPenRow-3, Constants::GhostPenCol);
+    ResetPosition(IntToCoord(playerStartCoord.x), IntToCoord(playerStartCoord.y));
+    SetVelocity(-Constants::GhostSpeed, 0);
 
-    SafeDelete<Decision>(_pNextDecision);
-    SafeDelete<Decision>(_pCurrentDecision);
-    _pCurrentDecision = new Decision(Constants::GhostPenRow-3, Constants::GhostPenCol, CurrentDirection());
+    ResetDecisions(Constants::GhostPenRow-3, Constants::GhostPenCol);
     _penTimer.Reset();
-    _mode = Mode::Chase;
+    SetMode(Mode::Chase);
     _fScatter = false;
     return true;
 }
@@ -51,7 +47,6 @@ Direction Blinky::MakeBranchDecision(Uint16 nRow, Uint16 nCol, Player* pPlayer,
 
     // The "next" cell is already passed in here, given this location, find the branch
     // That brings us closest to the target cell (the player)
-    SDL_Point playerPoint = { static_cast<int>(pPlayer->X()), static_cast<int>(pPlayer->Y()) };
     if (_fScatter)
     {
         _targetRow = _scatterRow;
@@ -59,7 +54,7 @@ Direction Blinky::MakeBranchDecision(Uint16 nRow, Uint16 nCol, Player* pPlayer,
     }
     else
     {
-        pMaze->GetTileRowCol(playerPoint, _targetRow, _targetCol);
+        pPlayer->GetTile(_targetRow, _targetCol);
     }
     return ShortestDirectionToTarget(nRow, nCol, _targetRow, _targetCol, pMaze);
 }
\ No newline at end of file
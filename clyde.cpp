@@ -3,18 +3,17 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-Clyde::Clyde(TextureWrapper* pTextureWrapper) :
-    Ghost(pTextureWrapper, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
+Clyde::Clyde(TextureWrapper* pTextureWrapper, ActorStore* pActorStore) :
+    Ghost(pTextureWrapper, pActorStore, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
         Constants::GhostTotalFrameCount, Constants::GhostTotalAnimationCount)
 {
 }
 
 bool Clyde::Initialize()
 {
-    // Each ghost will have its own set of frames, so each will override this method and implement
-    // the specific loading data
-    InitializeCommon();
-    LoadFrames(0, 0, 160, 8);
+    // Each ghost will have its own set of frames (shared by every ghost of the same type), so each will
+    // override this method and implement the specific loading data
+    InitializeCommon(AnimationRegistry::FrameTableId::Clyde, 160);
     _scatterRow = 35;
     _scatterCol = 0;
     _targetColor = Constants::ClydeDrawColor;
@@ -29,17 +28,14 @@ bool Clyde::Reset(Maze *pMaze)
     // There is no "penned" mode, just placement will take care of that.  Clyde is the only
     // ghost that is supposed to start outside of the pen, but since he's the only one for now
     // put him inside to test out that code path.
-    _currentRow = Constants::GhostPenRow;
-    _currentCol = Constants::GhostPenCol + 1;
-    ResetPosition(playerStartCoord.x, playerStartCoord.y);
-    SetVelocity(0, Constants::GhostBaseSpeed * -1.75);
+    SetCurrentCell(Constants::GhostPenRow, Constants::GhostPenCol + 1);
+    ResetPosition(IntToCoord(playerStartCoord.x), IntToCoord(playerStartCoord.y));
+    SetVelocity(0, -Constants::GhostSpeed);
 
-    SafeDelete<Decision>(_pNextDecision);
-    SafeDelete<Decision>(_pCurrentDecision);
-    _pCurrentDecision = new Decision(Constants::GhostPenRow, Constants::GhostPenCol + 1, CurrentDirection());
+    ResetDecisions(Constants::GhostPenRow, Constants::GhostPenCol + 1);
     _penTimer.Reset();
     SetPenTimerMax(8000);
-    _mode = Mode::Chase;
+    SetMode(Mode::Chase);
     _fScatter = false;
     return true;
 }
@@ -53,12 +49,10 @@ Direction Clyde::MakeBranchDecision(Uint16 nRow, Uint16 nCol, Player* pPlayer, M
     // Need Clyde's row/col
     Uint16 clydeRow = 0;
     Uint16 clydeCol = 0;
-    SDL_Point clydePoint = { static_cast<int>(X()), static_cast<int>(Y()) };
-    pMaze->GetTileRowCol(clydePoint, clydeRow, clydeCol);
+    GetTile(clydeRow, clydeCol);
 
     // Need player's row/col
-    SDL_Point playerPoint = { static_cast<int>(pPlayer->X()), static_cast<int>(pPlayer->Y()) };
-    pMaze->GetTileRowCol(playerPoint, _targetRow, _targetCol);
+    pPlayer->GetTile(_targetRow, _targetCol);
 
     // Logic
     if (Distance(clydeRow, clydeCol, _targetRow, _targetCol) < 8 || _fScatter)
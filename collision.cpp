@@ -0,0 +1,70 @@
+#include "include/collision.h"
+#include "SDL.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // A time within the tick as num / den (den > 0), kept as a fraction so nothing is rounded
+    struct TickTime
+    {
+        CoordProduct num;
+        CoordProduct den;
+    };
+
+    static bool IsBefore(const TickTime &a, const TickTime &b)
+    {
+        return (a.num * b.den) < (b.num * a.den);
+    }
+
+    // Narrow [*pStart, *pEnd] to the times where |offset + t * delta| < distance on a single axis.
+    // Returns false if they never get that close
+    static bool ClipAxis(Coord offset, Coord delta, Coord distance, TickTime *pStart, TickTime *pEnd)
+    {
+        if (delta == 0)
+        {
+            // Not closing on this axis, so either always in range or never
+            return (offset < distance) && (offset > -distance);
+        }
+
+        // Solve for the times we cross -distance and +distance, ordered so entry comes first
+        TickTime entry;
+        TickTime exit;
+        if (delta > 0)
+        {
+            entry = { static_cast<CoordProduct>(-distance - offset), static_cast<CoordProduct>(delta) };
+            exit = { static_cast<CoordProduct>(distance - offset), static_cast<CoordProduct>(delta) };
+        }
+        else
+        {
+            entry = { static_cast<CoordProduct>(offset - distance), static_cast<CoordProduct>(-delta) };
+            exit = { static_cast<CoordProduct>(offset + distance), static_cast<CoordProduct>(-delta) };
+        }
+
+        if (IsBefore(*pStart, entry))
+        {
+            *pStart = entry;
+        }
+        if (IsBefore(exit, *pEnd))
+        {
+            *pEnd = exit;
+        }
+        return IsBefore(*pStart, *pEnd);
+    }
+
+    // Work in b's frame of reference, then a's path relative to b is a single segment and we want to know
+    // if it passes through the box around the origin.  That's the overlap of the time each axis is in range
+    bool SweptOverlap(const SweptPoint &a, const SweptPoint &b, Coord distance)
+    {
+        Coord offsetX = a.x0 - b.x0;
+        Coord offsetY = a.y0 - b.y0;
+        Coord deltaX = (a.x1 - a.x0) - (b.x1 - b.x0);
+        Coord deltaY = (a.y1 - a.y0) - (b.y1 - b.y0);
+
+        TickTime start = { 0, 1 };
+        TickTime end = { 1, 1 };
+        return ClipAxis(offsetX, deltaX, distance, &start, &end) &&
+            ClipAxis(offsetY, deltaY, distance, &start, &end);
+    }
+}
+}
@@ -15,8 +15,10 @@ namespace PacManClone
     
     const char * const Constants::WindowTitle = "Pac-Man Clone";
 
-    const double Constants::PlayerMaxSpeed = 2.0;
-    const double Constants::GhostBaseSpeed = 0.75;
+    // Kept to fractions with power of 2 denominators so they are exact in fixed point (and in a double)
+    const Coord Constants::PlayerSpeed = CoordFromFraction(3, 2);       // 75% of a 2 pixel max speed
+    const Coord Constants::GhostSpeed = CoordFromFraction(21, 16);      // 1.75 * a base of 0.75
+    const Coord Constants::CollisionDistance = IntToCoord(TileWidth / 2);
 
     // This is the map data for the tiles, each index represents a different tile to render
     Uint16 Constants::MapIndicies[MapRows * MapCols] =
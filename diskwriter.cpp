@@ -0,0 +1,262 @@
+#include "include/diskwriter.h"
+#include <stdio.h>
+
+using namespace XplatGameTutorial::PacManClone;
+
+DiskStream::DiskStream(DiskWriter *pWriter, const char *szFileName, SDL_RWops *pFile, Uint32 capacity, Overflow overflow) :
+    _pWriter(pWriter),
+    _szFileName(szFileName),
+    _pFile(pFile),
+    _pRing(new Uint8[capacity]),
+    _capacity(capacity),
+    _overflow(overflow),
+    _head(0),
+    _tail(0),
+    _fClosing(false),
+    _pHeader(nullptr),
+    _cbHeader(0),
+    _pClosed(SDL_CreateSemaphore(0)),
+    _fFailed(false),
+    _peakFill(0),
+    _cStalls(0),
+    _stallCounter(0),
+    _cDroppedSpans(0),
+    _cbDropped(0),
+    _cbWritten(0),
+    _cWrites(0)
+{
+    SDL_assert((capacity & (capacity - 1)) == 0);
+}
+
+DiskStream::~DiskStream()
+{
+    SDL_DestroySemaphore(_pClosed);
+    delete[] _pRing;
+}
+
+bool DiskStream::Write(const void *pData, Uint32 cb)
+{
+    SDL_assert(!_fClosing.load(std::memory_order_relaxed));
+    if (cb > _capacity)
+    {
+        _cDroppedSpans++;
+        _cbDropped += cb;
+        return false;
+    }
+
+    Uint32 tail = _tail.load(std::memory_order_relaxed);
+    Uint32 fill = tail - _head.load(std::memory_order_acquire);
+    if (_capacity - fill < cb)
+    {
+        if (_overflow == Overflow::Drop)
+        {
+            _cDroppedSpans++;
+            _cbDropped += cb;
+            _pWriter->Wake();
+            return false;
+        }
+
+        // The disk can't keep up, nothing for it but to wait
+        Uint64 startCounter = SDL_GetPerformanceCounter();
+        _cStalls++;
+        while (_capacity - fill < cb)
+        {
+            _pWriter->Wake();
+            SDL_Delay(1);
+            fill = tail - _head.load(std::memory_order_acquire);
+        }
+        _stallCounter += SDL_GetPerformanceCounter() - startCounter;
+    }
+
+    // In two pieces if it wraps
+    Uint32 offset = tail & (_capacity - 1);
+    Uint32 cbFirst = SDL_min(cb, _capacity - offset);
+    SDL_memcpy(_pRing + offset, pData, cbFirst);
+    SDL_memcpy(_pRing, static_cast<const Uint8*>(pData) + cbFirst, cb - cbFirst);
+    _tail.store(tail + cb, std::memory_order_release);
+
+    // Half full is worth waking the writer for rather than leaving it to the timer
+    Uint32 newFill = fill + cb;
+    _peakFill = SDL_max(_peakFill, newFill);
+    if ((fill < _capacity / 2) && (newFill >= _capacity / 2))
+    {
+        _pWriter->Wake();
+    }
+    return true;
+}
+
+Uint32 DiskStream::Drain()
+{
+    Uint32 head = _head.load(std::memory_order_relaxed);
+    Uint32 cb = _tail.load(std::memory_order_acquire) - head;
+    if (cb == 0)
+    {
+        return 0;
+    }
+
+    if (!_fFailed)
+    {
+        Uint32 offset = head & (_capacity - 1);
+        Uint32 cbFirst = SDL_min(cb, _capacity - offset);
+        _fFailed = (SDL_RWwrite(_pFile, _pRing + offset, 1, cbFirst) != cbFirst);
+        _cWrites++;
+        if (!_fFailed && (cb > cbFirst))
+        {
+            _fFailed = (SDL_RWwrite(_pFile, _pRing, 1, cb - cbFirst) != cb - cbFirst);
+            _cWrites++;
+        }
+        if (!_fFailed)
+        {
+            _cbWritten += cb;
+        }
+    }
+    _head.store(head + cb, std::memory_order_release);
+    return cb;
+}
+
+DiskWriter::DiskWriter() :
+    _pThread(nullptr),
+    _pWake(nullptr),
+    _pLock(SDL_CreateMutex()),
+    _fStopping(false)
+{
+    for (Uint32 i = 0; i < MaxStreams; i++)
+    {
+        _pStreams[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+DiskWriter::~DiskWriter()
+{
+    Shutdown();
+    SDL_DestroyMutex(_pLock);
+}
+
+DiskStream* DiskWriter::Open(const char *szFileName, Uint32 capacity, DiskStream::Overflow overflow)
+{
+    SDL_LockMutex(_pLock);
+    DiskStream *pStream = nullptr;
+    Uint32 slot = 0;
+    while ((slot < MaxStreams) && (_pStreams[slot].load(std::memory_order_relaxed) != nullptr))
+    {
+        slot++;
+    }
+    if (slot == MaxStreams)
+    {
+        printf("Too many files open to write %s\n", szFileName);
+    }
+    else if (_pThread == nullptr)
+    {
+        _fStopping = false;
+        _pWake = SDL_CreateSemaphore(0);
+        _pThread = SDL_CreateThread(WriterThread, "DiskWriter", this);
+        if (_pThread == nullptr)
+        {
+            printf("SDL_CreateThread() failed, error = %s\n", SDL_GetError());
+            SDL_DestroySemaphore(_pWake);
+            _pWake = nullptr;
+        }
+    }
+
+    if ((slot < MaxStreams) && (_pThread != nullptr))
+    {
+        SDL_RWops *pFile = SDL_RWFromFile(szFileName, "wb");
+        if (pFile == nullptr)
+        {
+            printf("Failed to create %s, error = %s\n", szFileName, SDL_GetError());
+        }
+        else
+        {
+            pStream = new DiskStream(this, szFileName, pFile, capacity, overflow);
+            _pStreams[slot].store(pStream, std::memory_order_release);
+        }
+    }
+    SDL_UnlockMutex(_pLock);
+    return pStream;
+}
+
+void DiskWriter::Close(DiskStream *pStream, const void *pHeader, Uint32 cbHeader)
+{
+    if (pStream == nullptr)
+    {
+        return;
+    }
+
+    // The writer thread finishes the file (it's the only one that touches it) and lets us know
+    pStream->_pHeader = static_cast<const Uint8*>(pHeader);
+    pStream->_cbHeader = cbHeader;
+    pStream->_fClosing.store(true, std::memory_order_release);
+    Wake();
+    SDL_SemWait(pStream->_pClosed);
+
+    if (pStream->_fFailed)
+    {
+        printf("Writing %s failed, only %llu bytes were written\n", pStream->_szFileName,
+            static_cast<unsigned long long>(pStream->_cbWritten));
+    }
+    printf("Wrote %s: %llu bytes in %u writes, ring peaked at %u of %u bytes\n", pStream->_szFileName,
+        static_cast<unsigned long long>(pStream->_cbWritten), pStream->_cWrites, pStream->_peakFill, pStream->_capacity);
+    if ((pStream->_cStalls > 0) || (pStream->_cDroppedSpans > 0))
+    {
+        printf("Writing %s fell behind: %u stalls (%.1f ms), %u writes dropped (%llu bytes)\n", pStream->_szFileName,
+            pStream->_cStalls, (pStream->_stallCounter * 1000.0) / SDL_GetPerformanceFrequency(), pStream->_cDroppedSpans,
+            static_cast<unsigned long long>(pStream->_cbDropped));
+    }
+    delete pStream;
+}
+
+void DiskWriter::Shutdown()
+{
+    if (_pThread == nullptr)
+    {
+        return;
+    }
+
+    _fStopping = true;
+    Wake();
+    SDL_WaitThread(_pThread, nullptr);
+    _pThread = nullptr;
+    SDL_DestroySemaphore(_pWake);
+    _pWake = nullptr;
+    for (Uint32 i = 0; i < MaxStreams; i++)
+    {
+        SDL_assert(_pStreams[i].load(std::memory_order_relaxed) == nullptr);
+    }
+}
+
+// Drains every ring each time it wakes, and finishes off the streams being closed once theirs are empty
+int DiskWriter::WriterThread(void *pData)
+{
+    DiskWriter *pThis = static_cast<DiskWriter*>(pData);
+    while (!pThis->_fStopping)
+    {
+        SDL_SemWaitTimeout(pThis->_pWake, FlushIntervalMs);
+        for (Uint32 i = 0; i < MaxStreams; i++)
+        {
+            DiskStream *pStream = pThis->_pStreams[i].load(std::memory_order_acquire);
+            if (pStream == nullptr)
+            {
+                continue;
+            }
+
+            // Closing is checked first so nothing written before it can be missed
+            bool fClosing = pStream->_fClosing.load(std::memory_order_acquire);
+            pStream->Drain();
+            if (fClosing)
+            {
+                if ((pStream->_pHeader != nullptr) && !pStream->_fFailed)
+                {
+                    SDL_RWseek(pStream->_pFile, 0, RW_SEEK_SET);
+                    pStream->_fFailed = (SDL_RWwrite(pStream->_pFile, pStream->_pHeader, 1, pStream->_cbHeader) != pStream->_cbHeader);
+                }
+                pStream->_fFailed |= (SDL_RWclose(pStream->_pFile) != 0);
+                pStream->_pFile = nullptr;
+
+                // Close() deletes it once posted, so let go of it first
+                pThis->_pStreams[i].store(nullptr, std::memory_order_release);
+                SDL_SemPost(pStream->_pClosed);
+            }
+        }
+    }
+    return 0;
+}
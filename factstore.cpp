@@ -0,0 +1,544 @@
+#include "include/factstore.h"
+#include <stdio.h>
+#include <atomic>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    const char FactMagic[4] = { 'P', 'M', 'C', 'F' };
+
+    Uint64 Align(Uint64 cb)
+    {
+        return (cb + 63) & ~static_cast<Uint64>(63);
+    }
+
+    // Where each column of a segment starts, handed out in the order they're written (see
+    // FactWriter::WriteSegment()) so the writer and the reader can't disagree
+    class SegmentLayout
+    {
+    public:
+        SegmentLayout(Uint64 offset) : _offset(offset)
+        {
+        }
+
+        template <typename T>
+        Uint64 Next(Uint64 count)
+        {
+            Uint64 offset = _offset;
+            _offset = Align(_offset + (count * sizeof(T)));
+            return offset;
+        }
+
+        Uint64 End() { return _offset; }
+
+    private:
+        Uint64 _offset;
+    };
+}
+
+FactWriter::FactWriter() :
+    _pFile(nullptr),
+    _szFileName(nullptr),
+    _fFailed(false),
+    _offset(0),
+    _mapRows(0),
+    _mapCols(0),
+    _fInGame(false),
+    _cGameTicks(0),
+    _cGameEvents(0),
+    _cSegmentGames(0),
+    _firstSegmentGame(0),
+    _cGames(0),
+    _cTicks(0),
+    _cEvents(0),
+    _pSegments(nullptr),
+    _cSegments(0),
+    _cSegmentCapacity(0)
+{
+}
+
+FactWriter::~FactWriter()
+{
+    Close();
+    delete[] _pSegments;
+}
+
+bool FactWriter::Open(const char *szFileName, Uint16 mapRows, Uint16 mapCols)
+{
+    SDL_assert(!IsOpen());
+    SDL_assert(mapRows * mapCols < FactStore::NoCell);
+    _pFile = SDL_RWFromFile(szFileName, "wb");
+    if (_pFile == nullptr)
+    {
+        printf("Failed to create fact file %s, error = %s\n", szFileName, SDL_GetError());
+        return false;
+    }
+    _szFileName = szFileName;
+    _fFailed = false;
+    _offset = 0;
+    _mapRows = mapRows;
+    _mapCols = mapCols;
+    _cSegmentGames = 0;
+    _firstSegmentGame = 0;
+    _cGames = 0;
+    _cTicks = 0;
+    _cEvents = 0;
+    _cSegments = 0;
+
+    // A blank header for now, Close() fills it in
+    Uint8 zeroes[64];
+    SDL_zero(zeroes);
+    Write(zeroes, static_cast<size_t>(Align(sizeof(FactFileHeader))));
+    return true;
+}
+
+bool FactWriter::Close()
+{
+    if (!IsOpen())
+    {
+        return true;
+    }
+    SDL_assert(!_fInGame);
+    if (_cSegmentGames > 0)
+    {
+        WriteSegment();
+    }
+
+    FactFileHeader header;
+    SDL_zero(header);
+    header.version = FactStore::Version;
+    header.mapRows = _mapRows;
+    header.mapCols = _mapCols;
+    header.segmentCount = _cSegments;
+    header.directoryOffset = _offset;
+    header.cGames = _cGames;
+    header.cTicks = _cTicks;
+    header.cEvents = _cEvents;
+    Write(_pSegments, _cSegments * sizeof(FactSegmentEntry));
+
+    // The magic goes in last, with everything it vouches for already there
+    if (!_fFailed && (SDL_RWseek(_pFile, 0, RW_SEEK_SET) < 0))
+    {
+        _fFailed = true;
+    }
+    Write(&header, sizeof(header));
+    if (!_fFailed && (SDL_RWseek(_pFile, 0, RW_SEEK_SET) >= 0))
+    {
+        Write(FactMagic, sizeof(FactMagic));
+    }
+    _fFailed |= (SDL_RWclose(_pFile) != 0);
+    _pFile = nullptr;
+
+    if (_fFailed)
+    {
+        printf("Writing fact file %s failed\n", _szFileName);
+        return false;
+    }
+    printf("Wrote %s: %llu games, %llu ticks and %llu events in %u segments\n", _szFileName,
+        static_cast<unsigned long long>(_cGames), static_cast<unsigned long long>(_cTicks),
+        static_cast<unsigned long long>(_cEvents), _cSegments);
+    return true;
+}
+
+void FactWriter::BeginGame(Uint16 cPlayers, Uint16 cGhosts, bool fStress)
+{
+    SDL_assert(IsOpen() && !_fInGame);
+    _fInGame = true;
+    _cGameTicks = 0;
+    _cGameEvents = 0;
+    _gamePlayers.Add(cPlayers);
+    _gameGhosts.Add(cGhosts);
+    _gameFlags.Add(fStress ? FactStore::FlagStress : 0);
+}
+
+void FactWriter::EndGame()
+{
+    SDL_assert(_fInGame);
+    _fInGame = false;
+    _gameTicks.Add(_cGameTicks);
+    _gameEvents.Add(_cGameEvents);
+    _cSegmentGames++;
+    _cGames++;
+    if (_pelletsLeft.Count() >= SegmentTicks)
+    {
+        WriteSegment();
+    }
+}
+
+void FactWriter::AddEvent(FactEvent event, Uint16 actor, Uint16 row, Uint16 col)
+{
+    SDL_assert(_fInGame);
+    _eventTick.Add(_cGameTicks);
+    _eventKind.Add(static_cast<Uint8>(event));
+    _eventActor.Add(actor);
+    _eventCell.Add(Cell(row, col));
+    _cGameEvents++;
+}
+
+void FactWriter::AddActor(Uint16 row, Uint16 col, Uint8 mode)
+{
+    SDL_assert(_fInGame);
+    _actorCell.Add(Cell(row, col));
+    _actorMode.Add(mode);
+}
+
+void FactWriter::EndTick(Uint16 cPelletsLeft, Uint16 level)
+{
+    SDL_assert(_fInGame);
+    _pelletsLeft.Add(static_cast<Uint8>(cPelletsLeft));
+    _level.Add(level);
+    _cGameTicks++;
+}
+
+Uint16 FactWriter::Cell(Uint16 row, Uint16 col)
+{
+    return ((row < _mapRows) && (col < _mapCols)) ? (row * _mapCols) + col : FactStore::NoCell;
+}
+
+void FactWriter::WriteSegment()
+{
+    FactSegmentEntry entry;
+    entry.offset = _offset;
+    entry.firstGame = _firstSegmentGame;
+    entry.cGames = _cSegmentGames;
+    entry.cTicks = static_cast<Uint32>(_pelletsLeft.Count());
+    entry.cEvents = static_cast<Uint32>(_eventTick.Count());
+    entry.cActorRows = _actorCell.Count();
+
+    // Same order as SegmentLayout hands them out in FactStore::Open()
+    WriteColumn(_gameTicks);
+    WriteColumn(_gameEvents);
+    WriteColumn(_gamePlayers);
+    WriteColumn(_gameGhosts);
+    WriteColumn(_gameFlags);
+    WriteColumn(_pelletsLeft);
+    WriteColumn(_level);
+    WriteColumn(_actorCell);
+    WriteColumn(_actorMode);
+    WriteColumn(_eventTick);
+    WriteColumn(_eventKind);
+    WriteColumn(_eventActor);
+    WriteColumn(_eventCell);
+
+    if (_cSegments == _cSegmentCapacity)
+    {
+        _cSegmentCapacity = (_cSegmentCapacity == 0) ? 64 : _cSegmentCapacity * 2;
+        FactSegmentEntry *pSegments = new FactSegmentEntry[_cSegmentCapacity];
+        if (_cSegments > 0)
+        {
+            SDL_memcpy(pSegments, _pSegments, _cSegments * sizeof(FactSegmentEntry));
+        }
+        delete[] _pSegments;
+        _pSegments = pSegments;
+    }
+    _pSegments[_cSegments++] = entry;
+
+    _cTicks += entry.cTicks;
+    _cEvents += entry.cEvents;
+    _firstSegmentGame += _cSegmentGames;
+    _cSegmentGames = 0;
+}
+
+template <typename T>
+void FactWriter::WriteColumn(FactColumn<T> &column)
+{
+    size_t cb = static_cast<size_t>(column.Count() * sizeof(T));
+    Write(column.Values(), cb);
+
+    static const Uint8 zeroes[64] = { 0 };
+    Write(zeroes, static_cast<size_t>(Align(_offset) - _offset));
+    column.Clear();
+}
+
+void FactWriter::Write(const void *pData, size_t cb)
+{
+    if (!_fFailed && (cb > 0))
+    {
+        _fFailed = (SDL_RWwrite(_pFile, pData, 1, cb) != cb);
+    }
+    _offset += cb;
+}
+
+FactStore::FactStore() :
+    _pHeader(nullptr),
+    _cbMapping(0),
+    _pSegments(nullptr),
+    _cSegments(0),
+    _cActorRows(0),
+    _maxActors(0)
+#ifdef _WIN32
+    , _hFile(INVALID_HANDLE_VALUE),
+    _hMapping(nullptr)
+#endif
+{
+}
+
+FactStore::~FactStore()
+{
+    Close();
+}
+
+bool FactStore::Open(const char *szFileName)
+{
+    SDL_assert(_pHeader == nullptr);
+#if SDL_BYTEORDER == SDL_BIG_ENDIAN
+    printf("Fact files are little endian, %s can't be read in place here\n", szFileName);
+    return false;
+#endif
+
+    void *pMapping = nullptr;
+#ifdef _WIN32
+    _hFile = CreateFileA(szFileName, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    LARGE_INTEGER size;
+    if ((_hFile == INVALID_HANDLE_VALUE) || !GetFileSizeEx(_hFile, &size))
+    {
+        printf("Failed to open fact file %s, error = %lu\n", szFileName, GetLastError());
+        Close();
+        return false;
+    }
+    _cbMapping = static_cast<size_t>(size.QuadPart);
+    if (_cbMapping >= sizeof(FactFileHeader))
+    {
+        _hMapping = CreateFileMappingA(_hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        pMapping = (_hMapping != nullptr) ? MapViewOfFile(_hMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if (pMapping == nullptr)
+        {
+            printf("Failed to map fact file %s, error = %lu\n", szFileName, GetLastError());
+            Close();
+            return false;
+        }
+    }
+#else
+    int fd = open(szFileName, O_RDONLY);
+    struct stat status;
+    if ((fd < 0) || (fstat(fd, &status) != 0))
+    {
+        printf("Failed to open fact file %s\n", szFileName);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return false;
+    }
+    _cbMapping = static_cast<size_t>(status.st_size);
+    if (_cbMapping >= sizeof(FactFileHeader))
+    {
+        pMapping = mmap(nullptr, _cbMapping, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (pMapping == MAP_FAILED)
+        {
+            printf("Failed to map fact file %s\n", szFileName);
+            close(fd);
+            return false;
+        }
+    }
+    close(fd);
+#endif
+    if (pMapping == nullptr)
+    {
+        printf("%s is too short to be a fact file\n", szFileName);
+        Close();
+        return false;
+    }
+    _pHeader = static_cast<const FactFileHeader*>(pMapping);
+
+    // Everything the queries rely on without checking: the header, the directory, that each segment's
+    // columns are inside the file, and that the games add up to the rows.  The values in the columns
+    // aren't looked at, a query has to cope with any cell or mode
+    const Uint8 *pBase = static_cast<const Uint8*>(pMapping);
+    const FactFileHeader &header = *_pHeader;
+    if ((SDL_memcmp(header.magic, FactMagic, sizeof(FactMagic)) != 0) || (header.version != Version) ||
+        (header.mapRows * header.mapCols >= NoCell) || (header.directoryOffset > _cbMapping) ||
+        ((_cbMapping - header.directoryOffset) / sizeof(FactSegmentEntry) < header.segmentCount))
+    {
+        printf("%s isn't a fact file, or it wasn't finished\n", szFileName);
+        Close();
+        return false;
+    }
+
+    const FactSegmentEntry *pEntries = reinterpret_cast<const FactSegmentEntry*>(pBase + header.directoryOffset);
+    _pSegments = new FactSegment[header.segmentCount];
+    _cSegments = header.segmentCount;
+    Uint64 cGames = 0;
+    Uint64 cTicks = 0;
+    Uint64 cEvents = 0;
+    Uint64 end = Align(sizeof(FactFileHeader));
+    for (Uint32 i = 0; i < _cSegments; i++)
+    {
+        const FactSegmentEntry &entry = pEntries[i];
+        FactSegment &segment = _pSegments[i];
+        if ((entry.offset != end) || (entry.firstGame != cGames))
+        {
+            printf("%s is damaged, segment %u isn't where the one before it ends\n", szFileName, i);
+            Close();
+            return false;
+        }
+
+        SegmentLayout layout(entry.offset);
+        Uint64 gameTicks = layout.Next<Uint32>(entry.cGames);
+        Uint64 gameEvents = layout.Next<Uint32>(entry.cGames);
+        Uint64 gamePlayers = layout.Next<Uint16>(entry.cGames);
+        Uint64 gameGhosts = layout.Next<Uint16>(entry.cGames);
+        Uint64 gameFlags = layout.Next<Uint8>(entry.cGames);
+        Uint64 pelletsLeft = layout.Next<Uint8>(entry.cTicks);
+        Uint64 level = layout.Next<Uint16>(entry.cTicks);
+        Uint64 actorCell = layout.Next<Uint16>(entry.cActorRows);
+        Uint64 actorMode = layout.Next<Uint8>(entry.cActorRows);
+        Uint64 eventTick = layout.Next<Uint32>(entry.cEvents);
+        Uint64 eventKind = layout.Next<Uint8>(entry.cEvents);
+        Uint64 eventActor = layout.Next<Uint16>(entry.cEvents);
+        Uint64 eventCell = layout.Next<Uint16>(entry.cEvents);
+        end = layout.End();
+        if ((entry.cActorRows > header.directoryOffset) || (end > header.directoryOffset))
+        {
+            printf("%s is damaged, segment %u runs past the end\n", szFileName, i);
+            Close();
+            return false;
+        }
+
+        segment.firstGame = entry.firstGame;
+        segment.cGames = entry.cGames;
+        segment.cTicks = entry.cTicks;
+        segment.cEvents = entry.cEvents;
+        segment.cActorRows = entry.cActorRows;
+        segment.pGameTicks = reinterpret_cast<const Uint32*>(pBase + gameTicks);
+        segment.pGameEvents = reinterpret_cast<const Uint32*>(pBase + gameEvents);
+        segment.pGamePlayers = reinterpret_cast<const Uint16*>(pBase + gamePlayers);
+        segment.pGameGhosts = reinterpret_cast<const Uint16*>(pBase + gameGhosts);
+        segment.pGameFlags = pBase + gameFlags;
+        segment.pPelletsLeft = pBase + pelletsLeft;
+        segment.pLevel = reinterpret_cast<const Uint16*>(pBase + level);
+        segment.pActorCell = reinterpret_cast<const Uint16*>(pBase + actorCell);
+        segment.pActorMode = pBase + actorMode;
+        segment.pEventTick = reinterpret_cast<const Uint32*>(pBase + eventTick);
+        segment.pEventKind = pBase + eventKind;
+        segment.pEventActor = reinterpret_cast<const Uint16*>(pBase + eventActor);
+        segment.pEventCell = reinterpret_cast<const Uint16*>(pBase + eventCell);
+
+        Uint64 cSegmentTicks = 0;
+        Uint64 cSegmentEvents = 0;
+        Uint64 cSegmentActorRows = 0;
+        for (Uint32 game = 0; game < entry.cGames; game++)
+        {
+            Uint16 cActors = segment.pGamePlayers[game] + segment.pGameGhosts[game];
+            _maxActors = SDL_max(_maxActors, cActors);
+            cSegmentTicks += segment.pGameTicks[game];
+            cSegmentEvents += segment.pGameEvents[game];
+            cSegmentActorRows += static_cast<Uint64>(segment.pGameTicks[game]) * cActors;
+        }
+        if ((cSegmentTicks != entry.cTicks) || (cSegmentEvents != entry.cEvents) || (cSegmentActorRows != entry.cActorRows))
+        {
+            printf("%s is damaged, segment %u's games don't add up to its rows\n", szFileName, i);
+            Close();
+            return false;
+        }
+        cGames += entry.cGames;
+        cTicks += entry.cTicks;
+        cEvents += entry.cEvents;
+        _cActorRows += entry.cActorRows;
+    }
+
+    if ((end != header.directoryOffset) || (cGames != header.cGames) || (cTicks != header.cTicks) || (cEvents != header.cEvents))
+    {
+        printf("%s is damaged, the segments don't add up to the totals\n", szFileName);
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void FactStore::Close()
+{
+    if (_pHeader != nullptr)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(_pHeader);
+#else
+        munmap(const_cast<FactFileHeader*>(_pHeader), _cbMapping);
+#endif
+        _pHeader = nullptr;
+    }
+#ifdef _WIN32
+    if (_hMapping != nullptr)
+    {
+        CloseHandle(_hMapping);
+        _hMapping = nullptr;
+    }
+    if (_hFile != INVALID_HANDLE_VALUE)
+    {
+        CloseHandle(_hFile);
+        _hFile = INVALID_HANDLE_VALUE;
+    }
+#endif
+    delete[] _pSegments;
+    _pSegments = nullptr;
+    _cSegments = 0;
+    _cActorRows = 0;
+    _maxActors = 0;
+    _cbMapping = 0;
+}
+
+struct FactStore::ScanThread
+{
+    const FactStore *pStore;
+    ScanFunction pfnScan;
+    void *pContext;
+    std::atomic<Uint32> *pNextSegment;  // Shared by all of them
+};
+
+int FactStore::ScanThreadMain(void *pData)
+{
+    ScanThread *pThread = static_cast<ScanThread*>(pData);
+    const FactStore &store = *pThread->pStore;
+    for (;;)
+    {
+        Uint32 index = pThread->pNextSegment->fetch_add(1, std::memory_order_relaxed);
+        if (index >= store._cSegments)
+        {
+            break;
+        }
+        pThread->pfnScan(store, store._pSegments[index], pThread->pContext);
+    }
+    return 0;
+}
+
+void FactStore::Scan(Uint32 cThreads, ScanFunction pfnScan, void **ppContexts) const
+{
+    SDL_assert((_pHeader != nullptr) && (cThreads > 0));
+    std::atomic<Uint32> nextSegment(0);
+    ScanThread *pThreads = new ScanThread[cThreads];
+    SDL_Thread **ppThreads = new SDL_Thread*[cThreads];
+    for (Uint32 i = 0; i < cThreads; i++)
+    {
+        pThreads[i].pStore = this;
+        pThreads[i].pfnScan = pfnScan;
+        pThreads[i].pContext = ppContexts[i];
+        pThreads[i].pNextSegment = &nextSegment;
+    }
+
+    // The calling thread is the first, if any of the others can't be started the rest pick up its share
+    ppThreads[0] = nullptr;
+    for (Uint32 i = 1; i < cThreads; i++)
+    {
+        ppThreads[i] = SDL_CreateThread(ScanThreadMain, "FactScan", &pThreads[i]);
+    }
+    ScanThreadMain(&pThreads[0]);
+    for (Uint32 i = 1; i < cThreads; i++)
+    {
+        if (ppThreads[i] != nullptr)
+        {
+            SDL_WaitThread(ppThreads[i], nullptr);
+        }
+    }
+    delete[] ppThreads;
+    delete[] pThreads;
+}
@@ -0,0 +1,224 @@
+#include "include/framepacer.h"
+#include "include/constants.h"
+#include <stdio.h>
+#include <math.h>
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    const Uint32 SpinMs = 2;                // SDL_Delay() can oversleep by about this much, so it's spun instead
+
+    // Overlay layout, the same look as the profiler's panels
+    const int Margin = 4;
+    const int BarWidth = 4;
+    const int GraphHeight = 48;
+    const int PanelWidth = (FrameTimeHistogram::Buckets * BarWidth) + (2 * Margin);
+}
+
+FramePacer::FramePacer() :
+    _pacing(FramePacing::Delay),
+    _frequency(SDL_GetPerformanceFrequency()),
+    _nextDue(0),
+    _frameStartTicks(0),
+    _cLateSteps(0),
+    _cDroppedSteps(0)
+{
+    _period = _frequency / Constants::FramesPerSecond;
+    _spinTicks = (_frequency * SpinMs) / 1000;
+}
+
+void FramePacer::Start()
+{
+    _frameStartTicks = SDL_GetTicks() - Constants::TicksPerFrame;
+    _nextDue = SDL_GetPerformanceCounter();
+}
+
+Uint32 FramePacer::WaitForStep()
+{
+    Uint32 cSteps = 1;
+    switch (_pacing)
+    {
+    case FramePacing::Delay:
+    {
+        Uint32 elapsedTicks = SDL_GetTicks() - _frameStartTicks;
+        if (elapsedTicks < Constants::TicksPerFrame)
+        {
+            SDL_Delay(Constants::TicksPerFrame - elapsedTicks);
+        }
+        _frameStartTicks = SDL_GetTicks();
+        break;
+    }
+    case FramePacing::Precise:
+    {
+        SleepUntil(_nextDue);
+
+        // A whole step late, count again from now rather than rush the next few to catch up
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now - _nextDue >= _period)
+        {
+            _cLateSteps++;
+            _nextDue = now;
+        }
+        _nextDue += _period;
+        break;
+    }
+    case FramePacing::Vsync:
+    {
+        // The present normally did the waiting.  With a display faster than the simulation (or nothing
+        // presented since the last step) the step isn't due yet, so wait for it here
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now < _nextDue)
+        {
+            SleepUntil(_nextDue);
+            now = SDL_GetPerformanceCounter();
+        }
+        cSteps = static_cast<Uint32>((now - _nextDue) / _period) + 1;
+        if (cSteps > MaxCatchUpSteps)
+        {
+            _cDroppedSteps += cSteps - MaxCatchUpSteps;
+            _nextDue += (cSteps - MaxCatchUpSteps) * _period;
+            cSteps = MaxCatchUpSteps;
+        }
+        _cLateSteps += cSteps - 1;
+        _nextDue += cSteps * _period;
+        break;
+    }
+    }
+    return cSteps;
+}
+
+// Rounded down, so whatever's left over is waited out by WaitForStep()
+Uint32 FramePacer::MsUntilDue()
+{
+    if (_pacing == FramePacing::Delay)
+    {
+        Uint32 elapsedTicks = SDL_GetTicks() - _frameStartTicks;
+        return (elapsedTicks < Constants::TicksPerFrame) ? Constants::TicksPerFrame - elapsedTicks : 0;
+    }
+    Uint64 now = SDL_GetPerformanceCounter();
+    return (now < _nextDue) ? static_cast<Uint32>(((_nextDue - now) * 1000) / _frequency) : 0;
+}
+
+void FramePacer::SleepUntil(Uint64 deadline)
+{
+    for (;;)
+    {
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (now >= deadline)
+        {
+            break;
+        }
+        if (deadline - now > _spinTicks)
+        {
+            SDL_Delay(static_cast<Uint32>(((deadline - now - _spinTicks) * 1000) / _frequency));
+        }
+    }
+}
+
+FrameTimeHistogram::FrameTimeHistogram() :
+    _cFrames(0),
+    _lastCounter(0),
+    _maxMs(0.0),
+    _msPerCounter(1000.0 / SDL_GetPerformanceFrequency())
+{
+    SDL_zero(_histogram);
+}
+
+void FrameTimeHistogram::AddPresent(Uint64 counter)
+{
+    if (_lastCounter != 0)
+    {
+        double ms = (counter - _lastCounter) * _msPerCounter;
+        Uint32 bucket = static_cast<Uint32>(ms * BucketsPerMs);
+        _histogram[SDL_min(bucket, Buckets - 1)]++;
+        _maxMs = SDL_max(_maxMs, ms);
+        _cFrames++;
+    }
+    _lastCounter = counter;
+}
+
+// Upper edge of the bucket the percentile falls in, or the longest frame if that's shorter
+double FrameTimeHistogram::Percentile(Uint32 percent)
+{
+    Uint32 rank = (((_cFrames - 1) * percent) / 100) + 1;
+    Uint32 cSeen = 0;
+    Uint32 bucket = 0;
+    for (; bucket < Buckets - 1; bucket++)
+    {
+        cSeen += _histogram[bucket];
+        if (cSeen >= rank)
+        {
+            break;
+        }
+    }
+    return SDL_min(static_cast<double>(bucket + 1) / BucketsPerMs, _maxMs);
+}
+
+void FrameTimeHistogram::PrintSummary(double targetMs)
+{
+    if (_cFrames == 0)
+    {
+        return;
+    }
+
+    Uint32 cHitches = 0;
+    for (Uint32 bucket = static_cast<Uint32>(targetMs * 1.5 * BucketsPerMs); bucket < Buckets; bucket++)
+    {
+        cHitches += _histogram[bucket];
+    }
+    printf("Frame times over %u presents: p50 %.1f ms, p99 %.1f ms, longest %.1f ms, %u hitches (%.1f ms or more)\n",
+        _cFrames, Percentile(50), Percentile(99), _maxMs, cHitches, targetMs * 1.5);
+}
+
+#ifdef ENABLE_PROFILER
+void FrameTimeHistogram::RenderOverlay(SDL_Renderer *pSDLRenderer, int yTop, double targetMs)
+{
+    if (_cFrames == 0)
+    {
+        return;
+    }
+
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(pSDLRenderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(pSDLRenderer, 0, 0, 0, 192);
+    SDL_Rect panel = { 0, yTop, PanelWidth, OverlayHeight() };
+    SDL_RenderFillRect(pSDLRenderer, &panel);
+
+    char szLine[40];
+    SDL_snprintf(szLine, sizeof(szLine), "FRAMES  P50 %.1f  P99 %.1f  MAX %.1f", Percentile(50), Percentile(99), _maxMs);
+    SDL_SetRenderDrawColor(pSDLRenderer, 255, 255, 255, 255);
+    DrawOverlayText(pSDLRenderer, Margin, yTop + Margin, szLine);
+
+    // 0 to 32ms left to right, the line is the frame time aimed for
+    Uint32 maxCount = 0;
+    for (Uint32 bucket = 0; bucket < Buckets; bucket++)
+    {
+        maxCount = SDL_max(maxCount, _histogram[bucket]);
+    }
+    int graphBottom = yTop + OverlayHeight() - Margin;
+    double scale = GraphHeight / log(maxCount + 1.0);
+    for (Uint32 bucket = 0; bucket < Buckets; bucket++)
+    {
+        int height = static_cast<int>(log(_histogram[bucket] + 1.0) * scale);
+        if (height > 0)
+        {
+            bool fHitch = (bucket >= static_cast<Uint32>(targetMs * 1.5 * BucketsPerMs));
+            SDL_SetRenderDrawColor(pSDLRenderer, fHitch ? 255 : 0, fHitch ? 0 : 192, fHitch ? 0 : 255, 255);
+            SDL_Rect bar = { Margin + static_cast<int>(bucket) * BarWidth, graphBottom - height, BarWidth - 1, height };
+            SDL_RenderFillRect(pSDLRenderer, &bar);
+        }
+    }
+    int targetX = Margin + static_cast<int>(targetMs * BucketsPerMs * BarWidth);
+    SDL_SetRenderDrawColor(pSDLRenderer, 255, 255, 255, 255);
+    SDL_RenderDrawLine(pSDLRenderer, targetX, graphBottom - GraphHeight, targetX, graphBottom);
+
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, blendMode);
+}
+
+int FrameTimeHistogram::OverlayHeight()
+{
+    return OverlayLineHeight() + GraphHeight + (3 * Margin);
+}
+#endif
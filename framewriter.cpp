@@ -0,0 +1,291 @@
+#include "include/framewriter.h"
+#include "SDL_image.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+FrameWriter::FrameWriter() :
+    _format(Format::Y4m),
+    _szFileName(nullptr),
+    _pFile(nullptr),
+    _width(0),
+    _height(0),
+    _pThread(nullptr),
+    _pLock(nullptr),
+    _pPending(nullptr),
+    _pFreed(nullptr),
+    _cQueued(0),
+    _cFree(0),
+    _fClosing(false),
+    _fFailed(false),
+    _pPlanes(nullptr),
+    _cFramesQueued(0),
+    _cFramesWritten(0),
+    _cStalls(0)
+{
+    SDL_zero(_pFrames);
+}
+
+FrameWriter::~FrameWriter()
+{
+    Close();
+}
+
+bool FrameWriter::Open(const char *szFileName, int width, int height, Uint32 framesPerSecond)
+{
+    SDL_assert(!IsOpen());
+    size_t cchFileName = SDL_strlen(szFileName);
+    if ((cchFileName > 4) && (SDL_strcasecmp(szFileName + cchFileName - 4, ".y4m") == 0))
+    {
+        // 4:2:0 needs the chroma planes to come out even
+        if (((width | height) & 1) != 0)
+        {
+            printf("Y4M frames need an even width and height, not %d x %d\n", width, height);
+            return false;
+        }
+        _format = Format::Y4m;
+        _pFile = fopen(szFileName, "wb");
+        if (_pFile == nullptr)
+        {
+            printf("Failed to create video file %s\n", szFileName);
+            return false;
+        }
+        fprintf(_pFile, "YUV4MPEG2 W%d H%d F%u:1 Ip A1:1 C420jpeg\n", width, height, framesPerSecond);
+        _pPlanes = new Uint8[(width * height) + (2 * (width / 2) * (height / 2))];
+    }
+    else if (SDL_strchr(szFileName, '%') != nullptr)
+    {
+        _format = Format::PngSequence;
+    }
+    else
+    {
+        printf("%s should be a .y4m file or a PNG pattern with the frame number in it (e.g. frame%%05d.png)\n", szFileName);
+        return false;
+    }
+
+    _szFileName = szFileName;
+    _width = width;
+    _height = height;
+    _cQueued = 0;
+    _cFree = 0;
+    for (Uint32 i = 0; i < BufferCount; i++)
+    {
+        _pFrames[i] = SDL_CreateRGBSurface(0, width, height, 32, 0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+        if (_pFrames[i] == nullptr)
+        {
+            printf("SDL_CreateRGBSurface() failed, error = %s\n", SDL_GetError());
+            Close();
+            return false;
+        }
+        _pFree[_cFree++] = _pFrames[i];
+    }
+    _fClosing = false;
+    _fFailed = false;
+    _cFramesQueued = 0;
+    _cFramesWritten = 0;
+    _cStalls = 0;
+
+    _pLock = SDL_CreateMutex();
+    _pPending = SDL_CreateCond();
+    _pFreed = SDL_CreateCond();
+    _pThread = SDL_CreateThread(WriterThread, "FrameWriter", this);
+    if (_pThread == nullptr)
+    {
+        printf("SDL_CreateThread() failed, error = %s\n", SDL_GetError());
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void FrameWriter::Close()
+{
+    bool fWriting = (_pThread != nullptr);
+    if (fWriting)
+    {
+        SDL_LockMutex(_pLock);
+        _fClosing = true;
+        SDL_CondSignal(_pPending);
+        SDL_UnlockMutex(_pLock);
+        SDL_WaitThread(_pThread, nullptr);
+        _pThread = nullptr;
+    }
+
+    if (_pFile != nullptr)
+    {
+        // The last of the Y4M frames only reach the disk here, as the buffer is flushed
+        if (ferror(_pFile) != 0)
+        {
+            _fFailed = true;
+        }
+        if (fclose(_pFile) != 0)
+        {
+            _fFailed = true;
+        }
+        _pFile = nullptr;
+    }
+    if (fWriting && _fFailed)
+    {
+        printf("Writing %s failed, %u of %u frames were written\n", _szFileName, _cFramesWritten, _cFramesQueued);
+    }
+    SDL_DestroyCond(_pFreed);
+    SDL_DestroyCond(_pPending);
+    SDL_DestroyMutex(_pLock);
+    _pFreed = nullptr;
+    _pPending = nullptr;
+    _pLock = nullptr;
+    for (Uint32 i = 0; i < BufferCount; i++)
+    {
+        SDL_FreeSurface(_pFrames[i]);
+        _pFrames[i] = nullptr;
+    }
+    _cQueued = 0;
+    _cFree = 0;
+    delete[] _pPlanes;
+    _pPlanes = nullptr;
+}
+
+// Game thread
+void FrameWriter::AddFrame(SDL_Surface *pSurface)
+{
+    SDL_assert(IsOpen() && (pSurface->w == _width) && (pSurface->h == _height));
+
+    SDL_LockMutex(_pLock);
+    if (_cFree == 0)
+    {
+        _cStalls++;
+        while (_cFree == 0)
+        {
+            SDL_CondWait(_pFreed, _pLock);
+        }
+    }
+    SDL_Surface *pFrame = _pFree[--_cFree];
+    SDL_UnlockMutex(_pLock);
+
+    // Nobody else touches a free frame, so the copy needs no lock
+    SDL_LockSurface(pSurface);
+    const Uint8 *pSource = static_cast<const Uint8*>(pSurface->pixels);
+    Uint8 *pTarget = static_cast<Uint8*>(pFrame->pixels);
+    for (int y = 0; y < _height; y++)
+    {
+        SDL_memcpy(pTarget + (y * pFrame->pitch), pSource + (y * pSurface->pitch), _width * 4);
+    }
+    SDL_UnlockSurface(pSurface);
+
+    SDL_LockMutex(_pLock);
+    _pQueue[_cQueued++] = pFrame;
+    _cFramesQueued++;
+    SDL_CondSignal(_pPending);
+    SDL_UnlockMutex(_pLock);
+}
+
+// Waits for frames and writes them out until we're closing and there's nothing left
+int FrameWriter::WriterThread(void *pData)
+{
+    FrameWriter *pThis = static_cast<FrameWriter*>(pData);
+
+    SDL_LockMutex(pThis->_pLock);
+    for (;;)
+    {
+        while ((pThis->_cQueued == 0) && !pThis->_fClosing)
+        {
+            SDL_CondWait(pThis->_pPending, pThis->_pLock);
+        }
+        if (pThis->_cQueued == 0)
+        {
+            break;
+        }
+
+        SDL_Surface *pFrame = pThis->_pQueue[0];
+        pThis->_cQueued--;
+        SDL_memmove(&pThis->_pQueue[0], &pThis->_pQueue[1], pThis->_cQueued * sizeof(pThis->_pQueue[0]));
+        bool fFailed = pThis->_fFailed;
+        SDL_UnlockMutex(pThis->_pLock);
+
+        if (!fFailed)
+        {
+            fFailed = !pThis->WriteFrame(pFrame);
+        }
+
+        SDL_LockMutex(pThis->_pLock);
+        pThis->_fFailed = fFailed;
+        pThis->_pFree[pThis->_cFree++] = pFrame;
+        SDL_CondSignal(pThis->_pFreed);
+    }
+    SDL_UnlockMutex(pThis->_pLock);
+    return 0;
+}
+
+// Writer thread
+bool FrameWriter::WriteFrame(SDL_Surface *pFrame)
+{
+    bool fResult = false;
+    if (_format == Format::Y4m)
+    {
+        fResult = WriteY4mFrame(pFrame);
+    }
+    else
+    {
+        char szFrameFile[1024];
+        SDL_snprintf(szFrameFile, sizeof(szFrameFile), _szFileName, _cFramesWritten);
+        fResult = (IMG_SavePNG(pFrame, szFrameFile) == 0);
+        if (!fResult)
+        {
+            printf("IMG_SavePNG() failed for %s, error = %s\n", szFrameFile, IMG_GetError());
+        }
+    }
+
+    if (fResult)
+    {
+        _cFramesWritten++;
+    }
+    return fResult;
+}
+
+// Writer thread.  BT.601 studio range, the chroma from the average of each 2x2 block
+bool FrameWriter::WriteY4mFrame(SDL_Surface *pFrame)
+{
+    int cxChroma = _width / 2;
+    int cyChroma = _height / 2;
+    Uint8 *pY = _pPlanes;
+    Uint8 *pU = pY + (_width * _height);
+    Uint8 *pV = pU + (cxChroma * cyChroma);
+
+    for (int y = 0; y < _height; y++)
+    {
+        const Uint32 *pRow = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(pFrame->pixels) + (y * pFrame->pitch));
+        for (int x = 0; x < _width; x++)
+        {
+            int r = (pRow[x] >> 16) & 0xFF;
+            int g = (pRow[x] >> 8) & 0xFF;
+            int b = pRow[x] & 0xFF;
+            pY[(y * _width) + x] = static_cast<Uint8>((((66 * r) + (129 * g) + (25 * b) + 128) >> 8) + 16);
+        }
+    }
+
+    for (int y = 0; y < cyChroma; y++)
+    {
+        const Uint32 *pRow0 = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(pFrame->pixels) + (2 * y * pFrame->pitch));
+        const Uint32 *pRow1 = reinterpret_cast<const Uint32*>(static_cast<const Uint8*>(pFrame->pixels) + (((2 * y) + 1) * pFrame->pitch));
+        for (int x = 0; x < cxChroma; x++)
+        {
+            Uint32 block[4] = { pRow0[2 * x], pRow0[(2 * x) + 1], pRow1[2 * x], pRow1[(2 * x) + 1] };
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            for (int i = 0; i < 4; i++)
+            {
+                r += (block[i] >> 16) & 0xFF;
+                g += (block[i] >> 8) & 0xFF;
+                b += block[i] & 0xFF;
+            }
+            r = (r + 2) / 4;
+            g = (g + 2) / 4;
+            b = (b + 2) / 4;
+            pU[(y * cxChroma) + x] = static_cast<Uint8>(((-38 * r) - (74 * g) + (112 * b) + (128 << 8) + 128) >> 8);
+            pV[(y * cxChroma) + x] = static_cast<Uint8>(((112 * r) - (94 * g) - (18 * b) + (128 << 8) + 128) >> 8);
+        }
+    }
+
+    size_t cbFrame = (_width * _height) + (2 * cxChroma * cyChroma);
+    return (fputs("FRAME\n", _pFile) >= 0) && (fwrite(_pPlanes, 1, cbFrame, _pFile) == cbFrame);
+}
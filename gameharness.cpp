@@ -16,14 +16,45 @@ using namespace XplatGameTutorial::PacManClone;
 #endif
 #endif
 
+// The roster cycles through the enabled types, so there has to be at least one
+#if !defined(GHOST_BLINKY) && !defined(GHOST_PINKY) && !defined(GHOST_CLYDE)
+#error At least one ghost type needs to be enabled
+#endif
+
+namespace
+{
+    // The harness's own part of SaveWorldState(), zeroed before it's filled so the padding compares equal too
+    struct WorldScalars
+    {
+        Uint32 cGhostCatches;
+        Uint32 cLevelsCompleted;
+        Uint32 cPowerPelletsEaten;
+        Uint32 autopilotSeed;
+        Uint16 cPelletsEaten;
+        bool fPowerPelletEaten;
+    };
+
+    // The replay viewer's timeline, along the bottom of the maze
+    const int TimelineMargin = 4;
+    const int TimelineHeight = 8;
+    const Uint32 ReplaySkipTicks = 10 * Constants::FramesPerSecond;
+
+    // The tick under x on the timeline
+    Uint32 TimelineTick(const SDL_Rect &timeline, int x, Uint32 cTicks)
+    {
+        int offset = SDL_max(SDL_min(x - timeline.x, timeline.w), 0);
+        return static_cast<Uint32>((static_cast<Uint64>(offset) * cTicks) / timeline.w);
+    }
+}
+
 // Duplicated code based on class type - perfect for a template function
-// This creates an object if it does not already exist, and in all cases
-// will Reset() the object
-template <class T> void InitGameSprite(T** p, TextureWrapper* pTexture, Maze* pMaze)
+// This creates an object (of type T, stored as a TBase) if it does not already exist,
+// and in all cases will Reset() the object
+template <class T, class TBase> void InitGameSprite(TBase** p, TextureWrapper* pTexture, ActorStore* pActorStore, Maze* pMaze)
 {
     if (*p == nullptr)
     {
-        *p = new T(pTexture);
+        *p = new T(pTexture, pActorStore);
         (*p)->Initialize();
     }
     (*p)->Reset(pMaze);
@@ -33,123 +64,951 @@ template <class T> void InitGameSprite(T** p, TextureWrapper* pTexture, Maze* pM
 SDL_bool GameHarness::Initialize()
 {
     SDL_assert(_fInitialized == false);
+    if (InitializeSDL(&_pSDLWindow, &_pSDLRenderer, _options.pacing == FramePacing::Vsync) != SDL_TRUE)
+    {
+        return SDL_FALSE;
+    }
+    _fKeyboardPlayer = true;
+    SDL_bool result = LoadResources();
+
+    // Not every driver can wait for the display, the pacer can do without it
+    SDL_RendererInfo info;
+    SDL_zero(info);
+    SDL_GetRendererInfo(_pSDLRenderer, &info);
+    _pacer.SetPacing(_options.pacing);
+    if ((_options.pacing == FramePacing::Vsync) && ((info.flags & SDL_RENDERER_PRESENTVSYNC) == 0))
+    {
+        printf("The renderer can't wait for vsync, pacing with the performance counter instead\n");
+        _pacer.SetPacing(FramePacing::Precise);
+    }
+
+    // What a frame should take, for spotting the ones that take longer
+    SDL_DisplayMode mode;
+    if (_pacer.Pacing() == FramePacing::Delay)
+    {
+        _targetFrameMs = Constants::TicksPerFrame;
+    }
+    else if ((_pacer.Pacing() == FramePacing::Vsync) && (SDL_GetWindowDisplayMode(_pSDLWindow, &mode) == 0) && (mode.refresh_rate > 0))
+    {
+        _targetFrameMs = 1000.0 / mode.refresh_rate;
+    }
+    else
+    {
+        _targetFrameMs = 1000.0 / Constants::FramesPerSecond;
+    }
+    return result;
+}
+
+// Same as above, but the renderer draws into a surface in memory, so no window (or display) is needed
+SDL_bool GameHarness::InitializeHeadless()
+{
+    SDL_assert(_fInitialized == false);
+    SDL_bool result = SDL_FALSE;
+    if (InitializeSDLHeadless(&_pSDLSurface, &_pSDLRenderer) == SDL_TRUE)
+    {
+        _fHeadless = true;
+        result = LoadResources();
+    }
+    return result;
+}
+
+// Textures and the storage for the sprites, shared by both of the above
+SDL_bool GameHarness::LoadResources()
+{
+    ALLOC_SCOPE(Loading);
     SDL_bool result = SDL_FALSE;
-    if (InitializeSDL(&_pSDLWindow, &_pSDLRenderer) == SDL_TRUE)
+
+    // Load our textures
+    SDL_Color colorKey = Constants::SDLColorMagenta;
+    _pTilesTexture = new TextureWrapper(Constants::TilesImage, SDL_strlen(Constants::TilesImage), _pSDLRenderer, nullptr);
+    _pSpriteTexture = new TextureWrapper(Constants::SpritesImage, SDL_strlen(Constants::SpritesImage), _pSDLRenderer, &colorKey);
+    _pTitleTexture = new TextureWrapper(Constants::TitleImage, SDL_strlen(Constants::TitleImage), _pSDLRenderer, nullptr);
+
+    if (_pTilesTexture->IsNull() || _pSpriteTexture->IsNull() || _pTitleTexture->IsNull())
+    {
+        printf("Failed to load one or more textures\n");
+    }
+    else
     {
-        // Load our textures
-        SDL_Color colorKey = Constants::SDLColorMagenta;
-        _pTilesTexture = new TextureWrapper(Constants::TilesImage, SDL_strlen(Constants::TilesImage), _pSDLRenderer, nullptr);
-        _pSpriteTexture = new TextureWrapper(Constants::SpritesImage, SDL_strlen(Constants::SpritesImage), _pSDLRenderer, &colorKey);
-        _pTitleTexture = new TextureWrapper(Constants::TitleImage, SDL_strlen(Constants::TitleImage), _pSDLRenderer, nullptr);
+        // The roster.  Outside of stress mode it's always 1 player and the ghosts enabled by the flags above
+        const GhostType enabledTypes[] =
+        {
+#ifdef GHOST_BLINKY
+            GhostType::Blinky,
+#endif
+#ifdef GHOST_PINKY
+            GhostType::Pinky,
+#endif
+#ifdef GHOST_INKY
+            GhostType::Inky,
+#endif
+#ifdef GHOST_CLYDE
+            GhostType::Clyde,
+#endif
+        };
+        _cPlayers = _options.fStress ? _options.cPlayers : 1;
+        _cGhosts = _options.fStress ? _options.cGhosts : static_cast<Uint16>(SDL_arraysize(enabledTypes));
+        SDL_assert(_cPlayers <= Constants::MaxPlayers);
+        SDL_assert(_cGhosts <= Constants::MaxGhosts);
+
+        // Everything sized from the roster lives in one arena, with the level's data on top of it so
+        // starting the level over is just a rewind (see InitLevel())
+        Uint16 cOccupancyItems = SDL_max(_cGhosts, 1);
+        Uint16 cMapTiles = Constants::MapRows * Constants::MapCols;
+        Uint16 cTargets = _options.fStress ? 0 : _cGhosts;
+        size_t cbRenderSide = 0;
+        bool fDrawsFrames = !_fHeadless || (_options.szVideoFile != nullptr);
+        if (fDrawsFrames)
+        {
+            // Three snapshots for the triple buffer, and the render side's copy of the maze
+            cbRenderSide = (3 * (Arena::Bytes<Uint16>(cMapTiles) + Arena::Bytes<SpriteDraw>(_cPlayers + _cGhosts) +
+                Arena::Bytes<TargetDraw>(cTargets))) + TiledMap::ArenaBytes(MazeTextureRect(), MazeTileRect(), cMapTiles);
+            if (_options.szExportName != nullptr)
+            {
+                cbRenderSide += 3 * Arena::Bytes<ActorState>(_cPlayers + _cGhosts);
+            }
+        }
+        _arena.Reserve(Arena::Bytes<Player*>(_cPlayers) + Arena::Bytes<Ghost*>(_cGhosts) + Arena::Bytes<GhostType>(_cGhosts) +
+            OccupancyGrid::ArenaBytes(Constants::MapRows, Constants::MapCols, cOccupancyItems) +
+            ActorStore::ArenaBytes(_cPlayers + _cGhosts) + cbRenderSide +
+            TiledMap::ArenaBytes(MazeTextureRect(), MazeTileRect(), cMapTiles));
 
-        if (_pTilesTexture->IsNull() || _pSpriteTexture->IsNull() || _pTitleTexture->IsNull())
+        _ppPlayers = _arena.Allocate<Player*>(_cPlayers);
+        _ppGhosts = _arena.Allocate<Ghost*>(_cGhosts);
+        _pGhostTypes = _arena.Allocate<GhostType>(_cGhosts);
+        for (Uint16 i = 0; i < _cGhosts; i++)
         {
-            printf("Failed to load one or more textures\n");
+            // Stress mode just cycles through the types, so Blinky always comes before the
+            // Inky that needs him
+            _pGhostTypes[i] = enabledTypes[i % SDL_arraysize(enabledTypes)];
         }
-        else
+        _pOccupancy = new OccupancyGrid(Constants::MapRows, Constants::MapCols, cOccupancyItems, &_arena);
+
+        // Every sprite claims a slot here when it is first created
+        _pAnimations = new AnimationRegistry();
+        _pActorStore = new ActorStore(_pAnimations);
+        _pActorStore->Reserve(_cPlayers + _cGhosts, &_arena);
+
+        if (fDrawsFrames)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                RenderSnapshot &snapshot = _snapshots.Slot(i);
+                snapshot.cPlayers = _cPlayers;
+                snapshot.cGhosts = _cGhosts;
+                snapshot.pMapIndicies = _arena.Allocate<Uint16>(cMapTiles);
+                snapshot.pSprites = _arena.Allocate<SpriteDraw>(_cPlayers + _cGhosts);
+                snapshot.pTargets = (cTargets > 0) ? _arena.Allocate<TargetDraw>(cTargets) : nullptr;
+                snapshot.pActors = (_options.szExportName != nullptr) ? _arena.Allocate<ActorState>(_cPlayers + _cGhosts) : nullptr;
+            }
+            _pMazeView = new TiledMap(Constants::MapRows, Constants::MapCols, Constants::ScreenWidth, Constants::ScreenHeight);
+            _pMazeView->Initialize(MazeTextureRect(), MazeTileRect(), _pTilesTexture->Ptr(), Constants::MapIndicies, cMapTiles, &_arena);
+
+            // Worst case frame: every tile, every sprite, and a rect plus a line or a circle of points for each target
+            _renderCommands.Reserve(cMapTiles + _cPlayers + _cGhosts + (2 * cTargets),
+                cTargets * static_cast<Uint32>(SDL_arraysize(Constants::CosineTable)));
+            _pRenderTextures[static_cast<int>(RenderTexture::None)] = nullptr;
+            _pRenderTextures[static_cast<int>(RenderTexture::Tiles)] = _pTilesTexture->Ptr();
+            _pRenderTextures[static_cast<int>(RenderTexture::Sprites)] = _pSpriteTexture->Ptr();
+            _pRenderTextures[static_cast<int>(RenderTexture::Title)] = _pTitleTexture->Ptr();
+
+            // The whole frame as the renderer has it, which is more than ScreenWidth x ScreenHeight on a high DPI display
+            int cxOutput = 0;
+            int cyOutput = 0;
+            if ((_options.szExportName != nullptr) && (SDL_GetRendererOutputSize(_pSDLRenderer, &cxOutput, &cyOutput) == 0) &&
+                _export.Open(_options.szExportName, cxOutput, cyOutput, _cPlayers + _cGhosts, Constants::MapRows, Constants::MapCols))
+            {
+                printf("Exporting frames to shared memory %s (%d x %d)\n", _options.szExportName, cxOutput, cyOutput);
+            }
+        }
+        _levelMark = _arena.Mark();
+
+#ifdef ENABLE_PROFILER
+        if ((_options.szTraceFile != nullptr) && _trace.Open(_options.szTraceFile))
+        {
+            _profiler.SetTraceRecorder(&_trace);
+            _pActorStore->SetTraceRecorder(&_trace);
+        }
+#endif
+        if (_options.szRecordFile != nullptr)
+        {
+            // Somewhere to save the keyframes to on their way to the file
+            _pWorldState = new Uint8[WorldStateBytes()];
+            _recorder.Open(&_diskWriter, _options.szRecordFile, _options.fStress, _cPlayers, _cGhosts, static_cast<Uint32>(WorldStateBytes()));
+        }
+        if (_options.szLatencyFile != nullptr)
+        {
+            // How the frames were paced, so runs with different settings can be told apart
+            SDL_RendererInfo info;
+            SDL_zero(info);
+            SDL_GetRendererInfo(_pSDLRenderer, &info);
+            char szConfig[128];
+            const char *PacingNames[] = { "delay", "precise", "vsync" };
+            SDL_snprintf(szConfig, sizeof(szConfig), "loop=%s pacing=%s vsync=%s renderer=%s",
+                _options.fSingleThread ? "lockstep" : "threaded", PacingNames[static_cast<int>(_options.pacing)],
+                ((info.flags & SDL_RENDERER_PRESENTVSYNC) != 0) ? "on" : "off", (info.name != nullptr) ? info.name : "unknown");
+            _latency.OpenCsv(&_diskWriter, _options.szLatencyFile, szConfig);
+        }
+        if (_options.szCaptureFile != nullptr)
         {
-            _fInitialized = true;
-            result = SDL_TRUE;
+            // Room for two of the biggest frames, so F12 never waits on the disk
+            Uint32 capacity = 1;
+            while (capacity < 2 * _renderCommands.SavedBytesMax())
+            {
+                capacity <<= 1;
+            }
+            _pCaptureStream = _diskWriter.Open(_options.szCaptureFile, capacity, DiskStream::Overflow::Drop);
         }
+        if (_options.szHeatmapFile != nullptr)
+        {
+            // Only the counts are kept, the file can go once they're in
+            FactStore facts;
+            bool fOpen = facts.Open(_options.szHeatmapFile);
+            if (fOpen && ((facts.MapRows() != Constants::MapRows) || (facts.MapCols() != Constants::MapCols)))
+            {
+                printf("%s is of a %ux%u map, not this maze, no heatmaps\n", _options.szHeatmapFile, facts.MapCols(), facts.MapRows());
+            }
+            else if (fOpen)
+            {
+                _heatmap.Build(facts, static_cast<Uint32>(SDL_GetCPUCount()));
+            }
+        }
+        _fInitialized = true;
+        result = SDL_TRUE;
     }
     return result;
 }
 
-// Main loop, process window messages and dispatch to the current GameState handler
+// Main loop.  The simulation runs on a thread of its own and hands each step's result to this one
+// as a RenderSnapshot, so a slow SDL_RenderPresent() (waiting on the GPU or the display) never holds
+// up input or the updates.  SDL wants its window and renderer used from the thread that created them,
+// so it's the simulation that moves off the main thread rather than the drawing
 void GameHarness::Run()
 {
     SDL_assert(_fInitialized);
-    static bool fQuit = false;
-    SDL_Event eventSDL;
+    if (_options.fSingleThread)
+    {
+        RunLockstep();
+    }
+    else
+    {
+        RunThreaded();
+    }
+
+    // With no F12, the frame that was up when the game closed
+    if ((_pCaptureStream != nullptr) && !_fFrameCaptured && (_renderCommands.Count() > 0))
+    {
+        _renderCommands.Save(_pCaptureStream);
+    }
+
+    // What the title and level start screens cost (compare with --no-idle-wait)
+    TrackStaticScreens(IsStaticState(_state), false);
+    if (_staticTicks > 0)
+    {
+        double seconds = _staticTicks / 1000.0;
+        printf("Title and level start screens: %.1f s, %.2f s of CPU (%.1f%% of a core), %u frames not redrawn\n",
+            seconds, _staticCpuSeconds, 100.0 * _staticCpuSeconds / seconds, _cFramesNotRedrawn);
+    }
+    _frameTimes.PrintSummary(_targetFrameMs);
+    if ((_pacer.LateSteps() > 0) || (_pacer.DroppedSteps() > 0))
+    {
+        printf("Pacing: %u steps late, %u dropped\n", _pacer.LateSteps(), _pacer.DroppedSteps());
+    }
+    _latency.PrintSummary();
+    if (_input.TurnsTaken() > 0)
+    {
+        printf("Turns: %u taken, %u of them buffered until legal (%.0f ms on average), %u replaced, %u key events dropped\n",
+            _input.TurnsTaken(), _input.TurnsBuffered(),
+            (_input.TurnsBuffered() > 0) ? static_cast<double>(_input.BufferedMs()) / _input.TurnsBuffered() : 0.0,
+            _input.TurnsReplaced(), _inputQueue.Dropped());
+    }
+
+    // cleanup
+    Cleanup();
+}
 
-    Uint32 startTicks;
+// Everything on the one thread, one simulation step then one frame drawn and presented.  With vsync the
+// present does the waiting, so there can be a few steps a frame (or none) to keep the game's speed
+void GameHarness::RunLockstep()
+{
+    bool fQuit = false;
+    bool fDrawn = true;
+    _pacer.Start();
     while (!fQuit)
     {
-        startTicks = SDL_GetTicks();
-        while (SDL_PollEvent(&eventSDL) != 0)
+        PROFILE_BEGIN_FRAME(&_profiler);
+        ALLOC_BEGIN_FRAME(_state == GameState::Running);
+
+        // TIMING
+        // Wait for the step before reading the input rather than after presenting, so the step gets the latest
+        Uint32 cSteps = 0;
         {
-            if (eventSDL.type == SDL_QUIT)
+            PROFILE_PHASE(&_profiler, Delay);
+            if (!fDrawn)
             {
-                fQuit = true;
+                // Nothing changes on the title until there's an event, the wait before a level only needs its timer
+                // checking each frame, and either way an event (a key, the window closing) ends the wait early
+                bool fTitle = (_state == GameState::Title);
+                SDL_WaitEventTimeout(nullptr, fTitle ? Constants::IdleWaitTicks : _pacer.MsUntilDue());
+                if (fTitle)
+                {
+                    _pacer.Start();
+                }
             }
+            cSteps = _pacer.WaitForStep();
+        }
+
+        fQuit = PumpEvents();
+        for (Uint32 step = 0; (step < cSteps) && !fQuit; step++)
+        {
+            fQuit = StepGame();
         }
 
         if (!fQuit)
         {
-            switch (_state)
+            // Draw the current frame, unless it's a static screen that's already up
+            CaptureSnapshot();
+            _snapshots.Acquire();
+            fDrawn = NeedsRender(_snapshots.Front());
+            if (fDrawn)
+            {
+                Render(_snapshots.Front());
+                Present(_snapshots.Front());
+            }
+            else
             {
-            case GameState::Title:
-                Direction inputDirection;
-                if (ProcessInput(&inputDirection))
+                _frameTimes.Break();
+            }
+        }
+        ALLOC_END_FRAME();
+        PROFILE_END_FRAME(&_profiler);
+    }
+}
+
+// The main thread keeps the window responsive and draws the newest snapshot whenever there is one,
+// the simulation thread steps the game at its own fixed rate (see SimulationThread())
+void GameHarness::RunThreaded()
+{
+#ifdef ENABLE_PROFILER
+    _pPresentProfiler = &_presentProfiler;
+#endif
+    // The display paces the presents, the simulation keeps its own time
+    if (_pacer.Pacing() == FramePacing::Vsync)
+    {
+        _pacer.SetPacing(FramePacing::Precise);
+    }
+
+    // How the two threads wake each other on the static screens
+    if (_options.fIdleWait)
+    {
+        _wakeEventType = SDL_RegisterEvents(1);
+        _pInputSignal = SDL_CreateSemaphore(0);
+    }
+    SDL_Thread *pSimThread = SDL_CreateThread(SimulationThread, "Simulation", this);
+    if (pSimThread == nullptr)
+    {
+        printf("SDL_CreateThread() failed, error = %s, running on one thread\n", SDL_GetError());
+#ifdef ENABLE_PROFILER
+        _pPresentProfiler = &_profiler;
+#endif
+        RunLockstep();
+        return;
+    }
+
+    while (!_fSimulationDone.load(std::memory_order_acquire))
+    {
+        // A frame here runs from one present to the next, waiting for the snapshot included
+        PROFILE_BEGIN_FRAME(_pPresentProfiler);
+        bool fPresented = false;
+        while (!fPresented && !_fSimulationDone.load(std::memory_order_acquire))
+        {
+            if (PumpEvents())
+            {
+                _fQuitRequested.store(true, std::memory_order_release);
+                WakeSimulation();
+            }
+
+            bool fFresh = _snapshots.Acquire();
+            if ((fFresh || (_fRepaint && (_presentedScene != 0))) && NeedsRender(_snapshots.Front()))
+            {
+                Render(_snapshots.Front());
+                Present(_snapshots.Front());
+                fPresented = true;
+            }
+            else if ((_wakeEventType != static_cast<Uint32>(-1)) && (_presentedScene != 0) && _snapshots.Front().fStatic)
+            {
+                // A static screen that's already up, nothing to do until there's an event or the simulation publishes
+                // a change.  Check again once it knows to wake us, so a change published in between isn't missed
+                bool fChanged = false;
+                _frameTimes.Break();
                 {
-                    _state = GameState::Exiting;
+                    PROFILE_PHASE(_pPresentProfiler, Delay);
+                    _fRenderIdle.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    fChanged = _snapshots.Acquire();
+                    if (!fChanged)
+                    {
+                        SDL_WaitEventTimeout(nullptr, Constants::IdleWaitTicks);
+                    }
+                    _fRenderIdle.store(false, std::memory_order_relaxed);
                 }
-                else if (inputDirection != Direction::None)
+                if (fChanged && NeedsRender(_snapshots.Front()))
                 {
-                    _state = GameState::WaitingToStartLevel;
+                    Render(_snapshots.Front());
+                    Present(_snapshots.Front());
+                    fPresented = true;
+                }
+            }
+            else
+            {
+                // Nothing new yet, don't spin on it
+                PROFILE_PHASE(_pPresentProfiler, Delay);
+                SDL_Delay(1);
+            }
+        }
+        PROFILE_END_FRAME(_pPresentProfiler);
+    }
+
+    // The simulation is done with everything by the time it exits, so Cleanup() can have it all
+    SDL_WaitThread(pSimThread, nullptr);
+    SDL_DestroySemaphore(_pInputSignal);
+    _pInputSignal = nullptr;
+}
+
+// The state machine at Constants::FramesPerSecond (see FramePacer), until it exits or the window is closed
+int GameHarness::SimulationThread(void *pData)
+{
+    GameHarness *pThis = static_cast<GameHarness*>(pData);
+    bool fQuit = false;
+    pThis->_pacer.Start();
+    while (!fQuit)
+    {
+        PROFILE_BEGIN_FRAME(&pThis->_profiler);
+        ALLOC_BEGIN_FRAME(pThis->_state == GameState::Running);
+
+        // Wait for the step before reading the input, so it gets the latest
+        {
+            PROFILE_PHASE(&pThis->_profiler, Delay);
+            pThis->_pacer.WaitForStep();
+        }
+
+        // Nothing happens on the title until there's input.  Say so before reading it, so input that
+        // arrives after the read wakes us (see WakeSimulation())
+        bool fWaitForInput = (pThis->_pInputSignal != nullptr) && (pThis->_state == GameState::Title);
+        if (fWaitForInput)
+        {
+            pThis->_fSimulationIdle.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        fQuit = pThis->_fQuitRequested.load(std::memory_order_acquire) || pThis->StepGame();
+        if (!fQuit)
+        {
+            pThis->CaptureSnapshot();
+            if (fWaitForInput && (pThis->_state == GameState::Title))
+            {
+                PROFILE_PHASE(&pThis->_profiler, Delay);
+                SDL_SemWaitTimeout(pThis->_pInputSignal, Constants::IdleWaitTicks);
+                pThis->_pacer.Start();
+            }
+        }
+        pThis->_fSimulationIdle.store(false, std::memory_order_relaxed);
+        ALLOC_END_FRAME();
+        PROFILE_END_FRAME(&pThis->_profiler);
+    }
+    pThis->_fSimulationDone.store(true, std::memory_order_release);
+    return 0;
+}
+
+// Window messages, returns true once it's closed
+bool GameHarness::PumpEvents()
+{
+    PROFILE_PHASE(_pPresentProfiler, EventPump);
+    bool fQuit = false;
+    SDL_Event eventSDL;
+    while (SDL_PollEvent(&eventSDL) != 0)
+    {
+        if (eventSDL.type == SDL_QUIT)
+        {
+            fQuit = true;
+        }
+        else if ((eventSDL.type == SDL_WINDOWEVENT) && (eventSDL.window.event == SDL_WINDOWEVENT_EXPOSED))
+        {
+            // Uncovered, a static screen needs drawing again
+            _fRepaint = true;
+        }
+#ifdef ENABLE_PROFILER
+        else if ((eventSDL.type == SDL_KEYDOWN) && (eventSDL.key.keysym.scancode == SDL_SCANCODE_F3) &&
+            (eventSDL.key.repeat == 0))
+        {
+            _profiler.ToggleOverlay();
+        }
+#endif
+        else if ((eventSDL.type == SDL_KEYDOWN) && (eventSDL.key.keysym.scancode == SDL_SCANCODE_F12) &&
+            (eventSDL.key.repeat == 0) && (_pCaptureStream != nullptr))
+        {
+            _fCaptureRequested = true;
+        }
+        else if ((eventSDL.type == SDL_KEYDOWN) && (eventSDL.key.keysym.scancode == SDL_SCANCODE_F4) &&
+            (eventSDL.key.repeat == 0) && _heatmap.IsBuilt())
+        {
+            CycleHeatmap();
+        }
+        else if (((eventSDL.type == SDL_KEYDOWN) || (eventSDL.type == SDL_KEYUP)) && (eventSDL.key.repeat == 0))
+        {
+            // Ahead of these the function keys would never get a look in
+            QueueInput(eventSDL.key);
+        }
+    }
+    return fQuit;
+}
+
+// One step of the state machine, dispatched to the current GameState handler.  Returns true when exiting
+bool GameHarness::StepGame()
+{
+    bool fQuit = false;
+    GameState prevState = _state;
+    DrainInput();
+    switch (_state)
+    {
+    case GameState::Title:
+        Direction inputDirection;
+        if (ProcessInput(&inputDirection))
+        {
+            _state = GameState::Exiting;
+        }
+        else if (inputDirection != Direction::None)
+        {
+            _state = GameState::WaitingToStartLevel;
+        }
+        break;
+    case GameState::LoadingResources:
+        // Loads the current maze and the sprites if needed
+        _state = OnLoading();
+        break;
+    case GameState::WaitingToStartLevel:
+        // Small delay before level starts
+        _state = OnWaitingToStartLevel();
+        break;
+    case GameState::Running:
+        // Normal gameplay
+        _state = OnRunning();
+        break;
+    case GameState::PlayerDying:
+        // Death animation, skip for now since no ghosts
+        _state = GameState::WaitingToStartLevel;
+        break;
+    case GameState::LevelComplete:
+        // Flashing level animation
+        _state = OnLevelComplete();
+        break;
+    case GameState::GameOver:
+        // Final drawing of level, score, etc
+        break;
+    case GameState::Exiting:
+        fQuit = true;
+        break;
+    }
+
+    if (_state != prevState)
+    {
+        TRACE_INSTANT(&_trace, GameStateName(_state), "state", -1, GameStateName(prevState));
+        TrackStaticScreens(IsStaticState(prevState), IsStaticState(_state));
+        _sceneVersion++;
+    }
+    _cSimFrames++;
+    return fQuit;
+}
+
+// The simulation with everything else stripped away, for benchmarking.  There is no title or
+// level start delay, a completed level simply starts over.  That's all the simulation ever sees
+// of those in the real game too, so a replay here ends up exactly where the recording did
+Uint32 GameHarness::RunHeadless(Uint32 cTicks, const Replay *pReplay, FrameWriter *pVideo)
+{
+    SDL_assert(_fInitialized && _fHeadless);
+    SDL_assert((pVideo == nullptr) || (_pMazeView != nullptr));
+    SDL_assert((pReplay == nullptr) || (cTicks <= pReplay->Info().cTicks));
+    _fKeyboardPlayer = (pReplay != nullptr);
+    InitLevel();
+
+    // The replay's keyframes should be exactly what we have at those ticks, unless they're from another build
+    bool fCheckKeyframes = (pReplay != nullptr) && (pReplay->KeyframeCount() > 0) && (pReplay->KeyframeBytes() == WorldStateBytes());
+    Uint32 cKeyframesChecked = 0;
+    Uint32 cKeyframesDiffer = 0;
+    Uint32 firstDifferTick = 0;
+    if (fCheckKeyframes && (_pWorldState == nullptr))
+    {
+        _pWorldState = new Uint8[WorldStateBytes()];
+    }
+
+    for (Uint32 tick = 0; tick < cTicks; tick++)
+    {
+        PROFILE_BEGIN_FRAME(&_profiler);
+        ALLOC_BEGIN_FRAME(true);
+        Uint32 keyframe = fCheckKeyframes ? pReplay->KeyframeBefore(tick) : 0;
+        if (fCheckKeyframes && (pReplay->KeyframeTick(keyframe) == tick))
+        {
+            SaveWorldState(_pWorldState);
+            if (SDL_memcmp(_pWorldState, pReplay->KeyframeState(keyframe), WorldStateBytes()) != 0)
+            {
+                firstDifferTick = (cKeyframesDiffer == 0) ? tick : firstDifferTick;
+                cKeyframesDiffer++;
+            }
+            cKeyframesChecked++;
+        }
+        Direction input = (pReplay != nullptr) ? pReplay->Input(tick) : Direction::None;
+        if ((UpdateSimulation(input) == GameState::LevelComplete) && (tick + 1 < cTicks))
+        {
+            InitLevel();
+        }
+
+        // The software renderer draws straight into _pSDLSurface, which the writer copies
+        if ((pVideo != nullptr) || _export.IsOpen())
+        {
+            CaptureSnapshot();
+            _snapshots.Acquire();
+            Render(_snapshots.Front());
+            SDL_RenderPresent(_pSDLRenderer);
+            if (pVideo != nullptr)
+            {
+                pVideo->AddFrame(_pSDLSurface);
+            }
+        }
+        ALLOC_END_FRAME();
+        PROFILE_END_FRAME(&_profiler);
+    }
+
+    // Finish the video while SDL is still up to write it
+    if (pVideo != nullptr)
+    {
+        pVideo->Close();
+    }
+    if (cKeyframesDiffer > 0)
+    {
+        printf("%u of %u keyframes differ from the replay, the first at tick %u\n", cKeyframesDiffer, cKeyframesChecked, firstDifferTick);
+    }
+    Uint32 checksum = StateChecksum();
+    Cleanup();
+    return checksum;
+}
+
+// The replay in the window, paced like the game.  It starts straight into the level like RunHeadless(),
+// the recording only has the ticks that were played.  Going back means restoring the keyframe before
+// where we're going and simulating forward from there, see SeekReplay()
+void GameHarness::RunReplay(const Replay &replay)
+{
+    SDL_assert(_fInitialized && !_fHeadless);
+    SDL_assert((replay.Info().cPlayers == _cPlayers) && (replay.Info().cGhosts == _cGhosts));
+    OnLoading();
+    _state = GameState::Running;
+    _fKeyboardPlayer = true;
+
+    // Where seeking starts from without keyframes, which is also what the first one should be.  --record
+    // keeps its keyframes in the same buffer, so a replay can't be recorded as well (main.cpp sees to that)
+    SDL_assert(_pWorldState == nullptr);
+    _pWorldState = new Uint8[WorldStateBytes()];
+    SaveWorldState(_pWorldState);
+    _fReplayKeyframes = (replay.KeyframeCount() > 0) && (replay.KeyframeBytes() == WorldStateBytes());
+    if (replay.KeyframeCount() == 0)
+    {
+        printf("%s has no keyframes, seeking replays it from the start\n", _options.szReplayFile);
+    }
+    else if (!_fReplayKeyframes)
+    {
+        printf("%s's keyframes are from a different build, seeking replays it from the start\n", _options.szReplayFile);
+    }
+    printf("Replaying %u ticks: space pauses, left and right step a tick, page up and down skip 10 s, home and end, "
+        "click or drag the timeline to seek\n", replay.Info().cTicks);
+
+    bool fQuit = false;
+    _pacer.Start();
+    while (!fQuit)
+    {
+        PROFILE_BEGIN_FRAME(&_profiler);
+        ALLOC_BEGIN_FRAME(true);
+        Uint32 cSteps = 0;
+        {
+            PROFILE_PHASE(&_profiler, Delay);
+            cSteps = _pacer.WaitForStep();
+        }
+
+        fQuit = PumpReplayEvents(replay);
+        if (!_fReplayPaused && !_fScrubbing)
+        {
+            for (Uint32 step = 0; (step < cSteps) && (_replayTick < replay.Info().cTicks); step++)
+            {
+                StepReplay(replay);
+            }
+            _fReplayPaused = (_replayTick == replay.Info().cTicks);
+        }
+
+        if (!fQuit)
+        {
+            CaptureSnapshot();
+            _snapshots.Acquire();
+            Render(_snapshots.Front());
+            RenderTimeline(replay);
+            Present(_snapshots.Front());
+        }
+        ALLOC_END_FRAME();
+        PROFILE_END_FRAME(&_profiler);
+    }
+
+    if (_cSeeks > 0)
+    {
+        printf("Seeks: %u, taking %.2f ms and %.0f ticks simulated on average\n", _cSeeks,
+            (_seekCounter * 1000.0) / (SDL_GetPerformanceFrequency() * static_cast<double>(_cSeeks)), static_cast<double>(_cSeekTicks) / _cSeeks);
+    }
+    Cleanup();
+}
+
+// The viewer's window messages and controls, returns true once it's closed:
+//   Space - pause and play (from the start again at the end)
+//   Left, Right - back or forward a tick, paused
+//   Page Up, Page Down - back or forward 10 seconds
+//   Home, End - the start or the end
+//   Click or drag on the timeline - that point in the replay
+bool GameHarness::PumpReplayEvents(const Replay &replay)
+{
+    PROFILE_PHASE(_pPresentProfiler, EventPump);
+    const Uint32 cTicks = replay.Info().cTicks;
+    SDL_Rect timeline = TimelineRect();
+    bool fQuit = false;
+    bool fScrubbed = false;
+    Uint32 scrubTick = 0;
+    SDL_Event eventSDL;
+    while (SDL_PollEvent(&eventSDL) != 0)
+    {
+        if ((eventSDL.type == SDL_QUIT) ||
+            ((eventSDL.type == SDL_KEYDOWN) && (eventSDL.key.keysym.scancode == SDL_SCANCODE_ESCAPE)))
+        {
+            fQuit = true;
+        }
+        else if (eventSDL.type == SDL_KEYDOWN)
+        {
+            switch (eventSDL.key.keysym.scancode)
+            {
+            case SDL_SCANCODE_SPACE:
+                if (eventSDL.key.repeat == 0)
+                {
+                    if (_fReplayPaused && (_replayTick == cTicks))
+                    {
+                        SeekReplay(replay, 0);
+                    }
+                    _fReplayPaused = !_fReplayPaused;
                 }
                 break;
-            case GameState::LoadingResources:
-                // Loads the current maze and the sprites if needed
-                _state = OnLoading();
+            case SDL_SCANCODE_LEFT:
+                // Held down these keep stepping
+                _fReplayPaused = true;
+                SeekReplay(replay, (_replayTick > 0) ? _replayTick - 1 : 0);
                 break;
-            case GameState::WaitingToStartLevel:
-                // Small delay before level starts
-                _state = OnWaitingToStartLevel();
+            case SDL_SCANCODE_RIGHT:
+                _fReplayPaused = true;
+                SeekReplay(replay, _replayTick + 1);
                 break;
-            case GameState::Running:
-                // Normal gameplay
-                _state = OnRunning();
+            case SDL_SCANCODE_PAGEUP:
+                SeekReplay(replay, (_replayTick > ReplaySkipTicks) ? _replayTick - ReplaySkipTicks : 0);
                 break;
-            case GameState::PlayerDying:
-                // Death animation, skip for now since no ghosts
-                _state = GameState::WaitingToStartLevel;
+            case SDL_SCANCODE_PAGEDOWN:
+                SeekReplay(replay, _replayTick + ReplaySkipTicks);
                 break;
-            case GameState::LevelComplete:
-                // Flashing level animation
-                _state = OnLevelComplete();
+            case SDL_SCANCODE_HOME:
+                SeekReplay(replay, 0);
                 break;
-            case GameState::GameOver:
-                // Final drawing of level, score, etc
+            case SDL_SCANCODE_END:
+                SeekReplay(replay, cTicks);
+                break;
+#ifdef ENABLE_PROFILER
+            case SDL_SCANCODE_F3:
+                if (eventSDL.key.repeat == 0)
+                {
+                    _profiler.ToggleOverlay();
+                }
+                break;
+#endif
+            case SDL_SCANCODE_F4:
+                if ((eventSDL.key.repeat == 0) && _heatmap.IsBuilt())
+                {
+                    CycleHeatmap();
+                }
                 break;
-            case GameState::Exiting:
-                fQuit = true;
+            default:
                 break;
             }
+        }
+        else if ((eventSDL.type == SDL_MOUSEBUTTONDOWN) && (eventSDL.button.button == SDL_BUTTON_LEFT))
+        {
+            // A little slack above and below, the bar itself is thin
+            SDL_Rect target = { timeline.x, timeline.y - TimelineMargin, timeline.w, timeline.h + (2 * TimelineMargin) };
+            SDL_Point point = { eventSDL.button.x, eventSDL.button.y };
+            if (SDL_PointInRect(&point, &target))
+            {
+                _fScrubbing = true;
+                fScrubbed = true;
+                scrubTick = TimelineTick(timeline, point.x, cTicks);
+            }
+        }
+        else if ((eventSDL.type == SDL_MOUSEMOTION) && _fScrubbing)
+        {
+            fScrubbed = true;
+            scrubTick = TimelineTick(timeline, eventSDL.motion.x, cTicks);
+        }
+        else if ((eventSDL.type == SDL_MOUSEBUTTONUP) && (eventSDL.button.button == SDL_BUTTON_LEFT))
+        {
+            _fScrubbing = false;
+        }
+    }
 
-            // Draw the current frame
-            Render();
+    // Only where the mouse ended up, a drag can bring a lot of motion in one frame
+    if (fScrubbed)
+    {
+        SeekReplay(replay, scrubTick);
+    }
+    return fQuit;
+}
 
-            // TIMING
-            // Fix this at ~c_framesPerSecond
-            Uint32 endTicks = SDL_GetTicks();
-            Uint32 elapsedTicks = endTicks - startTicks;
-            if (elapsedTicks < Constants::TicksPerFrame)
+// One tick of the replay, a completed level starts over straight away as in RunHeadless()
+void GameHarness::StepReplay(const Replay &replay)
+{
+    SDL_assert(_replayTick < replay.Info().cTicks);
+    if ((UpdateSimulation(replay.Input(_replayTick)) == GameState::LevelComplete) && (_replayTick + 1 < replay.Info().cTicks))
+    {
+        InitLevel();
+    }
+    _replayTick++;
+    _cSimFrames++;
+}
+
+// Gets the world to where it was before the replay's tick.  Going forward a little is just more steps,
+// otherwise it's from the keyframe before the tick, so never more than the keyframe interval to simulate.
+// A keyframe that doesn't restore the recorded checksum means none of them can be trusted, and from then
+// on it's from the start every time
+void GameHarness::SeekReplay(const Replay &replay, Uint32 tick)
+{
+    tick = SDL_min(tick, replay.Info().cTicks);
+    if (tick == _replayTick)
+    {
+        return;
+    }
+
+    Uint64 startCounter = SDL_GetPerformanceCounter();
+    Uint32 keyframe = _fReplayKeyframes ? replay.KeyframeBefore(tick) : 0;
+    Uint32 fromTick = _fReplayKeyframes ? replay.KeyframeTick(keyframe) : 0;
+    if ((tick < _replayTick) || (fromTick > _replayTick))
+    {
+        if (_fReplayKeyframes)
+        {
+            RestoreWorldState(replay.KeyframeState(keyframe));
+            if (StateChecksum() != replay.KeyframeChecksum(keyframe))
             {
-                SDL_Delay(Constants::TicksPerFrame - elapsedTicks);
+                printf("The keyframe at tick %u didn't restore the recorded state, seeking from the start from now on\n", fromTick);
+                _fReplayKeyframes = false;
+                fromTick = 0;
             }
         }
+        if (!_fReplayKeyframes)
+        {
+            RestoreWorldState(_pWorldState);
+        }
+        _replayTick = fromTick;
     }
 
-    // cleanup
-    Cleanup();
+    _cSeekTicks += tick - _replayTick;
+    while (_replayTick < tick)
+    {
+        StepReplay(replay);
+    }
+    _cSeeks++;
+    _seekCounter += SDL_GetPerformanceCounter() - startCounter;
+}
+
+// Where the timeline goes, along the bottom of the maze (the rows under the last wall are empty)
+SDL_Rect GameHarness::TimelineRect()
+{
+    SDL_Rect bounds = _pMaze->GetMapBounds();
+    return { bounds.x + TimelineMargin, bounds.y + bounds.h - TimelineHeight - TimelineMargin, bounds.w - (2 * TimelineMargin), TimelineHeight };
+}
+
+// The whole replay left to right with a tick for each keyframe, and how far in we are.  Drawn over the
+// frame Render() has just drawn, straight to the renderer
+void GameHarness::RenderTimeline(const Replay &replay)
+{
+    PROFILE_PHASE(_pPresentProfiler, Render);
+    SDL_Rect timeline = TimelineRect();
+    Uint32 cTicks = SDL_max(replay.Info().cTicks, 1);
+
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(_pSDLRenderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(_pSDLRenderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(_pSDLRenderer, 0, 0, 0, 192);
+    SDL_RenderFillRect(_pSDLRenderer, &timeline);
+    SDL_Rect played = { timeline.x, timeline.y, static_cast<int>((static_cast<Uint64>(_replayTick) * timeline.w) / cTicks), timeline.h };
+    SDL_SetRenderDrawColor(_pSDLRenderer, 0, 96, 192, 255);
+    SDL_RenderFillRect(_pSDLRenderer, &played);
+
+    // Only while they're far enough apart to tell from each other
+    if ((replay.KeyframeCount() > 0) && (static_cast<Uint32>(timeline.w) >= 2 * replay.KeyframeCount()))
+    {
+        SDL_SetRenderDrawColor(_pSDLRenderer, _fReplayKeyframes ? 255 : 128, _fReplayKeyframes ? 255 : 128, _fReplayKeyframes ? 255 : 128, 255);
+        for (Uint32 i = 0; i < replay.KeyframeCount(); i++)
+        {
+            int x = timeline.x + static_cast<int>((static_cast<Uint64>(replay.KeyframeTick(i)) * timeline.w) / cTicks);
+            SDL_RenderDrawLine(_pSDLRenderer, x, timeline.y + (timeline.h / 2), x, timeline.y + timeline.h - 1);
+        }
+    }
+
+    SDL_Rect playhead = { played.x + played.w - 1, timeline.y - 2, 3, timeline.h + 4 };
+    SDL_SetRenderDrawColor(_pSDLRenderer, 255, 255, 0, 255);
+    SDL_RenderFillRect(_pSDLRenderer, &playhead);
+
+#ifdef ENABLE_PROFILER
+    char szLine[64];
+    Uint32 seconds = _replayTick / Constants::FramesPerSecond;
+    SDL_snprintf(szLine, sizeof(szLine), "TICK %u OF %u  %u MIN %02u S%s", _replayTick, replay.Info().cTicks, seconds / 60, seconds % 60,
+        _fReplayPaused ? "  PAUSED" : "");
+    SDL_SetRenderDrawColor(_pSDLRenderer, 255, 255, 255, 255);
+    DrawOverlayText(_pSDLRenderer, timeline.x, timeline.y - OverlayLineHeight() - 2, szLine);
+#endif
+    SDL_SetRenderDrawBlendMode(_pSDLRenderer, blendMode);
 }
 
 void GameHarness::Cleanup()
 {
     SDL_assert(_fInitialized);
+    _recorder.Close();
+    _latency.Close();
+    _diskWriter.Close(_pCaptureStream, nullptr, 0);
+    _pCaptureStream = nullptr;
+    _diskWriter.Shutdown();
+    delete[] _pWorldState;
+    _pWorldState = nullptr;
+    _export.Close();
+#ifdef ENABLE_PROFILER
+    // Finish the trace while everything it points at is still around
+    _profiler.SetTraceRecorder(nullptr);
+    _trace.Close();
+#endif
     SafeDelete<TextureWrapper>(_pTitleTexture);
     SafeDelete<TextureWrapper>(_pTilesTexture);
     SafeDelete<TextureWrapper>(_pSpriteTexture);
     SafeDelete<Maze>(_pMaze);
-    SafeDelete<Player>(_pPlayer);
-    SafeDelete<Blinky>(_pBlinky);
-    SafeDelete<Pinky>(_pPinky);
-    SafeDelete<Inky>(_pInky);
-    SafeDelete<Clyde>(_pClyde);
+    SafeDelete<TiledMap>(_pMazeView);
+    SafeDelete<OccupancyGrid>(_pOccupancy);
+    for (Uint16 i = 0; i < _cPlayers; i++)
+    {
+        SafeDelete<Player>(_ppPlayers[i]);
+    }
+    for (Uint16 i = 0; i < _cGhosts; i++)
+    {
+        SafeDelete<Ghost>(_ppGhosts[i]);
+    }
+    _ppPlayers = nullptr;
+    _ppGhosts = nullptr;
+    _pGhostTypes = nullptr;
 
-    // The _pGhosts array just holds references to deleted
-    // objects, no need to free them
+    // Only once the sprites using it are gone
+    SafeDelete<ActorStore>(_pActorStore);
+    SafeDelete<AnimationRegistry>(_pAnimations);
 
     SDL_DestroyRenderer(_pSDLRenderer);
     _pSDLRenderer = nullptr;
@@ -157,133 +1016,325 @@ void GameHarness::Cleanup()
     SDL_DestroyWindow(_pSDLWindow);
     _pSDLWindow = nullptr;
 
+    SDL_FreeSurface(_pSDLSurface);
+    _pSDLSurface = nullptr;
+
     IMG_Quit();
     SDL_Quit();
     _fInitialized = false;
 }
 
-void GameHarness::InitializeSprites()
+// For the trace
+const char* GameHarness::GameStateName(GameState state)
+{
+    switch (state)
+    {
+    case GameState::LoadingResources:
+        return "LoadingResources";
+    case GameState::Title:
+        return "Title";
+    case GameState::WaitingToStartLevel:
+        return "WaitingToStartLevel";
+    case GameState::Running:
+        return "Running";
+    case GameState::PlayerDying:
+        return "PlayerDying";
+    case GameState::LevelComplete:
+        return "LevelComplete";
+    case GameState::GameOver:
+        return "GameOver";
+    case GameState::Exiting:
+        return "Exiting";
+    }
+    return "Unknown";
+}
+
+// Nothing on screen moves in these, so there's nothing to draw until something happens
+bool GameHarness::IsStaticState(GameState state)
 {
-    // In all cases we create a player
-    SDL_assert(_fInitialized);
-    InitGameSprite(&_pPlayer, _pSpriteTexture, _pMaze);
-
-    // The ghosts are controlled by these flags
-#ifdef GHOST_BLINKY
-    InitGameSprite(&_pBlinky, _pSpriteTexture, _pMaze);
-    _pGhosts[0] = _pBlinky;
-#endif
-
-#ifdef GHOST_PINKY
-    InitGameSprite(&_pPinky, _pSpriteTexture, _pMaze);
-    _pGhosts[1] = _pPinky;
-#endif
-
-    // Will also enable blinky as he is needed for Inky's
-    // targeting scheme
-#ifdef GHOST_INKY
-    InitGameSprite(&_pInky, _pSpriteTexture, _pMaze);
-    _pInky->SetBlinkyReference(_pBlinky);
-    _pGhosts[2] = _pInky;
-#endif
+    return (state == GameState::Title) || (state == GameState::WaitingToStartLevel) || (state == GameState::GameOver);
+}
 
-#ifdef GHOST_CLYDE
-    InitGameSprite(&_pClyde, _pSpriteTexture, _pMaze);
-    _pGhosts[3] = _pClyde;
-#endif
+// Time and CPU spent on the static screens, for the report at exit
+void GameHarness::TrackStaticScreens(bool fWasStatic, bool fIsStatic)
+{
+    if (!fWasStatic && fIsStatic)
+    {
+        _staticStartTicks = SDL_GetTicks();
+        _staticStartCpu = ProcessCpuSeconds();
+    }
+    else if (fWasStatic && !fIsStatic)
+    {
+        _staticTicks += SDL_GetTicks() - _staticStartTicks;
+        _staticCpuSeconds += ProcessCpuSeconds() - _staticStartCpu;
+    }
 }
 
-// Record key presses we care about
-// returns true if we need to exit
-bool GameHarness::ProcessInput(Direction *pInputDirection)
+// The input changed (or the window is closing), so the simulation can't sit waiting for it.  Main thread
+void GameHarness::WakeSimulation()
 {
-    *pInputDirection = Direction::None;
-    bool fResult = false;
+    if ((_pInputSignal != nullptr) && _fSimulationIdle.exchange(false))
+    {
+        SDL_SemPost(_pInputSignal);
+    }
+}
 
-    // All it takes to get the key states.  The array is valid within SDL while running
-    const Uint8 *pCurrentKeyState = SDL_GetKeyboardState(nullptr);
+void GameHarness::InitializeSprites()
+{
+    // In all cases we create a player.  The players are created first, so they have the first
+    // slots in the ActorStore and the ghosts follow in roster order (see HandleTileEvents())
+    SDL_assert(_fInitialized);
+    for (Uint16 i = 0; i < _cPlayers; i++)
+    {
+        InitGameSprite<Player>(&_ppPlayers[i], _pSpriteTexture, _pActorStore, _pMaze);
+        SDL_assert(_ppPlayers[i]->Id() == i);
+    }
 
-    if (pCurrentKeyState[SDL_SCANCODE_UP] || pCurrentKeyState[SDL_SCANCODE_W])
+    // The ghosts are controlled by the flags, see LoadResources()
+    Ghost *pBlinky = nullptr;
+    for (Uint16 i = 0; i < _cGhosts; i++)
     {
-        *pInputDirection = Direction::Up;
+        switch (_pGhostTypes[i])
+        {
+        case GhostType::Blinky:
+            InitGameSprite<Blinky>(&_ppGhosts[i], _pSpriteTexture, _pActorStore, _pMaze);
+            pBlinky = _ppGhosts[i];
+            break;
+        case GhostType::Pinky:
+            InitGameSprite<Pinky>(&_ppGhosts[i], _pSpriteTexture, _pActorStore, _pMaze);
+            break;
+        case GhostType::Inky:
+            // Uses the closest Blinky before it for its targeting scheme
+            InitGameSprite<Inky>(&_ppGhosts[i], _pSpriteTexture, _pActorStore, _pMaze);
+            static_cast<Inky*>(_ppGhosts[i])->SetBlinkyReference(pBlinky);
+            break;
+        case GhostType::Clyde:
+            InitGameSprite<Clyde>(&_ppGhosts[i], _pSpriteTexture, _pActorStore, _pMaze);
+            break;
+        }
+        SDL_assert(_ppGhosts[i]->Id() == _cPlayers + i);
     }
-    else if (pCurrentKeyState[SDL_SCANCODE_DOWN] || pCurrentKeyState[SDL_SCANCODE_S])
+}
+
+// The keys we care about, as they go down and up, for ProcessInput() to pick up on the simulation's
+// thread.  SDL's events can only be pumped on the main thread
+void GameHarness::QueueInput(const SDL_KeyboardEvent &keyEvent)
+{
+    InputEvent event;
+    switch (keyEvent.keysym.scancode)
     {
-        *pInputDirection = Direction::Down;
+    case SDL_SCANCODE_UP:
+    case SDL_SCANCODE_W:
+        event.key = InputKey::Up;
+        break;
+    case SDL_SCANCODE_DOWN:
+    case SDL_SCANCODE_S:
+        event.key = InputKey::Down;
+        break;
+    case SDL_SCANCODE_LEFT:
+    case SDL_SCANCODE_A:
+        event.key = InputKey::Left;
+        break;
+    case SDL_SCANCODE_RIGHT:
+    case SDL_SCANCODE_D:
+        event.key = InputKey::Right;
+        break;
+    case SDL_SCANCODE_ESCAPE:
+        event.key = InputKey::Escape;
+        break;
+    default:
+        return;
     }
-    else if (pCurrentKeyState[SDL_SCANCODE_LEFT] || pCurrentKeyState[SDL_SCANCODE_A])
+    // SDL only has the time the key went down in ms, so it's estimated on the finer clock from how long ago that was
+    event.timestamp = keyEvent.timestamp;
+    Uint32 msAgo = SDL_GetTicks() - keyEvent.timestamp;
+    event.counter = SDL_GetPerformanceCounter() - ((msAgo < 1000) ? (msAgo * SDL_GetPerformanceFrequency()) / 1000 : 0);
+    event.fDown = (keyEvent.state == SDL_PRESSED);
+    if (!_inputQueue.Push(event))
     {
-        *pInputDirection = Direction::Left;
+        printf("Input queue full, dropped a key event\n");
     }
-    else if (pCurrentKeyState[SDL_SCANCODE_RIGHT] || pCurrentKeyState[SDL_SCANCODE_D])
+
+    // Make sure the event is ordered before the check for the simulation waiting on it (the other half is
+    // in SimulationThread())
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    WakeSimulation();
+}
+
+// Catch up on the key events queued since the last step, every press counts even if it was already
+// released again.  Every step, whatever the state, so they don't pile up in the queue
+void GameHarness::DrainInput()
+{
+    PROFILE_PHASE(&_profiler, Input);
+    ALLOC_SCOPE(Input);
+    InputEvent event;
+    while (_inputQueue.Pop(&event))
     {
-        *pInputDirection = Direction::Right;
+        _input.Apply(event);
     }
-    else if (pCurrentKeyState[SDL_SCANCODE_ESCAPE])
+}
+
+// The input as of this step
+// returns true if we need to exit
+bool GameHarness::ProcessInput(Direction *pInputDirection)
+{
+    *pInputDirection = _input.Current();
+    bool fResult = _input.TakeEscape();
+    if (fResult)
     {
         printf("ESC hit - exiting main loop...\n");
-        fResult = true;
     }
     return fResult;
 }
 
-// Detect if the player has entered a pellet tile and remove it, incrementing our counter
+// Input for the players that aren't on the keyboard (all of them when headless).  Every so often
+// pick a random direction, the player keeps going that way until it can turn or hits a wall
+Direction GameHarness::AutopilotInput()
+{
+    // Numerical Recipes LCG, plenty for this and the same on every platform
+    _autopilotSeed = (_autopilotSeed * 1664525) + 1013904223;
+    Uint32 roll = _autopilotSeed >> 24;
+    return (roll < 32) ? static_cast<Direction>(roll & 3) : Direction::None;
+}
+
+// Everything that only needs to happen when an actor moves into a different tile.  The
+// ActorStore raises an event for each one that did, the players might be eating a pellet
+// and the ghosts need moving to their new tile in the occupancy grid
+void GameHarness::HandleTileEvents()
+{
+    for (Uint16 i = 0; i < _pActorStore->TileEventCount(); i++)
+    {
+        const TileEnteredEvent &event = _pActorStore->TileEvent(i);
+        if (event.id < _cPlayers)
+        {
+            if (event.row != ActorStore::OffMap)
+            {
+                _cPelletsEaten += HandlePelletCollision(event.id, event.row, event.col);
+            }
+        }
+        else
+        {
+            Uint16 ghostIndex = event.id - _cPlayers;
+            if (event.row != ActorStore::OffMap)
+            {
+                _pOccupancy->Move(ghostIndex, event.row, event.col);
+            }
+            else
+            {
+                // Warping, nobody can run into it there
+                _pOccupancy->Remove(ghostIndex);
+            }
+        }
+    }
+    _pActorStore->ClearTileEvents();
+}
+
+// A player has entered a new tile, if it has a pellet remove it and increment our counter
 // If the pellet is BIG, then trigger the ghost behavior
-Uint16 GameHarness::HandlePelletCollision()
+Uint16 GameHarness::HandlePelletCollision(ActorId id, Uint16 row, Uint16 col)
 {
     Uint16 ret = 0;
-    SDL_Point playerPoint = { static_cast<int>(_pPlayer->X()), static_cast<int>(_pPlayer->Y()) };
-    Uint16 row = 0;
-    Uint16 col = 0;
-    _pMaze->GetTileRowCol(playerPoint, row, col);
-
     if (_pMaze->IsTilePellet(row, col))
     {
         _pMaze->EatPellet(row, col);
         ret++;
+        if (_pFacts != nullptr)
+        {
+            _pFacts->AddEvent(FactEvent::PelletEaten, id, row, col);
+        }
     }
     else if (_pMaze->IsTilePowerPellet(row, col))
     {
         _pMaze->EatPellet(row, col);
         ret++;
 
-        for (size_t i = 0; i < SDL_arraysize(_pGhosts); i++)
+        // The ghosts have already moved this frame, so hold the reversal until the next
+        // one, otherwise they'd reverse from a cell they have already left
+        _fPowerPelletEaten = true;
+        _cPowerPelletsEaten++;
+        TRACE_INSTANT(&_trace, "Power pellet eaten", "game", -1, nullptr);
+        if (_pFacts != nullptr)
         {
-            if (_pGhosts[i] != nullptr)
-            {
-                _pGhosts[i]->OnPowerPelletEaten(_pMaze);
-            }
+            _pFacts->AddEvent(FactEvent::PowerPellet, id, row, col);
         }
     }
     return ret;
 }
 
-// Detect if the player has collided with a ghost (i.e. they are in the 
-// same cell during the same frame) and handle it based on state (whether
-// the player has an active power pellet)
+// Where a sprite went this tick.  Warping moves it from one side of the map to the other, and
+// we don't want that treated as a trip across the whole row, so anything that started the tick
+// off the map is treated as if it had only just appeared where it is now
+SweptPoint GameHarness::GetSweptPoint(Sprite *pSprite)
+{
+    Uint16 row = 0;
+    Uint16 col = 0;
+    if (_pActorStore->TileAt(pSprite->PrevX(), pSprite->PrevY(), row, col))
+    {
+        return { pSprite->PrevX(), pSprite->PrevY(), pSprite->X(), pSprite->Y() };
+    }
+    return { pSprite->X(), pSprite->Y(), pSprite->X(), pSprite->Y() };
+}
+
+// Detect if a player has collided with a ghost and handle it based on state (whether the
+// player has an active power pellet).  The check is swept over each actor's movement this
+// tick, so they can't pass through each other between frames no matter how fast they go
 GameHarness::GameState GameHarness::HandleGhostCollision()
 {
     GameState result = GameState::Running;
 
-    Uint16 ret = 0;
-    SDL_Point playerPoint = { static_cast<int>(_pPlayer->X()), static_cast<int>(_pPlayer->Y()) };
-    Uint16 row = 0;
-    Uint16 col = 0;
-    _pMaze->GetTileRowCol(playerPoint, row, col);
-    for (size_t i = 0; i < SDL_arraysize(_pGhosts); i++)
+    // The ghosts are already bucketed by the tile they're in (see HandleTileEvents()), so each
+    // player only has to look at the tiles near its own path rather than at every ghost.  It
+    // needs to look as far as any ghost moved this tick to find any that crossed its path
+    Coord maxGhostTravel = 0;
+    for (Uint16 i = 0; i < _cGhosts; i++)
+    {
+        SweptPoint ghostPath = GetSweptPoint(_ppGhosts[i]);
+        maxGhostTravel = SDL_max(maxGhostTravel, CoordAbs(ghostPath.x1 - ghostPath.x0));
+        maxGhostTravel = SDL_max(maxGhostTravel, CoordAbs(ghostPath.y1 - ghostPath.y0));
+    }
+
+    SDL_Rect mapRect = _pMaze->GetMapBounds();
+    int reach = CoordToInt(maxGhostTravel + Constants::CollisionDistance) + 1;
+    for (Uint16 p = 0; p < _cPlayers; p++)
     {
-        if (_pGhosts[i] != nullptr)
+        Uint16 row = 0;
+        Uint16 col = 0;
+        if (!_ppPlayers[p]->GetTile(row, col))
         {
-            SDL_Point ghostPoint = { static_cast<int>(_pGhosts[i]->X()), static_cast<int>(_pGhosts[i]->Y()) };
-            Uint16 ghostRow = 0;
-            Uint16 ghostCol = 0;
-            _pMaze->GetTileRowCol(ghostPoint, ghostRow, ghostCol);
+            continue;
+        }
+
+        // The box around the player's path, grown by the reach above and kept on the map
+        SweptPoint playerPath = GetSweptPoint(_ppPlayers[p]);
+        SDL_Point topLeft = {
+            SDL_max(SDL_min(CoordToInt(playerPath.x0), CoordToInt(playerPath.x1)) - reach, mapRect.x),
+            SDL_max(SDL_min(CoordToInt(playerPath.y0), CoordToInt(playerPath.y1)) - reach, mapRect.y) };
+        SDL_Point bottomRight = {
+            SDL_min(SDL_max(CoordToInt(playerPath.x0), CoordToInt(playerPath.x1)) + reach, mapRect.x + mapRect.w - 1),
+            SDL_min(SDL_max(CoordToInt(playerPath.y0), CoordToInt(playerPath.y1)) + reach, mapRect.y + mapRect.h - 1) };
+        Uint16 rowFirst = 0;
+        Uint16 colFirst = 0;
+        Uint16 rowLast = 0;
+        Uint16 colLast = 0;
+        _pMaze->GetTileRowCol(topLeft, rowFirst, colFirst);
+        _pMaze->GetTileRowCol(bottomRight, rowLast, colLast);
 
-            if (ghostRow == row && ghostCol == col)
+        for (Uint16 r = rowFirst; r <= rowLast; r++)
+        {
+            for (Uint16 c = colFirst; c <= colLast; c++)
             {
-                if (_pGhosts[i]->OnPlayerCollision())
+                for (Uint16 i = _pOccupancy->First(r, c); i != OccupancyGrid::InvalidItem; i = _pOccupancy->Next(i))
                 {
-                    result = GameState::PlayerDying;
+                    if (SweptOverlap(playerPath, GetSweptPoint(_ppGhosts[i]), Constants::CollisionDistance) &&
+                        _ppGhosts[i]->OnPlayerCollision())
+                    {
+                        result = GameState::PlayerDying;
+                        _cGhostCatches++;
+                        if (_pFacts != nullptr)
+                        {
+                            _pFacts->AddEvent(FactEvent::Caught, p, row, col);
+                        }
+                    }
                 }
             }
         }
@@ -291,86 +1342,301 @@ GameHarness::GameState GameHarness::HandleGhostCollision()
     return result;
 }
 
-// Tell our object to draw (render their current texture to the renderer)
-void GameHarness::Render()
+// Everything the render side needs from this step, into the snapshot being filled and then published.
+// Simulation side, the only time it's read from in the frame
+void GameHarness::CaptureSnapshot()
 {
-    SDL_RenderClear(_pSDLRenderer);
+    SDL_assert((_pMaze != nullptr) && (_pMazeView != nullptr));
+    RenderSnapshot &snapshot = _snapshots.Back();
+    snapshot.frame = _cSimFrames;
+    if (!IsStaticState(_state))
+    {
+        _sceneVersion++;
+    }
+    snapshot.sceneVersion = _sceneVersion;
+    snapshot.fStatic = IsStaticState(_state);
+    snapshot.fTitle = (_state == GameState::Title);
+    snapshot.tileBlueMod = _tileBlueMod;
+    snapshot.mapBounds = _pMaze->GetMapBounds();
+    snapshot.gameState = static_cast<Uint8>(_state);
+    snapshot.cPelletsEaten = _cPelletsEaten;
+    snapshot.cLevelsCompleted = _cLevelsCompleted;
+    snapshot.cGhostCatches = _cGhostCatches;
+    snapshot.turn = _turnMark;
+
+    // The tiles only change when a pellet is eaten or a level starts, so most frames skip the copy
+    if (snapshot.mapVersion != _pMaze->Version())
+    {
+        SDL_memcpy(snapshot.pMapIndicies, _pMaze->MapIndicies(), Constants::MapRows * Constants::MapCols * sizeof(Uint16));
+        snapshot.mapVersion = _pMaze->Version();
+    }
+
+    for (Uint16 i = 0; i < _cPlayers; i++)
+    {
+        SpriteDraw &draw = snapshot.pSprites[i];
+        draw.fVisible = _ppPlayers[i]->GetDraw(&draw.source, &draw.target);
+    }
+
+    for (Uint16 i = 0; i < _cGhosts; i++)
+    {
+        SpriteDraw &draw = snapshot.pSprites[_cPlayers + i];
+        draw.fVisible = _ppGhosts[i]->GetDraw(&draw.source, &draw.target);
 
-    if (_state == GameState::Title)
+        // The AI targets, only drawn outside stress mode
+        if (snapshot.pTargets != nullptr)
+        {
+            TargetDraw &target = snapshot.pTargets[i];
+            SDL_Point targetPoint = _pMaze->GetTileCoordinates(_ppGhosts[i]->TargetRow(), _ppGhosts[i]->TargetCol());
+            target.tile = { targetPoint.x - (Constants::TileWidth / 2), targetPoint.y - (Constants::TileHeight / 2),
+                Constants::TileWidth, Constants::TileHeight };
+            target.color = _ppGhosts[i]->TargetColor();
+            target.extra = TargetDraw::Extra::None;
+            if (_pGhostTypes[i] == GhostType::Inky)
+            {
+                Ghost *pBlinky = static_cast<Inky*>(_ppGhosts[i])->GetBlinkyReference();
+                target.extra = TargetDraw::Extra::LineToPoint;
+                target.point = { CoordToInt(pBlinky->X()), CoordToInt(pBlinky->Y()) };
+            }
+            else if (_pGhostTypes[i] == GhostType::Clyde)
+            {
+                target.extra = TargetDraw::Extra::CircleAroundPoint;
+                target.point = { CoordToInt(_ppGhosts[i]->X()), CoordToInt(_ppGhosts[i]->Y()) };
+            }
+        }
+    }
+
+    if (snapshot.pActors != nullptr)
     {
-        if (_pTitleTexture != nullptr)
+        for (Uint16 i = 0; i < _cPlayers + _cGhosts; i++)
         {
-            SDL_RenderCopy(
-                _pSDLRenderer,
-                _pTitleTexture->Ptr(),
-                nullptr,
-                nullptr);
+            Sprite *pSprite = (i < _cPlayers) ? static_cast<Sprite*>(_ppPlayers[i]) : _ppGhosts[i - _cPlayers];
+            ActorState &actor = snapshot.pActors[i];
+            actor.x = static_cast<Sint16>(CoordToInt(pSprite->X()));
+            actor.y = static_cast<Sint16>(CoordToInt(pSprite->Y()));
+            actor.direction = static_cast<Uint8>(pSprite->CurrentDirection());
+            actor.mode = _pActorStore->Mode(pSprite->Id());
+            actor.fVisible = snapshot.pSprites[i].fVisible ? 1 : 0;
+            actor.reserved = 0;
         }
     }
-    else
+    _snapshots.Publish();
+
+    // A new picture for a main thread waiting on a static screen (see RunThreaded()).  The publish has to be
+    // ordered before the check, the main thread checks for it again after saying it's waiting
+    if (_wakeEventType != static_cast<Uint32>(-1))
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (_fRenderIdle.exchange(false))
+        {
+            SDL_Event wake;
+            SDL_zero(wake);
+            wake.type = _wakeEventType;
+            SDL_PushEvent(&wake);
+        }
+    }
+}
+
+// Whether a snapshot needs drawing.  The static screens are drawn once, unless the window needs repainting,
+// other than that only a change of scene gets them drawn again.  Render side
+bool GameHarness::NeedsRender(const RenderSnapshot &snapshot)
+{
+    bool fNeeded = !_options.fIdleWait || (snapshot.sceneVersion != _presentedScene) || _fRepaint;
+#ifdef ENABLE_PROFILER
+    // The overlay keeps changing
+    fNeeded = fNeeded || _profiler.IsOverlayVisible();
+#endif
+    if (!fNeeded)
+    {
+        _cFramesNotRedrawn++;
+    }
+    return fNeeded;
+}
+
+// Draw a snapshot, presenting it is left to the caller.  Render side, it never looks at the game itself.
+// The frame is recorded as a command list first, which goes out sorted by layer and texture
+void GameHarness::Render(const RenderSnapshot &snapshot)
+{
+    PROFILE_PHASE(_pPresentProfiler, Render);
+    ALLOC_SCOPE(Render);
+    _presentedScene = snapshot.sceneVersion;
+    _fRepaint = false;
+
+    // Clip around the maze so nothing draws there (this will help with the wrap around for example)
+    if (!_fClipSet)
     {
-        if (_pMaze != nullptr)
+        if (SDL_RenderSetClipRect(_pSDLRenderer, &snapshot.mapBounds) != 0)
         {
-            _pMaze->Render(_pSDLRenderer);
+            printf("SDL_RenderSetClipRect() failed, error = %s\n", SDL_GetError());
         }
+        _fClipSet = true;
+    }
+    SDL_RenderClear(_pSDLRenderer);
+
+    _renderCommands.Clear();
+    if (snapshot.fTitle)
+    {
+        _renderCommands.Copy(RenderLayer::Background, RenderTexture::Title, nullptr, nullptr);
+    }
+    else
+    {
+        // The blue multiplier on the tiles is the level complete flash
+        SDL_Color tileColorMod = { 255, 255, snapshot.tileBlueMod, 255 };
+        _pMazeView->Render(&_renderCommands, RenderLayer::Background, RenderTexture::Tiles, snapshot.pMapIndicies, tileColorMod);
 
-        if (_pPlayer != nullptr)
+        // Players then ghosts
+        for (Uint16 i = 0; i < snapshot.cPlayers + snapshot.cGhosts; i++)
         {
-            _pPlayer->Render(_pSDLRenderer);
+            const SpriteDraw &draw = snapshot.pSprites[i];
+            if (draw.fVisible)
+            {
+                _renderCommands.Copy(RenderLayer::Sprites, RenderTexture::Sprites, &draw.source, &draw.target);
+            }
         }
 
-        // This is common, so loop through our array
-        for (size_t i = 0; i < SDL_arraysize(_pGhosts); i++)
+        if (snapshot.pTargets != nullptr)
         {
-            if (_pGhosts[i] != nullptr)
+            for (Uint16 i = 0; i < snapshot.cGhosts; i++)
             {
-                _pGhosts[i]->Render(_pSDLRenderer);
-                RenderAITargets(i);
+                RenderAITarget(snapshot.pTargets[i]);
             }
         }
     }
-    SDL_RenderPresent(_pSDLRenderer);
+    _renderCommands.Flush(_pSDLRenderer, _pRenderTextures);
+
+    if (_fCaptureRequested)
+    {
+        // Only copied here, the disk writer thread puts it in the file
+        _fFrameCaptured = _renderCommands.Save(_pCaptureStream);
+        if (_fFrameCaptured)
+        {
+            printf("Captured frame %u to %s\n", snapshot.frame, _options.szCaptureFile);
+        }
+        else
+        {
+            printf("Frame %u not captured, %s is still being written\n", snapshot.frame, _options.szCaptureFile);
+        }
+        _fCaptureRequested = false;
+    }
+
+    // Before the profiler overlay, which is only for whoever's watching
+    if (_export.IsOpen())
+    {
+        ExportFrame(snapshot);
+    }
+
+    if ((_heatmapLayer != HeatmapLayer::Count) && !snapshot.fTitle)
+    {
+        RenderHeatmap();
+    }
+
+#ifdef ENABLE_PROFILER
+    if (_profiler.IsOverlayVisible())
+    {
+        if (_pPresentProfiler == &_profiler)
+        {
+            _profiler.RenderOverlay(_pSDLRenderer, 0, "PHASE");
+        }
+        else
+        {
+            _profiler.RenderOverlay(_pSDLRenderer, 0, "SIM");
+            _presentProfiler.RenderOverlay(_pSDLRenderer, FrameProfiler::OverlayHeight(), "PRESENT");
+        }
+        int yPanel = ((_pPresentProfiler == &_profiler) ? 1 : 2) * FrameProfiler::OverlayHeight();
+        _frameTimes.RenderOverlay(_pSDLRenderer, yPanel, _targetFrameMs);
+        _latency.RenderOverlay(_pSDLRenderer, yPanel + FrameTimeHistogram::OverlayHeight());
+    }
+#endif
+}
+
+// F4 with --heatmap: each layer in turn, then none.  Render side
+void GameHarness::CycleHeatmap()
+{
+    _heatmapLayer = static_cast<HeatmapLayer>((static_cast<int>(_heatmapLayer) + 1) % (static_cast<int>(HeatmapLayer::Count) + 1));
+    _fRepaint = true;
+}
+
+// The heatmap layer over the maze and the sprites, with what its hottest color means along the top
+void GameHarness::RenderHeatmap()
+{
+    _pMazeView->RenderOverlay(_pSDLRenderer, _heatmap.Colors(_heatmapLayer));
+#ifdef ENABLE_PROFILER
+    char szLine[64];
+    SDL_Rect bounds = _pMazeView->GetMapBounds();
+    _heatmap.Describe(_heatmapLayer, szLine, sizeof(szLine));
+    SDL_SetRenderDrawColor(_pSDLRenderer, 255, 255, 255, 255);
+    DrawOverlayText(_pSDLRenderer, bounds.x + 2, bounds.y + 2, szLine);
+#endif
+}
+
+// Show what Render() drew.  If it's the first frame showing player 1's latest turn, that's the end of the
+// turn's input to photon time.  Render side
+void GameHarness::Present(const RenderSnapshot &snapshot)
+{
+    {
+        PROFILE_PHASE(_pPresentProfiler, Present);
+        SDL_RenderPresent(_pSDLRenderer);
+    }
+    Uint64 presentCounter = SDL_GetPerformanceCounter();
+    _frameTimes.AddPresent(presentCounter);
+    if (snapshot.turn.id != _presentedTurn)
+    {
+        _latency.AddSample(snapshot.turn, presentCounter);
+        _presentedTurn = snapshot.turn.id;
+    }
+}
+
+// The frame just drawn, and the state it was drawn from, out to the shared memory.  Render side.  The
+// pixels are read back straight into the slot, readers get them without another copy
+void GameHarness::ExportFrame(const RenderSnapshot &snapshot)
+{
+    SharedExportSlot *pSlot = _export.BeginWrite();
+    pSlot->frame = snapshot.frame;
+    pSlot->gameState = snapshot.gameState;
+    pSlot->cPelletsEaten = snapshot.cPelletsEaten;
+    pSlot->cLevelsCompleted = snapshot.cLevelsCompleted;
+    pSlot->cGhostCatches = snapshot.cGhostCatches;
+    pSlot->mapVersion = snapshot.mapVersion;
+    pSlot->cPlayers = snapshot.cPlayers;
+    pSlot->cGhosts = snapshot.cGhosts;
+    SDL_memcpy(_export.Actors(pSlot), snapshot.pActors, (snapshot.cPlayers + snapshot.cGhosts) * sizeof(ActorState));
+    SDL_memcpy(_export.MapIndicies(pSlot), snapshot.pMapIndicies, Constants::MapRows * Constants::MapCols * sizeof(Uint16));
+    if (SDL_RenderReadPixels(_pSDLRenderer, nullptr, SDL_PIXELFORMAT_ARGB8888, _export.Pixels(pSlot), _export.Pitch()) == 0)
+    {
+        _export.EndWrite();
+        return;
+    }
+
+    // The slot's pixels are stale, so it isn't published.  It won't start working on the next frame either,
+    // don't keep trying
+    printf("SDL_RenderReadPixels() failed, error = %s, no longer exporting\n", SDL_GetError());
+    _export.AbandonWrite();
+    _export.Close();
 }
 
 // Small helper to factor out AI rendering for this module.  This code should not draw in a normal
 // game but might be very helpful debugging
-void GameHarness::RenderAITargets(size_t ghostIndex)
-{
-    Uint16 row = _pGhosts[ghostIndex]->TargetRow();
-    Uint16 col = _pGhosts[ghostIndex]->TargetCol();
-
-    SDL_Point targetPoint = _pMaze->GetTileCoordinates(row, col);
-    targetPoint.x -= Constants::TileWidth / 2;
-    targetPoint.y -= Constants::TileHeight / 2;
-    SDL_Rect targetRect = { targetPoint.x, targetPoint.y, Constants::TileWidth, Constants::TileHeight };
-    SDL_SetRenderDrawColor(
-        _pSDLRenderer, 
-        _pGhosts[ghostIndex]->TargetColor().r, 
-        _pGhosts[ghostIndex]->TargetColor().g, 
-        _pGhosts[ghostIndex]->TargetColor().b, 
-        255);
-    SDL_RenderFillRect(_pSDLRenderer, &targetRect);
+void GameHarness::RenderAITarget(const TargetDraw &target)
+{
+    SDL_Color color = { target.color.r, target.color.g, target.color.b, 255 };
+    _renderCommands.FillRect(RenderLayer::Debug, target.tile, color);
 
     // Draw some specific UI to illustrate the AI targets and range
-    if (ghostIndex == 2) // Inky
+    if (target.extra == TargetDraw::Extra::LineToPoint)
     {
-        //                                     Target                     Blinky
-        SDL_RenderDrawLine(_pSDLRenderer, targetPoint.x, targetPoint.y, _pGhosts[0]->X(), _pGhosts[0]->Y());
+        //                                                    Target                     Blinky
+        _renderCommands.Line(RenderLayer::Debug, target.tile.x, target.tile.y, target.point.x, target.point.y, color);
     }
-    else if (ghostIndex == 3) // Clyde
+    else if (target.extra == TargetDraw::Extra::CircleAroundPoint)
     {
-        SDL_Point clydePoint = { static_cast<int>(_pGhosts[ghostIndex]->X()), static_cast<int>(_pGhosts[ghostIndex]->Y()) };
         SDL_Point clydeCircle[SDL_arraysize(Constants::CosineTable)] = { 0,0 };
         // Draw 'circle' using pre-calculated cos/sin table
         for (size_t j = 0; j < SDL_arraysize(Constants::CosineTable); j++)
         {
-            clydeCircle[j] = { static_cast<int>(clydePoint.x + (Constants::CosineTable[j] * 8 * Constants::TileWidth)),
-                static_cast<int>(clydePoint.y + (Constants::SineTable[j] * 8 * Constants::TileHeight)) };
+            clydeCircle[j] = { static_cast<int>(target.point.x + (Constants::CosineTable[j] * 8 * Constants::TileWidth)),
+                static_cast<int>(target.point.y + (Constants::SineTable[j] * 8 * Constants::TileHeight)) };
         }
-        SDL_RenderDrawPoints(_pSDLRenderer, clydeCircle, SDL_arraysize(clydeCircle));
+        _renderCommands.Points(RenderLayer::Debug, clydeCircle, SDL_arraysize(clydeCircle), color);
     }
-    SDL_SetRenderDrawColor(_pSDLRenderer, Constants::RenderDrawColor.r, Constants::RenderDrawColor.g,
-        Constants::RenderDrawColor.b, Constants::RenderDrawColor.a);
 }
 
 GameHarness::GameState GameHarness::OnLoading()
@@ -407,11 +1673,9 @@ GameHarness::GameState GameHarness::OnWaitingToStartLevel()
     return GameState::WaitingToStartLevel;
 }
 
-// Normal game play, check for collisions, update based on input, eventually the ghosts
-// and their updates will need to be in here as well.  
+// Normal game play, gather the input then update the simulation with it
 GameHarness::GameState GameHarness::OnRunning()
 {
-    static Uint16 pelletsEaten = 0;
     GameState stateResult = GameState::Running;
 
     // INPUT
@@ -419,24 +1683,31 @@ GameHarness::GameState GameHarness::OnRunning()
     bool fQuit = ProcessInput(&inputDirection);
     if (!fQuit)
     {
-        // UPDATE
-        _pPlayer->Update(_pMaze, inputDirection); 
-        pelletsEaten += HandlePelletCollision();
-
-        // This is common, so loop through our array
-        for (size_t i = 0; i < SDL_arraysize(_pGhosts); i++)
+        if (_recorder.IsOpen() && _recorder.KeyframeDue())
         {
-            if (_pGhosts[i] != nullptr)
-            {
-                _pGhosts[i]->Update(_pPlayer, _pMaze);
-            }
+            // The world as this tick finds it, so playback can start here (see Replay)
+            SaveWorldState(_pWorldState);
+            _recorder.AddKeyframe(_pWorldState, StateChecksum());
         }
-        //stateResult = HandleGhostCollision();
 
-        if (pelletsEaten == Constants::TotalPellets)
+        Direction facing = _ppPlayers[0]->Facing();
+        Direction desiredTurn = _input.DesiredTurn();
+        Uint64 desiredCounter = _input.DesiredCounter();
+        bool fBuffered = _input.DesiredMissed();
+        stateResult = UpdateSimulation(inputDirection);
+        if (_input.OnTick(_ppPlayers[0]->Facing(), SDL_GetTicks()) && (_ppPlayers[0]->Facing() != facing))
+        {
+            // A turn the keys asked for, timed through to the frame that shows it (see Present())
+            _turnMark.id++;
+            _turnMark.tick = _cSimFrames;
+            _turnMark.direction = static_cast<Uint8>(desiredTurn);
+            _turnMark.fBuffered = fBuffered;
+            _turnMark.inputCounter = desiredCounter;
+            _turnMark.tickCounter = SDL_GetPerformanceCounter();
+        }
+        if (_recorder.IsOpen())
         {
-            pelletsEaten = 0;
-            return GameState::LevelComplete;
+            _recorder.AddTick(inputDirection, StateChecksum());
         }
     }
     else
@@ -447,6 +1718,178 @@ GameHarness::GameState GameHarness::OnRunning()
     return stateResult;
 }
 
+// One tick of the game itself: check for collisions, move the player(s) based on input
+// and update the ghosts.  inputDirection is for the first player, the rest are on autopilot
+GameHarness::GameState GameHarness::UpdateSimulation(Direction inputDirection)
+{
+    GameState stateResult = GameState::Running;
+
+    // UPDATE
+    if (_fPowerPelletEaten)
+    {
+        // Eaten last frame, the ghosts need to reverse before they move again
+        PROFILE_PHASE(&_profiler, Ghosts);
+        ALLOC_SCOPE(Ghosts);
+        for (Uint16 i = 0; i < _cGhosts; i++)
+        {
+            _ppGhosts[i]->OnPowerPelletEaten(_pMaze);
+        }
+        _fPowerPelletEaten = false;
+    }
+
+    // Move and animate every actor in one pass, then let each react to its new position
+    {
+        PROFILE_PHASE(&_profiler, Players);
+        ALLOC_SCOPE(Players);
+        _pActorStore->Update();
+        for (Uint16 i = 0; i < _cPlayers; i++)
+        {
+            Direction direction = ((i == 0) && _fKeyboardPlayer) ? inputDirection : AutopilotInput();
+            _ppPlayers[i]->Update(_pMaze, direction);
+        }
+    }
+
+    // This is common, so loop through our array.  With more than one player
+    // the ghosts are dealt out between them
+    {
+        PROFILE_PHASE(&_profiler, Ghosts);
+        ALLOC_SCOPE(Ghosts);
+        for (Uint16 i = 0; i < _cGhosts; i++)
+        {
+            _ppGhosts[i]->Update(_ppPlayers[i % _cPlayers], _pMaze);
+        }
+    }
+
+    {
+        PROFILE_PHASE(&_profiler, Collision);
+        ALLOC_SCOPE(Collision);
+
+        // Pellets and the occupancy grid only change when someone moves to a new tile
+        HandleTileEvents();
+
+        // Stress mode exercises the collision checks too, but only counts the catches,
+        // with a crowd of ghosts the level would otherwise restart every few frames
+        if (_options.fStress)
+        {
+            HandleGhostCollision();
+        }
+        //stateResult = HandleGhostCollision();
+    }
+
+    if (_pFacts != nullptr)
+    {
+        RecordFacts();
+    }
+
+    if (_cPelletsEaten == Constants::TotalPellets)
+    {
+        _cPelletsEaten = 0;
+        _cLevelsCompleted++;
+        return GameState::LevelComplete;
+    }
+    return stateResult;
+}
+
+// Everything that decides where the simulation goes next, boiled down to compare two runs
+Uint32 GameHarness::StateChecksum()
+{
+    return (_pActorStore->Checksum() ^ _cPelletsEaten) * 16777619u;
+}
+
+// Where everyone is at the end of the tick, for the fact file being built.  The ghosts' modes say
+// whether they're scattering too, which the ActorStore doesn't know
+void GameHarness::RecordFacts()
+{
+    if (_cPelletsEaten == Constants::TotalPellets)
+    {
+        _pFacts->AddEvent(FactEvent::LevelComplete, 0, _pActorStore->TileRow(0), _pActorStore->TileCol(0));
+    }
+    for (Uint16 i = 0; i < _cPlayers; i++)
+    {
+        ActorId id = _ppPlayers[i]->Id();
+        _pFacts->AddActor(_pActorStore->TileRow(id), _pActorStore->TileCol(id), _pActorStore->Mode(id));
+    }
+    for (Uint16 i = 0; i < _cGhosts; i++)
+    {
+        ActorId id = _ppGhosts[i]->Id();
+        Uint8 mode = _pActorStore->Mode(id) | (_ppGhosts[i]->IsScattering() ? FactStore::ModeScattering : 0);
+        _pFacts->AddActor(_pActorStore->TileRow(id), _pActorStore->TileCol(id), mode);
+    }
+    _pFacts->EndTick(Constants::TotalPellets - _cPelletsEaten, static_cast<Uint16>(_cLevelsCompleted));
+}
+
+// Everything the simulation carries from one tick to the next, for replay keyframes: the counters, which
+// pellets are gone, the ActorStore and each ghost's own state.  The occupancy grid is left out, it only
+// ever holds the ghosts' tiles, which the ActorStore has
+size_t GameHarness::WorldStateBytes()
+{
+    return sizeof(WorldScalars) + Maze::PelletStateBytes() + ActorStore::StateBytes(_cPlayers + _cGhosts) +
+        (_cGhosts * Ghost::StateBytes());
+}
+
+void GameHarness::SaveWorldState(Uint8 *pState)
+{
+    WorldScalars scalars;
+    SDL_zero(scalars);
+    scalars.cGhostCatches = _cGhostCatches;
+    scalars.cLevelsCompleted = _cLevelsCompleted;
+    scalars.cPowerPelletsEaten = _cPowerPelletsEaten;
+    scalars.autopilotSeed = _autopilotSeed;
+    scalars.cPelletsEaten = _cPelletsEaten;
+    scalars.fPowerPelletEaten = _fPowerPelletEaten;
+    SDL_memcpy(pState, &scalars, sizeof(scalars));
+    pState += sizeof(scalars);
+
+    _pMaze->SavePellets(pState);
+    pState += Maze::PelletStateBytes();
+    _pActorStore->SaveState(pState);
+    pState += ActorStore::StateBytes(_cPlayers + _cGhosts);
+    for (Uint16 i = 0; i < _cGhosts; i++)
+    {
+        _ppGhosts[i]->SaveState(pState);
+        pState += Ghost::StateBytes();
+    }
+}
+
+// The level starts over, then everything is put back the way it was saved
+void GameHarness::RestoreWorldState(const Uint8 *pState)
+{
+    InitLevel();
+
+    WorldScalars scalars;
+    SDL_memcpy(&scalars, pState, sizeof(scalars));
+    pState += sizeof(scalars);
+    _cGhostCatches = scalars.cGhostCatches;
+    _cLevelsCompleted = scalars.cLevelsCompleted;
+    _cPowerPelletsEaten = scalars.cPowerPelletsEaten;
+    _autopilotSeed = scalars.autopilotSeed;
+    _cPelletsEaten = scalars.cPelletsEaten;
+    _fPowerPelletEaten = scalars.fPowerPelletEaten;
+
+    _pMaze->RestorePellets(pState);
+    pState += Maze::PelletStateBytes();
+    _pActorStore->RestoreState(pState);
+    pState += ActorStore::StateBytes(_cPlayers + _cGhosts);
+    for (Uint16 i = 0; i < _cGhosts; i++)
+    {
+        _ppGhosts[i]->RestoreState(pState);
+        pState += Ghost::StateBytes();
+    }
+
+    // Each ghost in the tile it's in.  One with a tile event still to come would be in the tile it left, but
+    // the event moves it before anything looks, so it comes to the same
+    _pOccupancy->Clear();
+    for (Uint16 i = 0; i < _cGhosts; i++)
+    {
+        Uint16 row = 0;
+        Uint16 col = 0;
+        if (_ppGhosts[i]->GetTile(row, col))
+        {
+            _pOccupancy->Move(i, row, col);
+        }
+    }
+}
+
 // All 244 pellets have been eaten, so we briefly flash the screen before moving to the
 // next level.  We only have the one level, so it just restarts
 GameHarness::GameState GameHarness::OnLevelComplete()
@@ -468,9 +1911,9 @@ GameHarness::GameState GameHarness::OnLevelComplete()
         flip = !flip;
     }
 
-    // This will add a blue multiplier to the texture, making the shade chage.
+    // This will add a blue multiplier to the texture (see Render()), making the shade chage.
     // We flip this back and forth roughly every second until the overall timer is done.
-    SDL_SetTextureColorMod(_pTilesTexture->Ptr(), 255, 255, flip ? 100 : 255);
+    _tileBlueMod = flip ? 100 : 255;
     
     if (timer.IsDone())
     {
@@ -482,29 +1925,29 @@ GameHarness::GameState GameHarness::OnLevelComplete()
 
 void GameHarness::InitLevel()
 {
+    ALLOC_SCOPE(Level);
     // This should be know, but it should also match what we just queried
     SDL_assert(_pTilesTexture->Width() == Constants::TileTextureWidth);
     SDL_assert(_pTilesTexture->Height() == Constants::TileTextureHeight);
-    SDL_Rect textureRect{ 0, 0, Constants::TileTextureWidth, Constants::TileTextureHeight };
 
-    SDL_SetTextureColorMod(_pTilesTexture->Ptr(), 255, 255, 255);
+    _tileBlueMod = 255;
+    _fPowerPelletEaten = false;
+    _cPelletsEaten = 0;
+    _sceneVersion++;
+    _input.Reset();
 
-    // Initialize our tiled map object
-    SafeDelete(_pMaze);
-    _pMaze = new Maze(Constants::MapRows, Constants::MapCols, Constants::ScreenWidth, Constants::ScreenHeight);
-
-    _pMaze->Initialize(textureRect, { 0, 0,  Constants::TileWidth,  Constants::TileHeight }, _pTilesTexture->Ptr(),
-        Constants::MapIndicies, Constants::MapRows *  Constants::MapCols);
-
-    // Clip around the maze so nothing draws there (this will help with the wrap around for example)
-    SDL_Rect mapBounds = _pMaze->GetMapBounds();
-    if (SDL_RenderSetClipRect(_pSDLRenderer, &mapBounds) != 0)
-    {
-        printf("SDL_RenderSetClipRect() failed, error = %s\n", SDL_GetError());
-    }
-    else
+    // Initialize our tiled map object, it's created once and each level gets a fresh copy of the
+    // map (pellets and all) from the level part of the arena
+    if (_pMaze == nullptr)
     {
-        // Initialize our sprites
-        InitializeSprites();
+        _pMaze = new Maze(Constants::MapRows, Constants::MapCols, Constants::ScreenWidth, Constants::ScreenHeight);
     }
+
+    _arena.Rewind(_levelMark);
+    _pMaze->Initialize(MazeTextureRect(), MazeTileRect(), _pTilesTexture->Ptr(),
+        Constants::MapIndicies, Constants::MapRows *  Constants::MapCols, &_arena);
+    _pActorStore->SetTileLayout(_pMaze->GetMapBounds(), Constants::TileWidth);
+
+    // Initialize our sprites
+    InitializeSprites();
 }
@@ -0,0 +1,226 @@
+#include "include/gameoptions.h"
+#include "include/constants.h"
+#include "include/profiler.h"
+#include <stdio.h>
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    static void PrintUsage(const char *szExe)
+    {
+        printf("usage: %s [options]\n", szExe);
+        printf("  --ghosts <n>          stress mode with n ghosts (max %u)\n", Constants::MaxGhosts);
+        printf("  --players <n>         stress mode with n players (max %u)\n", Constants::MaxPlayers);
+        printf("  --stress-bench [n]    headless ticks/second vs actor count, n ticks per step\n");
+        printf("  --record <file>       record the session for replaying (e.g. by the soak benchmark)\n");
+        printf("  --single-thread       simulate on the main thread, in lockstep with presenting\n");
+        printf("  --capture-frame <file> save the frame's draw calls on F12 (or the last frame at exit) for the microbenchmark\n");
+        printf("  --video <file>        render a simulated game offscreen to name.y4m or name%%05d.png, no window needed\n");
+        printf("  --replay <file>       play a recording (see --record) with pause, step and seek, or with --video\n");
+        printf("                        player 1 of the video follows it\n");
+        printf("  --ticks <n>           length of the video (default the whole replay, or a minute)\n");
+        printf("  --export <name>       publish each frame and the game state to shared memory for other processes\n");
+        printf("  --no-idle-wait        redraw the title and level start screens every frame (to compare the CPU use)\n");
+        printf("  --latency-csv <file>  write the time from each key press to the frame showing the turn it made\n");
+        printf("  --heatmap <file>      overlay heatmaps of the games in a fact file (see factquery), F4 cycles them\n");
+        printf("  --pacing <mode>       delay (the default, whole ms), precise (sleep then spin to 60Hz) or vsync\n");
+#ifdef ENABLE_PROFILER
+        printf("  --trace <file>        write a Chrome trace (chrome://tracing, ui.perfetto.dev) of the session\n");
+#endif
+    }
+
+    // Reads the value following argv[*pIndex] as a number in [min, max]
+    static bool ParseCount(int argc, char* argv[], int *pIndex, Uint32 min, Uint32 max, Uint32 *pValue)
+    {
+        if (*pIndex + 1 >= argc)
+        {
+            printf("%s needs a value\n", argv[*pIndex]);
+            return false;
+        }
+
+        (*pIndex)++;
+        int value = SDL_atoi(argv[*pIndex]);
+        if ((value < static_cast<int>(min)) || (value > static_cast<int>(max)))
+        {
+            printf("%s is out of range for %s (%u - %u)\n", argv[*pIndex], argv[*pIndex - 1], min, max);
+            return false;
+        }
+        *pValue = static_cast<Uint32>(value);
+        return true;
+    }
+
+    bool ParseGameOptions(int argc, char* argv[], GameOptions *pOptions)
+    {
+        bool fResult = true;
+        Uint32 value = 0;
+
+        for (int i = 1; (i < argc) && fResult; i++)
+        {
+            if (SDL_strcmp(argv[i], "--ghosts") == 0)
+            {
+                fResult = ParseCount(argc, argv, &i, 0, Constants::MaxGhosts, &value);
+                pOptions->cGhosts = static_cast<Uint16>(value);
+                pOptions->fStress = true;
+            }
+            else if (SDL_strcmp(argv[i], "--players") == 0)
+            {
+                fResult = ParseCount(argc, argv, &i, 1, Constants::MaxPlayers, &value);
+                pOptions->cPlayers = static_cast<Uint16>(value);
+                pOptions->fStress = true;
+            }
+            else if (SDL_strcmp(argv[i], "--stress-bench") == 0)
+            {
+                pOptions->fStressBenchmark = true;
+                // The tick count is optional
+                if ((i + 1 < argc) && (argv[i + 1][0] != '-'))
+                {
+                    fResult = ParseCount(argc, argv, &i, 1, 10000000, &pOptions->cBenchmarkTicks);
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--record") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a file name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szRecordFile = argv[++i];
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--single-thread") == 0)
+            {
+                pOptions->fSingleThread = true;
+            }
+            else if (SDL_strcmp(argv[i], "--no-idle-wait") == 0)
+            {
+                pOptions->fIdleWait = false;
+            }
+            else if (SDL_strcmp(argv[i], "--video") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a file name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szVideoFile = argv[++i];
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--replay") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a file name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szReplayFile = argv[++i];
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--ticks") == 0)
+            {
+                fResult = ParseCount(argc, argv, &i, 1, 0x7FFFFFFF, &pOptions->cVideoTicks);
+            }
+            else if (SDL_strcmp(argv[i], "--export") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szExportName = argv[++i];
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--latency-csv") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a file name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szLatencyFile = argv[++i];
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--heatmap") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a file name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szHeatmapFile = argv[++i];
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--pacing") == 0)
+            {
+                const char *szMode = (i + 1 < argc) ? argv[++i] : "";
+                if (SDL_strcmp(szMode, "delay") == 0)
+                {
+                    pOptions->pacing = FramePacing::Delay;
+                }
+                else if (SDL_strcmp(szMode, "precise") == 0)
+                {
+                    pOptions->pacing = FramePacing::Precise;
+                }
+                else if (SDL_strcmp(szMode, "vsync") == 0)
+                {
+                    pOptions->pacing = FramePacing::Vsync;
+                }
+                else
+                {
+                    printf("--pacing needs delay, precise or vsync\n");
+                    fResult = false;
+                }
+            }
+            else if (SDL_strcmp(argv[i], "--capture-frame") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a file name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szCaptureFile = argv[++i];
+                }
+            }
+#ifdef ENABLE_PROFILER
+            else if (SDL_strcmp(argv[i], "--trace") == 0)
+            {
+                if (i + 1 >= argc)
+                {
+                    printf("%s needs a file name\n", argv[i]);
+                    fResult = false;
+                }
+                else
+                {
+                    pOptions->szTraceFile = argv[++i];
+                }
+            }
+#endif
+            else
+            {
+                printf("Unknown option %s\n", argv[i]);
+                fResult = false;
+            }
+        }
+
+        if (!fResult)
+        {
+            PrintUsage(argv[0]);
+        }
+        return fResult;
+    }
+}
+}
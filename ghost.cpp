@@ -3,28 +3,52 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-Ghost::Ghost(TextureWrapper *pTextureWrapper, Uint16 /*cxFrame*/, Uint16 /*cyFrame*/, Uint16 /*cFramesTotal*/, Uint16 /*cAnimationsTotal*/) :
-    Sprite(pTextureWrapper, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight, Constants::GhostTotalFrameCount, Constants::GhostTotalAnimationCount),
-    _currentRow(0),
-    _currentCol(0),
+namespace
+{
+    // Ghost::SaveState(), zeroed before it's filled so the padding compares equal too
+    struct GhostState
+    {
+        Uint32 penStartTicks;
+        Uint32 penTargetTicks;
+        Uint32 scatterStartTicks;
+        Uint32 scatterTargetTicks;
+        Uint32 penTimerMax;
+        Uint16 scatterRow;
+        Uint16 scatterCol;
+        Uint16 targetRow;
+        Uint16 targetCol;
+        Uint16 decisionRows[3];         // Next, current and previous
+        Uint16 decisionCols[3];
+        Uint8 decisionDirections[3];
+        SDL_Color targetColor;
+        bool fPenTimerStarted;
+        bool fScatterTimerStarted;
+        bool fScatter;
+        bool fHasNextDecision;
+    };
+}
+
+Ghost::Ghost(TextureWrapper *pTextureWrapper, ActorStore *pActorStore, Uint16 /*cxFrame*/, Uint16 /*cyFrame*/, Uint16 /*cFramesTotal*/, Uint16 /*cAnimationsTotal*/) :
+    Sprite(pTextureWrapper, pActorStore, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight, Constants::GhostTotalFrameCount, Constants::GhostTotalAnimationCount),
+    _penTimer(pActorStore->Clock()),
+    _scatterTimer(pActorStore->Clock()),
     _scatterRow(0),
     _scatterCol(0),
     _targetRow(0),
     _targetCol(0),
     _targetColor(Constants::SDLColorGrey),
     _penTimerMax(0),
-    _mode(Mode::Chase),
     _fScatter(false),
-    _pNextDecision(nullptr),
-    _pCurrentDecision(nullptr),
-    _pPrevDecision(nullptr)
+    _fHasNextDecision(false)
 {
+    SetMode(Mode::Chase);
 }
 
-// Call the subroutine based on our internal state
+// Call the subroutine based on our internal state, movement itself has already been
+// applied by the ActorStore this frame
 void Ghost::Update(Player* pPlayer, Maze* pMaze)
 {
-    switch (_mode)
+    switch (GetMode())
     {
     case Mode::ExitingPen:
         OnExitingPen(pPlayer, pMaze);
@@ -41,9 +65,23 @@ void Ghost::Update(Player* pPlayer, Maze* pMaze)
     }
 }
 
+// Mode changes (the warps included) show up in the trace
+void Ghost::SetMode(Mode mode)
+{
+#ifdef ENABLE_PROFILER
+    static const char *ModeNames[] = { "Ghost chase", "Ghost warping out", "Ghost warping in", "Ghost exiting pen" };
+    if (mode != GetMode())
+    {
+        TRACE_INSTANT(Trace(), ModeNames[static_cast<int>(mode)], "ghost", Id(), nullptr);
+    }
+#endif
+    SetActorMode(static_cast<Uint8>(mode));
+}
+
 void Ghost::OnPowerPelletEaten(Maze* pMaze)
 {
     // Called by the GameHarness when the player eats a pellet
+    TRACE_INSTANT(Trace(), "Ghost scatter", "ghost", Id(), nullptr);
     _fScatter = true;
     
     if (!_scatterTimer.IsStarted())
@@ -55,7 +93,7 @@ void Ghost::OnPowerPelletEaten(Maze* pMaze)
         _scatterTimer.Reset();
         _scatterTimer.Start(10000);
     }
-    if (_mode == Mode::Chase)
+    if (GetMode() == Mode::Chase)
     {
         // Don't do this for other cases like warping
         // Let the velocity stay managed by those handlers
@@ -69,22 +107,86 @@ bool Ghost::OnPlayerCollision()
     return !_fScatter;
 }
 
-void Ghost::InitializeCommon()
+size_t Ghost::StateBytes()
+{
+    return sizeof(GhostState);
+}
+
+void Ghost::SaveState(Uint8 *pState)
+{
+    GhostState state;
+    SDL_zero(state);
+    state.penStartTicks = _penTimer.StartTicks();
+    state.penTargetTicks = _penTimer.TargetTicks();
+    state.fPenTimerStarted = _penTimer.IsStarted();
+    state.scatterStartTicks = _scatterTimer.StartTicks();
+    state.scatterTargetTicks = _scatterTimer.TargetTicks();
+    state.fScatterTimerStarted = _scatterTimer.IsStarted();
+    state.penTimerMax = _penTimerMax;
+    state.scatterRow = _scatterRow;
+    state.scatterCol = _scatterCol;
+    state.targetRow = _targetRow;
+    state.targetCol = _targetCol;
+    state.targetColor = _targetColor;
+    state.fScatter = _fScatter;
+    state.fHasNextDecision = _fHasNextDecision;
+    Decision *pDecisions[] = { &_nextDecision, &_currentDecision, &_prevDecision };
+    for (int i = 0; i < 3; i++)
+    {
+        state.decisionRows[i] = pDecisions[i]->Row();
+        state.decisionCols[i] = pDecisions[i]->Col();
+        state.decisionDirections[i] = static_cast<Uint8>(pDecisions[i]->GetDirection());
+    }
+    SDL_memcpy(pState, &state, sizeof(state));
+}
+
+void Ghost::RestoreState(const Uint8 *pState)
 {
-    LoadFrames(8, 256, 64, 2);
-    LoadFrames(10, 256, 96, 2);
-    LoadFrames(12, 256, 128, 2);
-    LoadFrames(14, 256, 150, 2);
-    LoadAnimationSequence(Constants::AnimationIndexLeft, AnimationType::Loop, Constants::GhostAnimation_LEFT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexRight, AnimationType::Loop, Constants::GhostAnimation_RIGHT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexUp, AnimationType::Loop, Constants::GhostAnimation_UP, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexDown, AnimationType::Loop, Constants::GhostAnimation_DOWN, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexFright, AnimationType::Loop, Constants::GhostAnimation_FRIGHT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexScared, AnimationType::Loop, Constants::GhostAnimation_SCARED, Constants::GhostScaredAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexDeathLeft, AnimationType::Loop, Constants::GhostAnimation_DEATHLEFT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexDeathRight, AnimationType::Loop, Constants::GhostAnimation_DEATHRIGHT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexDeathUp, AnimationType::Loop, Constants::GhostAnimation_DEATHUP, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexDeathDown, AnimationType::Loop, Constants::GhostAnimation_DEATHDOWN, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+    GhostState state;
+    SDL_memcpy(&state, pState, sizeof(state));
+    _penTimer.Restore(state.penStartTicks, state.penTargetTicks, state.fPenTimerStarted);
+    _scatterTimer.Restore(state.scatterStartTicks, state.scatterTargetTicks, state.fScatterTimerStarted);
+    _penTimerMax = state.penTimerMax;
+    _scatterRow = state.scatterRow;
+    _scatterCol = state.scatterCol;
+    _targetRow = state.targetRow;
+    _targetCol = state.targetCol;
+    _targetColor = state.targetColor;
+    _fScatter = state.fScatter;
+    _fHasNextDecision = state.fHasNextDecision;
+    Decision *pDecisions[] = { &_nextDecision, &_currentDecision, &_prevDecision };
+    for (int i = 0; i < 3; i++)
+    {
+        *pDecisions[i] = Decision(state.decisionRows[i], state.decisionCols[i], static_cast<Direction>(state.decisionDirections[i]));
+    }
+}
+
+// Each ghost has its own row of colored frames (frames 0-7) at yTexture, the rest of the frames
+// and every animation are common to all of them
+void Ghost::InitializeCommon(AnimationRegistry::FrameTableId frameTableId, Uint16 yTexture)
+{
+    if (UseFrameTable(frameTableId))
+    {
+        LoadFrames(0, 0, yTexture, 8);
+        LoadFrames(8, 256, 64, 2);
+        LoadFrames(10, 256, 96, 2);
+        LoadFrames(12, 256, 128, 2);
+        LoadFrames(14, 256, 150, 2);
+    }
+
+    if (UseClipSet(AnimationRegistry::ClipSetId::Ghost))
+    {
+        LoadAnimationSequence(Constants::AnimationIndexLeft, AnimationType::Loop, Constants::GhostAnimation_LEFT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexRight, AnimationType::Loop, Constants::GhostAnimation_RIGHT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexUp, AnimationType::Loop, Constants::GhostAnimation_UP, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexDown, AnimationType::Loop, Constants::GhostAnimation_DOWN, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexFright, AnimationType::Loop, Constants::GhostAnimation_FRIGHT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexScared, AnimationType::Loop, Constants::GhostAnimation_SCARED, Constants::GhostScaredAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexDeathLeft, AnimationType::Loop, Constants::GhostAnimation_DEATHLEFT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexDeathRight, AnimationType::Loop, Constants::GhostAnimation_DEATHRIGHT, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexDeathUp, AnimationType::Loop, Constants::GhostAnimation_DEATHUP, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexDeathDown, AnimationType::Loop, Constants::GhostAnimation_DEATHDOWN, Constants::GhostMovingAnimationFrameCount, Constants::GhostAnimationSpeed);
+    }
     SetFrameOffset(1 - (Constants::GhostSpriteWidth / 2), 1 - (Constants::GhostSpriteHeight / 2));
 }
 
@@ -184,7 +286,7 @@ Direction Ghost::GetNextDirection(Uint16 r, Uint16 c, Maze *pMaze)
     };
 
     // This option is automatically invalid
-    size_t oppositeOption = static_cast<size_t>(Opposite(_pCurrentDecision->GetDirection()));
+    size_t oppositeOption = static_cast<size_t>(Opposite(_currentDecision.GetDirection()));
     SDL_assert(oppositeOption != static_cast<size_t>(Direction::None));
 
     // Now there are 3 options left
@@ -210,16 +312,15 @@ Direction Ghost::GetNextDirection(Uint16 r, Uint16 c, Maze *pMaze)
 // Look ahead one tile and make a decision about what to do when we
 // eventually get there.  If the tile is an intersection, we will ask
 // our specific ghost implementation what to do.
-Ghost::Decision* Ghost::GetNextDecision(Player *pPlayer, Maze* pMaze)
+Ghost::Decision Ghost::GetNextDecision(Player *pPlayer, Maze* pMaze)
 {
-    // Record current cell
-    SDL_Point ghostPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
-    pMaze->GetTileRowCol(ghostPoint, _currentRow, _currentCol);
+    // Start from the cell we're tracking rather than the one under our position, they differ
+    // for a frame when we reverse just after entering a cell and step back over the edge
+    Uint16 r = CurrentRow();
+    Uint16 c = CurrentCol();
 
     // Get the next cell based only on Direction of current decision
-    Uint16 r = _currentRow;
-    Uint16 c = _currentCol;
-    TranslateCell(r, c, _pCurrentDecision->GetDirection());
+    TranslateCell(r, c, _currentDecision.GetDirection());
 
     // This cell should be free
     SDL_assert(pMaze->IsTileSolid(r, c) == SDL_FALSE);
@@ -237,15 +338,23 @@ Ghost::Decision* Ghost::GetNextDecision(Player *pPlayer, Maze* pMaze)
         newDirection = GetNextDirection(r, c, pMaze);
     }
 
-    return new Decision(r, c, newDirection);
+    return Decision(r, c, newDirection);
+}
+
+// Start over from the given cell in the direction we're already moving, nothing decided
+// about the cell after it yet
+void Ghost::ResetDecisions(Uint16 row, Uint16 col)
+{
+    _currentDecision = Decision(row, col, CurrentDirection());
+    _prevDecision = _currentDecision;
+    _fHasNextDecision = false;
 }
 
-bool Ghost::IsGhostWarpingOut(Maze* pMaze)
+bool Ghost::IsGhostWarpingOut(Maze* /*pMaze*/)
 {
-    SDL_Point updatedPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
     Uint16 row = 0;
     Uint16 col = 0;
-    pMaze->GetTileRowCol(updatedPoint, row, col);
+    GetTile(row, col);
     // Unlike the player, start warping 1 more tile inside, this is because the
     // ghost logic looks ahead one tile in normal mode and this will ensure it
     // is always in bounds of our map.  We have no need of the map indicies while
@@ -256,28 +365,22 @@ bool Ghost::IsGhostWarpingOut(Maze* pMaze)
 
 void Ghost::OnExitingPen(Player* pPlayer, Maze* pMaze)
 {
-    Sprite::Update();
     // Check if we're done exiting
     // Then change to chase mode
     SDL_Point centerPoint = pMaze->GetTileCoordinates(14, 13);
     if (pMaze->IsSpritePastCenter(Constants::GhostPenRowExit, Constants::GhostPenCol, this))
     {
-        ResetPosition(centerPoint.x, centerPoint.y);
-        _currentRow = Constants::GhostPenRowExit;
-        _currentCol = Constants::GhostPenCol;
-        SafeDelete<Decision>(_pPrevDecision);
-        SafeDelete<Decision>(_pNextDecision);
-        SafeDelete<Decision>(_pCurrentDecision);
-
-        double speed = Constants::GhostBaseSpeed * 1.75;
+        ResetPosition(IntToCoord(centerPoint.x), IntToCoord(centerPoint.y));
+        SetCurrentCell(Constants::GhostPenRowExit, Constants::GhostPenCol);
+        Coord speed = Constants::GhostSpeed;
         if (pPlayer->X() < X())
         {
             speed = speed * -1;
         }
 
-        SetVelocity(speed, 0.0);
-        _pCurrentDecision = new Decision(Constants::GhostPenRowExit, Constants::GhostPenCol, CurrentDirection());
-        _mode = Mode::Chase;
+        SetVelocity(speed, 0);
+        ResetDecisions(Constants::GhostPenRowExit, Constants::GhostPenCol);
+        SetMode(Mode::Chase);
     }
 }
 
@@ -285,45 +388,39 @@ void Ghost::OnExitingPen(Player* pPlayer, Maze* pMaze)
 // ghost will incur a speed penalty while warping
 void Ghost::OnWarpingOut(Player* /*pPlayer*/, Maze* pMaze)
 {
-    Sprite::Update();
     SDL_Rect mapRect = pMaze->GetMapBounds();
     if (IsOutOfView(mapRect))
     {
         if (DX() > 0)
         {
-            ResetPosition(mapRect.x - Width(), Y());
-            _mode = Mode::WarpingIn;
+            ResetPosition(IntToCoord(mapRect.x - Width()), Y());
+            SetMode(Mode::WarpingIn);
         }
         else if (DX() < 0)
         {
-            ResetPosition(mapRect.x + mapRect.w + Width(), Y());
-            _mode = Mode::WarpingIn;
+            ResetPosition(IntToCoord(mapRect.x + mapRect.w + Width()), Y());
+            SetMode(Mode::WarpingIn);
         }
     }
 }
 
-void Ghost::OnWarpingIn(Player* /*pPlayer*/, Maze* pMaze)
+void Ghost::OnWarpingIn(Player* /*pPlayer*/, Maze* /*pMaze*/)
 {
     // Maintain current velocity until we're back in frame
-    Sprite::Update();
-    SDL_Point ghostPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
-    Uint16 row, col;
-    pMaze->GetTileRowCol(ghostPoint, row, col);
+    Uint16 row = 0;
+    Uint16 col = 0;
+    GetTile(row, col);
     // We stay in this state until we're 1 tile in from the "warp out" tile, this way
     // We won't immediately reenter the WarpingOut state and we can't turn anyway with
     // the map design, so this is an optimization
     if ((row == Constants::WarpRow) && ((col == 2) || (col == 25)))
     {
         // Remove the speed penalty
-        SetVelocity(2.0 * DX(), 2.0 * DY());
-        _currentRow = row;
-        _currentCol = col;
+        SetVelocity(DX() * 2, DY() * 2);
+        SetCurrentCell(row, col);
         // Need a new decision as well
-        SafeDelete<Decision>(_pPrevDecision);
-        SafeDelete<Decision>(_pNextDecision);
-        SafeDelete<Decision>(_pCurrentDecision);
-        _pCurrentDecision = new Decision(row, col, CurrentDirection());
-        _mode = Mode::Chase;
+        ResetDecisions(row, col);
+        SetMode(Mode::Chase);
     }
 }
 
@@ -341,63 +438,60 @@ void Ghost::OnChasing(Player* pPlayer, Maze* pMaze)
         {
             // Place below pen and move upward to outer row
             SDL_Point exitPoint = pMaze->GetTileCoordinates(17, 13);
-            ResetPosition(exitPoint.x, exitPoint.y);
+            ResetPosition(IntToCoord(exitPoint.x), IntToCoord(exitPoint.y));
             SetAnimation(Constants::AnimationIndexUp);
-            SetVelocity(0.0, Constants::GhostBaseSpeed * -1.75);
-            _mode = Mode::ExitingPen;
+            SetVelocity(0, -Constants::GhostSpeed);
+            SetMode(Mode::ExitingPen);
         }
     }
     else if (_fScatter)
     {
         if (_scatterTimer.IsDone())
         {
+            TRACE_INSTANT(Trace(), "Ghost scatter done", "ghost", Id(), nullptr);
             _fScatter = false;
         }
     }
     // Otherwise the chase logic is exactly the same, it just can't reach the player
 
-    if (_mode != Mode::ExitingPen)
+    if (GetMode() != Mode::ExitingPen)
     {
         // Move along the current direction, but never further than the centerpoint
         // of the given cell
-        SDL_Point centerPoint = pMaze->GetTileCoordinates(_currentRow, _currentCol);
-        Sprite::Update();
-        if (pMaze->IsSpritePastCenter(_currentRow, _currentCol, this) &&
-            _pCurrentDecision->GetDirection() != CurrentDirection())
+        SDL_Point centerPoint = pMaze->GetTileCoordinates(CurrentRow(), CurrentCol());
+        if (pMaze->IsSpritePastCenter(CurrentRow(), CurrentCol(), this) &&
+            _currentDecision.GetDirection() != CurrentDirection())
         {
-            ResetPosition(centerPoint.x, centerPoint.y);
+            ResetPosition(IntToCoord(centerPoint.x), IntToCoord(centerPoint.y));
             Stop();
         }
         else
         {
-            SDL_assert(_pCurrentDecision != nullptr);
-            if (_pNextDecision == nullptr)
+            if (!_fHasNextDecision)
             {
-                _pNextDecision = GetNextDecision(pPlayer, pMaze);
+                _nextDecision = GetNextDecision(pPlayer, pMaze);
+                _fHasNextDecision = true;
             }
 
-            SDL_Point updatedPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
             Uint16 row = 0;
             Uint16 col = 0;
-            pMaze->GetTileRowCol(updatedPoint, row, col);
+            GetTile(row, col);
 
-            if ((row != _currentRow) || (col != _currentCol))
+            if ((row != CurrentRow()) || (col != CurrentCol()))
             {
                 // Entering a new cell
-                _currentRow = row;
-                _currentCol = col;
-                SDL_assert(_pNextDecision != nullptr);
-                SafeDelete<Decision>(_pPrevDecision);
-                _pPrevDecision = _pCurrentDecision;
-                _pCurrentDecision = _pNextDecision;
-                _pNextDecision = nullptr;
+                SetCurrentCell(row, col);
+                SDL_assert(_fHasNextDecision);
+                _prevDecision = _currentDecision;
+                _currentDecision = _nextDecision;
+                _fHasNextDecision = false;
 
                 // Did we move into a warp cell?
                 if (IsGhostWarpingOut(pMaze))
                 {
                     // Add a speed penalty
-                    SetVelocity(0.5 * DX(), 0.5 * DY());
-                    _mode = Mode::WarpingOut;
+                    SetVelocity(DX() / 2, DY() / 2);
+                    SetMode(Mode::WarpingOut);
                 }
             }
             else
@@ -405,7 +499,7 @@ void Ghost::OnChasing(Player* pPlayer, Maze* pMaze)
                 if (IsStopped())
                 {
                     // Set Direction
-                    UpdateAnimation(_pCurrentDecision->GetDirection());
+                    UpdateAnimation(_currentDecision.GetDirection());
                 }
             }
         }
@@ -423,28 +517,28 @@ void Ghost::UpdateAnimation(Direction direction)
     switch (direction)
     {
     case Direction::Up:
-        SetVelocity(0, Constants::GhostBaseSpeed * -1.75);
+        SetVelocity(0, -Constants::GhostSpeed);
         if (!_fScatter)
         {
             SetAnimation(Constants::AnimationIndexUp);
         }
         break;
     case Direction::Down:
-        SetVelocity(0, Constants::GhostBaseSpeed * 1.75);
+        SetVelocity(0, Constants::GhostSpeed);
         if (!_fScatter)
         {
             SetAnimation(Constants::AnimationIndexDown);
         }
         break;
     case Direction::Left:
-        SetVelocity(Constants::GhostBaseSpeed * -1.75, 0);
+        SetVelocity(-Constants::GhostSpeed, 0);
         if (!_fScatter)
         {
             SetAnimation(Constants::AnimationIndexLeft);
         }
         break;
     case Direction::Right:
-        SetVelocity(Constants::GhostBaseSpeed * 1.75, 0);
+        SetVelocity(Constants::GhostSpeed, 0);
         if (!_fScatter)
         {
             SetAnimation(Constants::AnimationIndexRight);
@@ -459,13 +553,9 @@ void Ghost::ReverseDirection()
 {
     // this should be safe in all cases
     SetVelocity(DX() * -1, DY() * -1);
-    SafeDelete<Decision>(_pNextDecision);
- 
-    Decision *tmp = _pCurrentDecision;
-    Direction dir = Opposite(_pPrevDecision->GetDirection());
-    _pCurrentDecision = new Decision(_currentRow, _currentCol, dir);
-
-    SafeDelete<Decision>(_pPrevDecision);
-    SafeDelete<Decision>(tmp);
+    _fHasNextDecision = false;
 
+    // Head back the way we came, and reversing again heads back the way we were going
+    _currentDecision = Decision(CurrentRow(), CurrentCol(), Opposite(_prevDecision.GetDirection()));
+    _prevDecision = _currentDecision;
 }
\ No newline at end of file
@@ -0,0 +1,262 @@
+#include "include/heatmap.h"
+#include "include/constants.h"
+#include <stdio.h>
+#include <math.h>
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    const int LayerCount = static_cast<int>(HeatmapLayer::Count);
+    const Uint8 OverlayAlpha = 144;
+    const SDL_Color Transparent = { 0, 0, 0, 0 };
+
+    // Cold to hot: blue, cyan, green, yellow, red
+    const SDL_Color HeatColors[] =
+    {
+        { 0, 0, 255, OverlayAlpha },
+        { 0, 255, 255, OverlayAlpha },
+        { 0, 255, 0, OverlayAlpha },
+        { 255, 255, 0, OverlayAlpha },
+        { 255, 0, 0, OverlayAlpha }
+    };
+
+    SDL_Color HeatColor(float level)
+    {
+        float position = level * (SDL_arraysize(HeatColors) - 1);
+        int from = SDL_min(static_cast<int>(position), static_cast<int>(SDL_arraysize(HeatColors)) - 2);
+        float blend = position - from;
+        const SDL_Color &a = HeatColors[from];
+        const SDL_Color &b = HeatColors[from + 1];
+        SDL_Color color = {
+            static_cast<Uint8>(a.r + ((b.r - a.r) * blend)),
+            static_cast<Uint8>(a.g + ((b.g - a.g) * blend)),
+            static_cast<Uint8>(a.b + ((b.b - a.b) * blend)),
+            OverlayAlpha };
+        return color;
+    }
+}
+
+const char* XplatGameTutorial::PacManClone::HeatmapLayerName(HeatmapLayer layer)
+{
+    static const char *Names[] = { "players", "ghosts", "pellets", "collisions" };
+    static_assert(SDL_arraysize(Names) == LayerCount, "A name for every layer");
+    return Names[static_cast<int>(layer)];
+}
+
+// One scanning thread's counts, laid out like Heatmap::_pCounts then the pellet ticks, but with an extra
+// cell on the end of each for anything off the map so the loops don't need to check
+struct Heatmap::ScanCounts
+{
+    Uint32 cCells;
+    Uint64 *pCounts;
+};
+
+Heatmap::Heatmap() :
+    _cRows(0),
+    _cCols(0),
+    _cCells(0),
+    _cGames(0),
+    _cTicks(0),
+    _pCounts(nullptr),
+    _pPelletTicks(nullptr),
+    _earliestPellet(0.0),
+    _latestPellet(0.0),
+    _pLevels(nullptr),
+    _pColors(nullptr)
+{
+    SDL_zero(_maxCounts);
+}
+
+Heatmap::~Heatmap()
+{
+    delete[] _pCounts;
+    delete[] _pPelletTicks;
+    delete[] _pLevels;
+    delete[] _pColors;
+}
+
+void Heatmap::Build(const FactStore &store, Uint32 cThreads)
+{
+    delete[] _pCounts;
+    delete[] _pPelletTicks;
+    delete[] _pLevels;
+    delete[] _pColors;
+    _cRows = store.MapRows();
+    _cCols = store.MapCols();
+    _cCells = _cRows * _cCols;
+    _cGames = store.GameCount();
+    _cTicks = store.TickCount();
+
+    // Each thread's counts are an allocation of their own, well apart from the others'
+    cThreads = SDL_max(SDL_min(cThreads, store.SegmentCount()), 1u);
+    Uint32 cThreadCounts = (LayerCount + 1) * (_cCells + 1);
+    ScanCounts *pThreadCounts = new ScanCounts[cThreads];
+    void **ppContexts = new void*[cThreads];
+    for (Uint32 i = 0; i < cThreads; i++)
+    {
+        pThreadCounts[i].cCells = _cCells;
+        pThreadCounts[i].pCounts = new Uint64[cThreadCounts];
+        SDL_memset(pThreadCounts[i].pCounts, 0, cThreadCounts * sizeof(Uint64));
+        ppContexts[i] = &pThreadCounts[i];
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    store.Scan(cThreads, ScanSegment, ppContexts);
+
+    // Only now are they added up, leaving out the off the map cells
+    _pCounts = new Uint64[LayerCount * _cCells];
+    _pPelletTicks = new Uint64[_cCells];
+    SDL_memset(_pCounts, 0, LayerCount * _cCells * sizeof(Uint64));
+    SDL_memset(_pPelletTicks, 0, _cCells * sizeof(Uint64));
+    for (Uint32 i = 0; i < cThreads; i++)
+    {
+        const Uint64 *pCounts = pThreadCounts[i].pCounts;
+        for (int layer = 0; layer < LayerCount; layer++)
+        {
+            for (Uint32 cell = 0; cell < _cCells; cell++)
+            {
+                _pCounts[(layer * _cCells) + cell] += pCounts[(layer * (_cCells + 1)) + cell];
+            }
+        }
+        for (Uint32 cell = 0; cell < _cCells; cell++)
+        {
+            _pPelletTicks[cell] += pCounts[(LayerCount * (_cCells + 1)) + cell];
+        }
+        delete[] pThreadCounts[i].pCounts;
+    }
+    double ms = ((SDL_GetPerformanceCounter() - start) * 1000.0) / SDL_GetPerformanceFrequency();
+    delete[] ppContexts;
+    delete[] pThreadCounts;
+
+    SetLevels();
+    printf("Heatmaps of %llu games (%llu ticks) in %.1f ms on %u thread%s\n", static_cast<unsigned long long>(_cGames),
+        static_cast<unsigned long long>(_cTicks), ms, cThreads, (cThreads == 1) ? "" : "s");
+}
+
+void Heatmap::ScanSegment(const FactStore &store, const FactSegment &segment, void *pContext)
+{
+    ScanCounts *pScan = static_cast<ScanCounts*>(pContext);
+    Uint32 cCells = pScan->cCells;
+    Uint32 stride = cCells + 1;
+    Uint64 *pPlayers = pScan->pCounts + (static_cast<int>(HeatmapLayer::Players) * stride);
+    Uint64 *pGhosts = pScan->pCounts + (static_cast<int>(HeatmapLayer::Ghosts) * stride);
+    Uint64 *pPellets = pScan->pCounts + (static_cast<int>(HeatmapLayer::PelletTimes) * stride);
+    Uint64 *pCollisions = pScan->pCounts + (static_cast<int>(HeatmapLayer::Collisions) * stride);
+    Uint64 *pPelletTicks = pScan->pCounts + (LayerCount * stride);
+
+    const Uint16 *pCell = segment.pActorCell;
+    Uint32 firstEvent = 0;
+    for (Uint32 game = 0; game < segment.cGames; game++)
+    {
+        // Tick by tick, the players then the ghosts
+        Uint16 cPlayers = segment.pGamePlayers[game];
+        Uint16 cGhosts = segment.pGameGhosts[game];
+        for (Uint32 tick = 0; tick < segment.pGameTicks[game]; tick++)
+        {
+            for (Uint16 i = 0; i < cPlayers; i++, pCell++)
+            {
+                pPlayers[SDL_min(static_cast<Uint32>(*pCell), cCells)]++;
+            }
+            for (Uint16 i = 0; i < cGhosts; i++, pCell++)
+            {
+                pGhosts[SDL_min(static_cast<Uint32>(*pCell), cCells)]++;
+            }
+        }
+
+        // The game's events are in tick order, so the level each pellet was eaten in started after the last
+        // level complete seen
+        Uint32 levelStart = 0;
+        Uint32 endEvent = firstEvent + segment.pGameEvents[game];
+        for (Uint32 i = firstEvent; i < endEvent; i++)
+        {
+            Uint32 cell = SDL_min(static_cast<Uint32>(segment.pEventCell[i]), cCells);
+            Uint32 tick = segment.pEventTick[i];
+            switch (static_cast<FactEvent>(segment.pEventKind[i]))
+            {
+            case FactEvent::PelletEaten:
+            case FactEvent::PowerPellet:
+                pPellets[cell]++;
+                pPelletTicks[cell] += (tick >= levelStart) ? tick - levelStart : 0;
+                break;
+            case FactEvent::Caught:
+                pCollisions[cell]++;
+                break;
+            case FactEvent::LevelComplete:
+                levelStart = tick + 1;
+                break;
+            default:
+                break;
+            }
+        }
+        firstEvent = endEvent;
+    }
+}
+
+void Heatmap::SetLevels()
+{
+    _pLevels = new float[LayerCount * _cCells];
+    _pColors = new SDL_Color[LayerCount * _cCells];
+
+    _earliestPellet = 0.0;
+    _latestPellet = 0.0;
+    bool fAnyPellets = false;
+    for (Uint32 cell = 0; cell < _cCells; cell++)
+    {
+        Uint64 cPellets = _pCounts[(static_cast<int>(HeatmapLayer::PelletTimes) * _cCells) + cell];
+        if (cPellets > 0)
+        {
+            double mean = static_cast<double>(_pPelletTicks[cell]) / cPellets;
+            _earliestPellet = fAnyPellets ? SDL_min(_earliestPellet, mean) : mean;
+            _latestPellet = fAnyPellets ? SDL_max(_latestPellet, mean) : mean;
+            fAnyPellets = true;
+        }
+    }
+
+    for (int layer = 0; layer < LayerCount; layer++)
+    {
+        const Uint64 *pCounts = _pCounts + (layer * _cCells);
+        _maxCounts[layer] = 0;
+        for (Uint32 cell = 0; cell < _cCells; cell++)
+        {
+            _maxCounts[layer] = SDL_max(_maxCounts[layer], pCounts[cell]);
+        }
+
+        // The pellet times go by how late they were eaten, the rest by how many there were
+        double logMax = log(_maxCounts[layer] + 1.0);
+        double pelletRange = _latestPellet - _earliestPellet;
+        for (Uint32 cell = 0; cell < _cCells; cell++)
+        {
+            float level = -1.0f;        // Nothing to show
+            if (pCounts[cell] > 0 && layer == static_cast<int>(HeatmapLayer::PelletTimes))
+            {
+                double mean = static_cast<double>(_pPelletTicks[cell]) / pCounts[cell];
+                level = (pelletRange > 0.0) ? static_cast<float>((mean - _earliestPellet) / pelletRange) : 0.0f;
+            }
+            else if (pCounts[cell] > 0)
+            {
+                level = static_cast<float>(log(pCounts[cell] + 1.0) / logMax);
+            }
+            _pLevels[(layer * _cCells) + cell] = level;
+            _pColors[(layer * _cCells) + cell] = (level >= 0.0f) ? HeatColor(level) : Transparent;
+        }
+    }
+}
+
+void Heatmap::Describe(HeatmapLayer layer, char *szText, size_t cchText)
+{
+    switch (layer)
+    {
+    case HeatmapLayer::PelletTimes:
+        SDL_snprintf(szText, cchText, "PELLETS EATEN %.1f TO %.1f S INTO THE LEVEL", _earliestPellet / Constants::FramesPerSecond,
+            _latestPellet / Constants::FramesPerSecond);
+        break;
+    case HeatmapLayer::Collisions:
+        SDL_snprintf(szText, cchText, "COLLISIONS  MOST ON A TILE %llu", static_cast<unsigned long long>(_maxCounts[static_cast<int>(layer)]));
+        break;
+    default:
+        SDL_snprintf(szText, cchText, "%s  MOST ON A TILE %.1f S", (layer == HeatmapLayer::Players) ? "PLAYERS" : "GHOSTS",
+            static_cast<double>(_maxCounts[static_cast<int>(layer)]) / Constants::FramesPerSecond);
+        break;
+    }
+}
@@ -0,0 +1,138 @@
+#pragma once
+#include "SDL.h"
+#include "animationregistry.h"
+#include "coord.h"
+#include "arena.h"
+#include "tracerecorder.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Handle to an actor's slot in the ActorStore
+    typedef Uint16 ActorId;
+
+    // Raised when an actor's position moves it into a different tile of the map
+    struct TileEnteredEvent
+    {
+        ActorId id;
+        Uint16 row;     // ActorStore::OffMap if it just left the map
+        Uint16 col;
+    };
+
+    // Data oriented storage for every moving actor in the game.  Instead of each Sprite holding its own position,
+    // velocity and animation counters, they live here in contiguous arrays (one per field, a.k.a. structure of arrays).
+    // This lets us integrate movement and advance animations for every actor in a single tight loop, and the whole
+    // state of the actors is a handful of flat arrays, which is cheap to copy or snapshot.
+    class ActorStore
+    {
+    public:
+        // pAnimations - the shared clips the actors play, not owned
+        static const Uint16 OffMap = 0xFFFF;
+
+        ActorStore(AnimationRegistry *pAnimations);
+        ~ActorStore();
+
+        // Carves space for cCapacity actors out of the arena, must be called once before Add()
+        bool Reserve(Uint16 cCapacity, Arena *pArena);
+        // What Reserve() takes from the arena
+        static size_t ArenaBytes(Uint16 cCapacity);
+        // Claims the next free slot and zeroes it
+        ActorId Add();
+        // Applies velocity to position and advances the animation counters for every actor
+        void Update();
+        // Hash of the simulated state (clock, positions, velocities, modes, cells and animation) for
+        // checking that two runs stayed in step
+        Uint32 Checksum();
+        // The whole simulated state (the clock, every array and the pending tile events) as one flat blob,
+        // for replay keyframes.  Only good for the same roster on the same build, nothing is byte swapped
+        static size_t StateBytes(Uint16 cActors);
+        void SaveState(Uint8 *pState);
+        void RestoreState(const Uint8 *pState);
+
+        Uint16 Count() { return _cActors; }
+        Uint16 Capacity() { return _cCapacity; }
+
+        // Simulation time in ms, advanced by a fixed frame each Update().  Timers that are part
+        // of the simulation (e.g. the ghost pen timers) run off this rather than the wall clock
+        const Uint32* Clock() { return &_clockTicks; }
+
+        // Position and velocity
+        Coord X(ActorId id) { return _pX[id]; }
+        Coord Y(ActorId id) { return _pY[id]; }
+        Coord DX(ActorId id) { return _pDX[id]; }
+        Coord DY(ActorId id) { return _pDY[id]; }
+        void SetPosition(ActorId id, Coord x, Coord y) { _pX[id] = x; _pY[id] = y; UpdateTile(id); }
+        // Position at the start of the last Update(), so X/Y minus these is how far the actor travelled this tick
+        Coord PrevX(ActorId id) { return _pPrevX[id]; }
+        Coord PrevY(ActorId id) { return _pPrevY[id]; }
+        void SetVelocity(ActorId id, Coord dx, Coord dy) { _pDX[id] = dx; _pDY[id] = dy; }
+
+        // Which tile of the map the position falls in, kept up to date on every position change.  The
+        // map layout is needed first to do that, bounds in whole pixels
+        void SetTileLayout(const SDL_Rect &bounds, Uint16 tileSize);
+        Uint16 TileRow(ActorId id) { return _pTileRow[id]; }
+        Uint16 TileCol(ActorId id) { return _pTileCol[id]; }
+        // Same rules as TiledMap::GetTileRowCol() but for any position, false if it's off the map
+        bool TileAt(Coord x, Coord y, Uint16 &row, Uint16 &col);
+
+        // Actors that changed tile since the events were last cleared, at most one (the latest) per actor
+        Uint16 TileEventCount() { return _cTileEvents; }
+        const TileEnteredEvent& TileEvent(Uint16 index) { return _pTileEvents[index]; }
+        void ClearTileEvents();
+
+        // Owner defined current cell in the maze (e.g. the cell a ghost has decided on, which can
+        // briefly differ from the tile under it)
+        Uint16 Row(ActorId id) { return _pRow[id]; }
+        Uint16 Col(ActorId id) { return _pCol[id]; }
+        void SetCell(ActorId id, Uint16 row, Uint16 col) { _pRow[id] = row; _pCol[id] = col; }
+
+        // Actor specific internal state (e.g. Ghost::Mode), stored opaque
+        Uint8 Mode(ActorId id) { return _pMode[id]; }
+        void SetMode(ActorId id, Uint8 mode) { _pMode[id] = mode; }
+
+        // Animation playback, the clip itself is shared in the registry, we only track where we are in it
+        ClipId Clip(ActorId id) { return _pClip[id]; }
+        Uint16 FrameIndex(ActorId id) { return _pFrameIndex[id]; }
+        void SetClip(ActorId id, ClipId clipId) { _pClip[id] = clipId; ResetAnimation(id); }
+        void ResetAnimation(ActorId id) { _pFrameIndex[id] = 0; _pAnimationCounter[id] = 0; }
+        AnimationRegistry* Animations() { return _pAnimations; }
+
+#ifdef ENABLE_PROFILER
+        // Where the actors report their mode changes, not owned and nullptr when not tracing
+        TraceRecorder* Trace() { return _pTrace; }
+        void SetTraceRecorder(TraceRecorder *pTrace) { _pTrace = pTrace; }
+#endif
+
+    private:
+        void UpdateTile(ActorId id);
+
+        AnimationRegistry *_pAnimations;    // Not owned
+        Uint16 _cCapacity;                  // Slots allocated
+        Uint16 _cActors;                    // Slots in use
+        Uint32 _clockTicks;                 // Simulation time
+        Coord *_pX;                         // Position
+        Coord *_pY;
+        Coord *_pDX;                        // Velocity
+        Coord *_pDY;
+        Coord *_pPrevX;                     // Position before the last Update()
+        Coord *_pPrevY;
+        SDL_Rect _mapBounds;                // Tile layout
+        Uint16 _tileSize;
+        Uint16 *_pTileRow;                  // Tile under the position (OffMap if none)
+        Uint16 *_pTileCol;
+        TileEnteredEvent *_pTileEvents;     // Pending events, one slot per actor at most
+        Uint16 *_pTileEventIndex;           // Each actor's pending event (InvalidEvent if none)
+        Uint16 _cTileEvents;
+        Uint16 *_pRow;                      // Current cell
+        Uint16 *_pCol;
+        Uint8 *_pMode;                      // Owner defined state
+        ClipId *_pClip;                     // Current animation clip (InvalidClip if not animated)
+        Uint16 *_pFrameIndex;               // Index into the clip currently displayed
+        Uint16 *_pAnimationCounter;         // Counter between frame updates
+#ifdef ENABLE_PROFILER
+        TraceRecorder *_pTrace;
+#endif
+    };
+}
+}
@@ -0,0 +1,73 @@
+#pragma once
+#include "SDL.h"
+
+// Opt in with ENABLE_ALLOC_TRACKER (e.g. "make TRACK_ALLOCS=1").  It replaces the global operator
+// new/delete to count every allocation, per frame and per subsystem, and reports any that happen in a
+// frame that should be allocation free - gameplay (GameState::Running) is meant to run entirely out of
+// memory set up when the level loads.  Without it the ALLOC_ macros expand to nothing
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+#ifdef ENABLE_ALLOC_TRACKER
+    // What the game was doing when it allocated, see ALLOC_SCOPE
+    enum class AllocSubsystem
+    {
+        Other = 0,          // Outside any scope (SDL setup, other threads, ...)
+        Loading,            // LoadResources
+        Level,              // InitLevel
+        Input,              // ProcessInput
+        Players,            // ActorStore update and Player::Update
+        Ghosts,             // Ghost::Update
+        Collision,          // Pellets (tile events) and ghost collisions
+        Render,             // Drawing the frame
+        Count
+    };
+
+    const char* AllocSubsystemName(AllocSubsystem subsystem);
+
+    // All static, there is only the one heap.  Totals are kept for every thread, the frames are the
+    // game loop's (the thread calling BeginFrame/EndFrame)
+    class AllocationTracker
+    {
+    public:
+        // fSteadyState - nothing is expected to allocate this frame
+        static void BeginFrame(bool fSteadyState);
+        // Reports (and asserts, in debug) if a steady state frame allocated
+        static void EndFrame();
+        // Totals per subsystem, and the frames that broke the steady state
+        static void Report();
+
+        static Uint64 TotalAllocations();
+        static Uint64 TotalBytes();
+
+        // For operator new/delete
+        static void OnAllocate(size_t cb);
+        static void OnFree();
+    };
+
+    // Attributes allocations on this thread to a subsystem for the enclosing scope
+    class AllocationScope
+    {
+    public:
+        explicit AllocationScope(AllocSubsystem subsystem);
+        ~AllocationScope();
+
+    private:
+        AllocSubsystem _prevSubsystem;
+    };
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_SCOPE(subsystem) AllocationScope ALLOC_CONCAT(allocScope, __LINE__)(AllocSubsystem::subsystem)
+#define ALLOC_BEGIN_FRAME(fSteadyState) AllocationTracker::BeginFrame(fSteadyState)
+#define ALLOC_END_FRAME() AllocationTracker::EndFrame()
+#define ALLOC_REPORT() AllocationTracker::Report()
+#else
+#define ALLOC_SCOPE(subsystem)
+#define ALLOC_BEGIN_FRAME(fSteadyState)
+#define ALLOC_END_FRAME()
+#define ALLOC_REPORT()
+#endif
+}
+}
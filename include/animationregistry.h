@@ -0,0 +1,62 @@
+#pragma once
+#include "SDL.h"
+#include "spriteanimation.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Index of an animation clip in the registry
+    typedef Uint16 ClipId;
+
+    // Shared home for the frame rects and animation clips used by the sprites.  Every ghost plays the same 10 clips
+    // and every instance of a given ghost uses the same frames, so rather than each sprite allocating and copying its
+    // own, the first sprite of a kind fills in the shared copy and the rest simply point at it (a flyweight).
+    class AnimationRegistry
+    {
+    public:
+        static const ClipId InvalidClip = 0xFFFF;
+
+        // One frame table per distinct layout on the sprite sheet
+        enum class FrameTableId
+        {
+            Player = 0,
+            Blinky,
+            Pinky,
+            Inky,
+            Clyde,
+            Count
+        };
+
+        // One clip set per kind of sprite, sprites refer to their clips by index within the set
+        enum class ClipSetId
+        {
+            Player = 0,
+            Ghost,
+            Count
+        };
+
+        AnimationRegistry();
+        ~AnimationRegistry();
+
+        // Returns the shared frame table for the id, allocating it on first use.  pfNeedsLoad is set if the
+        // caller is the first user and should fill in the frames
+        SDL_Rect* FrameTable(FrameTableId id, Uint16 cFrames, bool *pfNeedsLoad);
+        // Returns the first clip of the set, reserving cClips clips on first use.  pfNeedsLoad works as above
+        ClipId ClipSet(ClipSetId id, Uint16 cClips, bool *pfNeedsLoad);
+        // Fills in a clip reserved by ClipSet()
+        void SetClip(ClipId clipId, const int* pSequence, Uint16 cFrames, AnimationType animationType, Uint16 animationSpeed);
+
+        const SpriteAnimation& Clip(ClipId clipId) { return _clips[clipId]; }
+
+    private:
+        static const Uint16 c_maxClips = 32;
+
+        SDL_Rect* _pFrameTables[static_cast<size_t>(FrameTableId::Count)];    // Owned
+        Uint16 _cFrameTableSize[static_cast<size_t>(FrameTableId::Count)];
+        ClipId _clipSetBase[static_cast<size_t>(ClipSetId::Count)];
+        SpriteAnimation _clips[c_maxClips];
+        Uint16 _cClips;
+    };
+}
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "SDL.h"
+#include <type_traits>
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Bump allocator over one block reserved up front.  Allocations are carved off the end in order and
+    // never freed individually, instead the arena is rewound to an earlier Mark() in constant time,
+    // dropping everything allocated since.  The GameHarness keeps the session's data (the roster, the
+    // ActorStore, ...) at the bottom and the current level's above it, so starting a level over is a
+    // Rewind() and nothing goes back to the heap.  Only for types that need no destructor
+    class Arena
+    {
+    public:
+        Arena();
+        ~Arena();
+
+        // Allocates the block, must be called once before Allocate()
+        bool Reserve(size_t cbCapacity);
+
+        // Worst case space count Ts take, alignment included, for sizing the Reserve()
+        template <class T> static size_t Bytes(size_t count)
+        {
+            return (count * sizeof(T)) + alignof(T) - 1;
+        }
+
+        // Zeroed space for count Ts.  Running out is a programming error, the sizes are known up front
+        template <class T> T* Allocate(size_t count)
+        {
+            static_assert(std::is_trivially_destructible<T>::value, "Arena memory is rewound, never destroyed");
+            return static_cast<T*>(AllocateBytes(count * sizeof(T), alignof(T)));
+        }
+
+        // Rewind(Mark()) frees everything allocated in between
+        size_t Mark() { return _cbUsed; }
+        void Rewind(size_t mark);
+
+        size_t Used() { return _cbUsed; }
+        size_t Capacity() { return _cbCapacity; }
+        size_t HighWater() { return _cbHighWater; }
+
+    private:
+        void* AllocateBytes(size_t cb, size_t alignment);
+
+        Uint8 *_pBase;
+        size_t _cbCapacity;
+        size_t _cbUsed;
+        size_t _cbHighWater;        // Most ever in use
+    };
+}
+}
@@ -12,7 +12,7 @@ namespace PacManClone
     class Blinky : public Ghost
     {
     public:
-        Blinky(TextureWrapper* pTextureWrapper);
+        Blinky(TextureWrapper* pTextureWrapper, ActorStore* pActorStore);
 
         // "Interface" for my ghosts to implement
         bool Initialize();
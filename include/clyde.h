@@ -9,7 +9,7 @@ namespace XplatGameTutorial
         class Clyde : public Ghost
         {
         public:
-            Clyde(TextureWrapper* pTextureWrapper);
+            Clyde(TextureWrapper* pTextureWrapper, ActorStore* pActorStore);
 
             // "Interface" for my ghosts to implement
             bool Initialize();
@@ -0,0 +1,23 @@
+#pragma once
+#include "coord.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // The path of an actor over one tick, from where it started to where it ended up
+    struct SweptPoint
+    {
+        Coord x0;
+        Coord y0;
+        Coord x1;
+        Coord y1;
+    };
+
+    // Swept collision: true if at any instant during the tick the two actors were closer than distance on
+    // both axes (i.e. their boxes of size 2 * distance overlapped).  Both are assumed to move at a constant
+    // rate along their path, so two actors passing through each other are caught no matter how far they
+    // move in a tick.  All the math is exact in fixed point.
+    bool SweptOverlap(const SweptPoint &a, const SweptPoint &b, Coord distance);
+}
+}
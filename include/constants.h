@@ -1,5 +1,6 @@
 #pragma once
 #include "SDL.h"
+#include "coord.h"
 
 namespace XplatGameTutorial
 {
@@ -34,6 +35,7 @@ namespace PacManClone
         static const Uint16 PlayerStartCol = 13;
         static const Uint16 TotalPellets = 244;
         static const Uint32 LevelLoadDelay = 3000;
+        static const Uint32 IdleWaitTicks = 250;      // Longest a static screen (the title) sleeps with no events coming in
         static const Uint32 LevelCompleteDelay = 6000;
         static const Uint16 WarpRow = 17;
         static const Uint16 WarpColPlayerLeft = 0;
@@ -51,9 +53,14 @@ namespace PacManClone
         static const Uint16 InkyScatterCol = 27;
         static const Uint16 ClydeScatterRow = 35;
         static const Uint16 ClydeScatterCol = 0;
+        static const Uint16 MaxPlayers = 16;        // Roster limits, normal play is 1 player and 4 ghosts
+        static const Uint16 MaxGhosts = 16384;      // but stress mode (see GameOptions) can go much higher
 
-        static const double PlayerMaxSpeed;
-        static const double GhostBaseSpeed;
+        // Movement speeds in Coord units per update
+        static const Coord PlayerSpeed;
+        static const Coord GhostSpeed;
+        // Player and ghost collide when they get closer than this on both axes
+        static const Coord CollisionDistance;
 
         // Indices to tiles that make up the map - for your own sanity use a level editor (several free ones exist) or better
         // yet develop your own tool early in the design process
@@ -0,0 +1,40 @@
+#pragma once
+#include "SDL.h"
+
+// Positions and velocities are simulated in 16.16 fixed point so the movement (and anything replayed
+// from it) comes out bit for bit the same on every compiler and floating point setting.
+// Comment this out to go back to double precision movement
+#define FIXED_POINT_MOVEMENT
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+#ifdef FIXED_POINT_MOVEMENT
+    // A position or velocity in 1/65536ths of a pixel
+    typedef Sint32 Coord;
+
+    static const int CoordFractionBits = 16;
+    static const Coord CoordOne = 1 << CoordFractionBits;
+
+    // Whole pixels to Coord
+    inline Coord IntToCoord(int value) { return value * CoordOne; }
+    // Coord to whole pixels, truncates towards 0 just like casting a double to an int
+    inline int CoordToInt(Coord value) { return value / CoordOne; }
+    // Exact when denominator is a power of 2 (up to 65536), which all of our speeds are
+    inline Coord CoordFromFraction(int numerator, int denominator) { return (numerator * CoordOne) / denominator; }
+
+    // Wide enough to hold the product of two Coords without overflow
+    typedef Sint64 CoordProduct;
+#else
+    typedef double Coord;
+    typedef double CoordProduct;
+
+    inline Coord IntToCoord(int value) { return static_cast<double>(value); }
+    inline int CoordToInt(Coord value) { return static_cast<int>(value); }
+    inline Coord CoordFromFraction(int numerator, int denominator) { return static_cast<double>(numerator) / denominator; }
+#endif
+
+    inline Coord CoordAbs(Coord value) { return (value < 0) ? -value : value; }
+}
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include "SDL.h"
+#include <atomic>
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    class DiskWriter;
+
+    // One file being written by a DiskWriter.  A ring of bytes with one producer (whichever thread makes
+    // the data) and the DiskWriter's thread as the consumer, neither locks.  Write() only copies, so the
+    // producer never touches the file.  When the ring is too full for a span, what happens depends on
+    // the stream: losing a replay's ticks would spoil it, so those wait for room (and count the stall),
+    // telemetry is dropped a whole span at a time (and counted)
+    class DiskStream
+    {
+    public:
+        enum class Overflow
+        {
+            Wait,
+            Drop
+        };
+
+        // Producer side.  Copies cb bytes, false if they were dropped
+        bool Write(const void *pData, Uint32 cb);
+
+        const char* FileName() { return _szFileName; }
+
+    private:
+        friend class DiskWriter;
+
+        DiskStream(DiskWriter *pWriter, const char *szFileName, SDL_RWops *pFile, Uint32 capacity, Overflow overflow);
+        ~DiskStream();
+
+        // Writer thread, passes whatever is in the ring to the file.  Returns the bytes written
+        Uint32 Drain();
+
+        DiskWriter *_pWriter;
+        const char *_szFileName;            // Not owned
+        SDL_RWops *_pFile;
+        Uint8 *_pRing;
+        Uint32 _capacity;                   // A power of 2
+        Overflow _overflow;
+        std::atomic<Uint32> _head;          // Next byte to write out, written by the writer thread
+        std::atomic<Uint32> _tail;          // Next byte to fill, written by the producer
+        std::atomic<bool> _fClosing;        // Set by Close(), the writer finishes the file once the ring is empty
+        const Uint8 *_pHeader;              // Close(), written over the start of the file last of all
+        Uint32 _cbHeader;
+        SDL_sem *_pClosed;                  // Posted by the writer thread when the file is finished
+        bool _fFailed;                      // Writer thread, a write failed and the rest is thrown away
+
+        // Producer side
+        Uint32 _peakFill;
+        Uint32 _cStalls;
+        Uint64 _stallCounter;               // SDL_GetPerformanceCounter() ticks spent waiting for room
+        Uint32 _cDroppedSpans;
+        Uint64 _cbDropped;
+        // Writer thread
+        Uint64 _cbWritten;
+        Uint32 _cWrites;
+    };
+
+    // Gets files written without the threads making the data ever waiting on the disk.  Each file is a
+    // DiskStream, and one thread of our own does all the writing.  It wakes every FlushIntervalMs, or
+    // sooner when a ring gets half full or a stream is closed, and passes each ring's contents to the file
+    // in one go (two writes where it wraps), so the file sees a few large writes rather than one per tick
+    class DiskWriter
+    {
+    public:
+        static const Uint32 FlushIntervalMs = 100;
+
+        DiskWriter();
+        ~DiskWriter();
+
+        // Creates the file (starting the thread with the first one).  capacity is the ring's size in bytes
+        // and must be a power of 2.  Prints why and returns nullptr on failure
+        DiskStream* Open(const char *szFileName, Uint32 capacity, DiskStream::Overflow overflow);
+        // Waits for everything written to the stream to reach the file, then for pHeader (if any) to be
+        // written over the start of it, and closes it.  Reports any back-pressure.  The stream is deleted
+        void Close(DiskStream *pStream, const void *pHeader, Uint32 cbHeader);
+        // Stops the thread, any streams must be closed first
+        void Shutdown();
+
+    private:
+        friend class DiskStream;
+
+        static const Uint32 MaxStreams = 8;
+
+        static int WriterThread(void *pData);
+        void Wake() { SDL_SemPost(_pWake); }
+
+        SDL_Thread *_pThread;
+        SDL_sem *_pWake;
+        SDL_mutex *_pLock;                  // Guards opening streams
+        std::atomic<DiskStream*> _pStreams[MaxStreams];    // Cleared by the writer thread as each is finished
+        std::atomic<bool> _fStopping;
+    };
+}
+}
@@ -0,0 +1,238 @@
+#pragma once
+#include "SDL.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Something that happened during a tick, besides the actors moving
+    enum class FactEvent : Uint8
+    {
+        PowerPellet = 0,        // A player ate one, the actor is the player
+        Caught,                 // A ghost caught a player (stress mode only), the actor and cell are the player's
+        LevelComplete,          // The last pellet went, the actor is player 1
+        PelletEaten,            // A player ate a small one, the actor is the player
+        Count
+    };
+
+    // Per tick facts about many games, stored by column so a question about one thing (say the ghosts'
+    // modes) only reads that thing.  The games are grouped into segments, each whole games, and within
+    // a segment each column is one contiguous array, in the order below.  Everything is little endian,
+    // and every column (and segment) starts on a 64 byte boundary:
+    //
+    //   Games:   ticks Uint32, events Uint32, players Uint16, ghosts Uint16, flags Uint8 (1 = stress)
+    //   Ticks:   pellets left Uint8, level Uint16 (levels completed so far in the game)
+    //   Actors:  cell Uint16, mode Uint8, (players + ghosts) rows a tick, players first
+    //   Events:  tick Uint32 (in its game), kind Uint8 (FactEvent), actor Uint16, cell Uint16
+    //
+    // A cell is (row * mapCols) + col, NoCell while the actor is off the map.  A ghost's mode is its
+    // ActorStore mode, with ModeScattering or'd in while it's scattering.  The segments are followed by
+    // a FactSegmentEntry for each, and FactFileHeader at the start of the file says where they are
+    struct FactFileHeader
+    {
+        char magic[4];                  // "PMCF", written last so a file that was never finished can't be read
+        Uint32 version;
+        Uint16 mapRows;
+        Uint16 mapCols;
+        Uint32 segmentCount;
+        Uint64 directoryOffset;         // The FactSegmentEntry array
+        Uint64 cGames;
+        Uint64 cTicks;
+        Uint64 cEvents;
+    };
+
+    struct FactSegmentEntry
+    {
+        Uint64 offset;                  // From the start of the file
+        Uint32 firstGame;               // Games are numbered in the order they were added
+        Uint32 cGames;
+        Uint32 cTicks;
+        Uint32 cEvents;
+        Uint64 cActorRows;
+    };
+
+    // One segment's columns, pointing into the mapping
+    struct FactSegment
+    {
+        Uint32 firstGame;
+        Uint32 cGames;
+        Uint32 cTicks;
+        Uint32 cEvents;
+        Uint64 cActorRows;
+        const Uint32 *pGameTicks;
+        const Uint32 *pGameEvents;
+        const Uint16 *pGamePlayers;
+        const Uint16 *pGameGhosts;
+        const Uint8 *pGameFlags;
+        const Uint8 *pPelletsLeft;
+        const Uint16 *pLevel;
+        const Uint16 *pActorCell;
+        const Uint8 *pActorMode;
+        const Uint32 *pEventTick;
+        const Uint8 *pEventKind;
+        const Uint16 *pEventActor;
+        const Uint16 *pEventCell;
+    };
+
+    // A column being filled by the FactWriter, doubles as it goes
+    template <typename T>
+    class FactColumn
+    {
+    public:
+        FactColumn() : _pValues(nullptr), _cValues(0), _cCapacity(0)
+        {
+        }
+
+        ~FactColumn()
+        {
+            delete[] _pValues;
+        }
+
+        void Add(T value)
+        {
+            if (_cValues == _cCapacity)
+            {
+                Grow();
+            }
+            _pValues[_cValues++] = value;
+        }
+
+        const T* Values() { return _pValues; }
+        Uint64 Count() { return _cValues; }
+        void Clear() { _cValues = 0; }
+
+    private:
+        void Grow()
+        {
+            _cCapacity = (_cCapacity == 0) ? 4096 : _cCapacity * 2;
+            T *pValues = new T[_cCapacity];
+            if (_cValues > 0)
+            {
+                SDL_memcpy(pValues, _pValues, static_cast<size_t>(_cValues * sizeof(T)));
+            }
+            delete[] _pValues;
+            _pValues = pValues;
+        }
+
+        T *_pValues;
+        Uint64 _cValues;
+        Uint64 _cCapacity;
+    };
+
+    // Builds a fact file, one game after another.  The GameHarness fills in each tick (see
+    // GameHarness::SetFactWriter()) between BeginGame() and EndGame(): any events first, then the
+    // actors in ActorId order, then EndTick().  A segment is written out at the end of the first game
+    // to take it past SegmentTicks, so only that much is held in memory (or one game, if it's longer)
+    class FactWriter
+    {
+    public:
+        static const Uint32 SegmentTicks = 1 << 18;
+
+        FactWriter();
+        ~FactWriter();
+
+        bool Open(const char *szFileName, Uint16 mapRows, Uint16 mapCols);
+        // Writes the last segment, the directory and the header.  False if any of the file couldn't be written
+        bool Close();
+        bool IsOpen() { return _pFile != nullptr; }
+
+        void BeginGame(Uint16 cPlayers, Uint16 cGhosts, bool fStress);
+        void EndGame();
+        void AddEvent(FactEvent event, Uint16 actor, Uint16 row, Uint16 col);
+        void AddActor(Uint16 row, Uint16 col, Uint8 mode);
+        void EndTick(Uint16 cPelletsLeft, Uint16 level);
+
+        Uint64 GameCount() { return _cGames; }
+        Uint64 TickCount() { return _cTicks; }
+
+    private:
+        Uint16 Cell(Uint16 row, Uint16 col);
+        void WriteSegment();
+        template <typename T>
+        void WriteColumn(FactColumn<T> &column);
+        void Write(const void *pData, size_t cb);
+
+        SDL_RWops *_pFile;
+        const char *_szFileName;            // Not owned
+        bool _fFailed;                      // A write failed, Close() reports it
+        Uint64 _offset;                     // Bytes written so far
+        Uint16 _mapRows;
+        Uint16 _mapCols;
+        bool _fInGame;
+        Uint32 _cGameTicks;                 // The game being added
+        Uint32 _cGameEvents;
+        Uint32 _cSegmentGames;              // The segment being filled
+        Uint32 _firstSegmentGame;
+        Uint64 _cGames;                     // File totals
+        Uint64 _cTicks;
+        Uint64 _cEvents;
+        FactSegmentEntry *_pSegments;       // Written so far, grows like a FactColumn
+        Uint32 _cSegments;
+        Uint32 _cSegmentCapacity;
+
+        FactColumn<Uint32> _gameTicks;
+        FactColumn<Uint32> _gameEvents;
+        FactColumn<Uint16> _gamePlayers;
+        FactColumn<Uint16> _gameGhosts;
+        FactColumn<Uint8> _gameFlags;
+        FactColumn<Uint8> _pelletsLeft;
+        FactColumn<Uint16> _level;
+        FactColumn<Uint16> _actorCell;
+        FactColumn<Uint8> _actorMode;
+        FactColumn<Uint32> _eventTick;
+        FactColumn<Uint8> _eventKind;
+        FactColumn<Uint16> _eventActor;
+        FactColumn<Uint16> _eventCell;
+    };
+
+    // A fact file mapped read only, so a query only pages in the columns it reads.  Scan() runs a
+    // query over every segment on several threads: each thread takes the next segment nobody has
+    // started yet and folds it into its own partial result, the caller combines the partials after
+    class FactStore
+    {
+    public:
+        static const Uint32 Version = 1;
+        static const Uint16 NoCell = 0xFFFF;
+        static const Uint8 ModeScattering = 0x80;
+        static const Uint8 FlagStress = 1;
+
+        // Called with the segment and the scanning thread's own pContext
+        typedef void (*ScanFunction)(const FactStore &store, const FactSegment &segment, void *pContext);
+
+        FactStore();
+        ~FactStore();
+
+        // Maps the file and checks that it's whole, prints why and returns false if not
+        bool Open(const char *szFileName);
+        void Close();
+
+        // ppContexts has one entry per thread, cThreads of 1 scans on the calling thread
+        void Scan(Uint32 cThreads, ScanFunction pfnScan, void **ppContexts) const;
+
+        Uint32 SegmentCount() const { return _cSegments; }
+        const FactSegment& Segment(Uint32 index) const { return _pSegments[index]; }
+        Uint16 MapRows() const { return _pHeader->mapRows; }
+        Uint16 MapCols() const { return _pHeader->mapCols; }
+        Uint64 GameCount() const { return _pHeader->cGames; }
+        Uint64 TickCount() const { return _pHeader->cTicks; }
+        Uint64 EventCount() const { return _pHeader->cEvents; }
+        Uint64 ActorRowCount() const { return _cActorRows; }
+        Uint16 MaxActors() const { return _maxActors; }       // The most players + ghosts of any game
+
+    private:
+        struct ScanThread;
+        static int ScanThreadMain(void *pData);
+
+        const FactFileHeader *_pHeader;     // The start of the mapping
+        size_t _cbMapping;
+        FactSegment *_pSegments;
+        Uint32 _cSegments;
+        Uint64 _cActorRows;
+        Uint16 _maxActors;
+#ifdef _WIN32
+        void *_hFile;
+        void *_hMapping;
+#endif
+    };
+}
+}
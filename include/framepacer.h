@@ -0,0 +1,81 @@
+#pragma once
+#include "SDL.h"
+#include "gameoptions.h"
+#include "profiler.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Holds the simulation to its rate.  FramePacing::Delay is the original SDL_Delay() of whatever's left of
+    // Constants::TicksPerFrame, whole milliseconds of SDL_GetTicks(), so 16ms frames and ~62.5Hz.  The others
+    // keep exact Constants::FramesPerSecond deadlines on the performance counter: Precise sleeps most of the
+    // way to each one and spins the rest, Vsync leaves the waiting to SDL_RenderPresent() and works out how
+    // many steps the time since the last call is worth (a fixed timestep, so the game runs at the same
+    // speed whatever the display's refresh rate).  One thread, whichever runs the simulation
+    class FramePacer
+    {
+    public:
+        static const Uint32 MaxCatchUpSteps = 4;    // Vsync, more time than this behind is dropped rather than run
+
+        FramePacer();
+
+        void SetPacing(FramePacing pacing) { _pacing = pacing; }
+        FramePacing Pacing() { return _pacing; }
+        // The first step is due now
+        void Start();
+        // Waits for the next step to be due and returns how many are (1, unless Vsync fell behind)
+        Uint32 WaitForStep();
+        // How long until the next step is due, for waiting on events in the meantime
+        Uint32 MsUntilDue();
+
+        Uint32 LateSteps() { return _cLateSteps; }          // Deadlines already past by a whole step when reached
+        Uint32 DroppedSteps() { return _cDroppedSteps; }    // Vsync, more than MaxCatchUpSteps behind
+
+    private:
+        void SleepUntil(Uint64 deadline);
+
+        FramePacing _pacing;
+        Uint64 _frequency;
+        Uint64 _period;                     // Performance counter ticks per step
+        Uint64 _spinTicks;                  // The last part of a wait, spun rather than slept
+        Uint64 _nextDue;
+        Uint32 _frameStartTicks;            // Delay, SDL_GetTicks() when the last wait ended
+        Uint32 _cLateSteps;
+        Uint32 _cDroppedSteps;
+    };
+
+    // Time from one present to the next, bucketed so the odd long frame (a hitch) stands out from the steady
+    // ones, even when it's a handful among thousands.  Render side
+    class FrameTimeHistogram
+    {
+    public:
+        static const Uint32 Buckets = 64;
+        static const int BucketsPerMs = 2;          // So up to 32ms, anything longer lands in the last one
+
+        FrameTimeHistogram();
+
+        // A frame was presented at counter (SDL_GetPerformanceCounter() time)
+        void AddPresent(Uint64 counter);
+        // Nothing was presented for a while on purpose (a static screen), the next present doesn't count
+        void Break() { _lastCounter = 0; }
+
+        // Percentiles, the longest and the hitches (half as long again as targetMs, or more), for the exit report
+        void PrintSummary(double targetMs);
+#ifdef ENABLE_PROFILER
+        // The histogram as bars, heights on a log scale so single hitches show, in a panel OverlayHeight() tall
+        void RenderOverlay(SDL_Renderer *pSDLRenderer, int yTop, double targetMs);
+        static int OverlayHeight();
+#endif
+
+    private:
+        double Percentile(Uint32 percent);
+
+        Uint32 _histogram[Buckets];
+        Uint32 _cFrames;
+        Uint64 _lastCounter;
+        double _maxMs;
+        double _msPerCounter;
+    };
+}
+}
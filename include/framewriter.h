@@ -0,0 +1,72 @@
+#pragma once
+#include "SDL.h"
+#include <stdio.h>
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Streams rendered frames out to disk for making videos of simulated games, no display needed.  The
+    // game thread only copies each frame into a free buffer, a writer thread converts and writes them.
+    // Unlike the TraceRecorder nothing is dropped, a video with holes in it is no use, so if every buffer
+    // is waiting to be written AddFrame() waits for one (and counts the stall)
+    //
+    // The format comes from the file name:
+    //   name.y4m        one YUV4MPEG2 file, 4:2:0 BT.601 (ffmpeg -i name.y4m name.mp4)
+    //   name%05d.png    a PNG per frame, the frame number goes into the printf style pattern
+    class FrameWriter
+    {
+    public:
+        FrameWriter();
+        ~FrameWriter();
+
+        // Creates the file (or checks the pattern) and starts the writer thread.  Frames are width x height
+        bool Open(const char *szFileName, int width, int height, Uint32 framesPerSecond);
+        // Writes everything queued so far and stops the writer thread
+        void Close();
+        bool IsOpen() { return _pThread != nullptr; }
+
+        // Copies the frame and queues it.  pSurface is 32 bit ARGB, the size given to Open()
+        void AddFrame(SDL_Surface *pSurface);
+
+        Uint32 FramesWritten() { return _cFramesWritten; }
+        Uint32 Stalls() { return _cStalls; }
+        // A write failed, up to and including the final flush in Close()
+        bool Failed() { return _fFailed; }
+
+    private:
+        enum class Format
+        {
+            Y4m,
+            PngSequence
+        };
+
+        static const Uint32 BufferCount = 4;
+
+        static int WriterThread(void *pData);
+        bool WriteFrame(SDL_Surface *pFrame);
+        bool WriteY4mFrame(SDL_Surface *pFrame);
+
+        Format _format;
+        const char *_szFileName;        // Not owned, the PNG pattern is used for every frame
+        FILE *_pFile;                   // Y4M only
+        int _width;
+        int _height;
+        SDL_Thread *_pThread;
+        SDL_mutex *_pLock;              // Guards the queues, _fClosing and _fFailed
+        SDL_cond *_pPending;            // Signalled when a frame is queued (or we're closing)
+        SDL_cond *_pFreed;              // Signalled when the writer is done with a frame
+        SDL_Surface *_pFrames[BufferCount];
+        SDL_Surface *_pQueue[BufferCount];  // Frames waiting for the writer, oldest first
+        Uint32 _cQueued;
+        SDL_Surface *_pFree[BufferCount];
+        Uint32 _cFree;
+        bool _fClosing;
+        bool _fFailed;                  // A write failed, the rest of the frames are thrown away
+        Uint8 *_pPlanes;                // Writer thread only, Y then U then V for a Y4M frame
+        Uint32 _cFramesQueued;
+        Uint32 _cFramesWritten;         // Writer thread only until Close()
+        Uint32 _cStalls;
+    };
+}
+}
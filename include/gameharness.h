@@ -1,5 +1,6 @@
 #pragma once
 #include <stdio.h>
+#include <atomic>
 #include "constants.h"
 #include "utils.h"
 #include "player.h"
@@ -7,6 +8,24 @@
 #include "pinky.h"
 #include "inky.h"
 #include "clyde.h"
+#include "occupancygrid.h"
+#include "arena.h"
+#include "collision.h"
+#include "gameoptions.h"
+#include "profiler.h"
+#include "tracerecorder.h"
+#include "replay.h"
+#include "factstore.h"
+#include "heatmap.h"
+#include "inputqueue.h"
+#include "alloctracker.h"
+#include "rendersnapshot.h"
+#include "rendercommands.h"
+#include "framewriter.h"
+#include "sharedexport.h"
+#include "latencyprobe.h"
+#include "framepacer.h"
+#include "triplebuffer.h"
 
 namespace XplatGameTutorial
 {
@@ -19,28 +38,100 @@ namespace PacManClone
 class GameHarness
 {
 public:
-    GameHarness() :
+    GameHarness() : GameHarness(GameOptions())
+    {
+    }
+
+    explicit GameHarness(const GameOptions &options) :
+        _options(options),
         _fInitialized(false),
+        _fHeadless(false),
+        _fKeyboardPlayer(false),
+        _fPowerPelletEaten(false),
         _state(GameState::LoadingResources),
         _pSDLRenderer(nullptr),
         _pSDLWindow(nullptr),
+        _pSDLSurface(nullptr),
         _pTilesTexture(nullptr),
         _pSpriteTexture(nullptr),
+        _pTitleTexture(nullptr),
+        _pAnimations(nullptr),
+        _pActorStore(nullptr),
         _pMaze(nullptr),
-        _pPlayer(nullptr),
-        _pBlinky(nullptr),
-        _pPinky(nullptr),
-        _pInky(nullptr),
-        _pClyde(nullptr)
+        _pMazeView(nullptr),
+        _levelMark(0),
+        _pOccupancy(nullptr),
+        _cPlayers(0),
+        _ppPlayers(nullptr),
+        _cGhosts(0),
+        _ppGhosts(nullptr),
+        _pGhostTypes(nullptr),
+        _pWorldState(nullptr),
+        _pFacts(nullptr),
+        _cPelletsEaten(0),
+        _cGhostCatches(0),
+        _cLevelsCompleted(0),
+        _cPowerPelletsEaten(0),
+        _autopilotSeed(1),
+        _cSimFrames(0),
+        _replayTick(0),
+        _fReplayPaused(false),
+        _fReplayKeyframes(false),
+        _fScrubbing(false),
+        _cSeeks(0),
+        _cSeekTicks(0),
+        _seekCounter(0),
+        _tileBlueMod(255),
+        _sceneVersion(1),
+        _staticStartTicks(0),
+        _staticStartCpu(0.0),
+        _staticTicks(0),
+        _staticCpuSeconds(0.0),
+        _fClipSet(false),
+        _fCaptureRequested(false),
+        _fFrameCaptured(false),
+        _pCaptureStream(nullptr),
+        _presentedScene(0),
+        _fRepaint(false),
+        _heatmapLayer(HeatmapLayer::Count),
+        _cFramesNotRedrawn(0),
+        _presentedTurn(0),
+        _targetFrameMs(Constants::TicksPerFrame),
+        _wakeEventType(static_cast<Uint32>(-1)),
+        _pInputSignal(nullptr),
+        _fQuitRequested(false),
+        _fSimulationDone(false),
+        _fRenderIdle(false),
+        _fSimulationIdle(false)
+#ifdef ENABLE_PROFILER
+        , _pPresentProfiler(&_profiler)
+#endif
     {
-        for (size_t i = 0; i < SDL_arraysize(_pGhosts); i++)
-        {
-            _pGhosts[i] = nullptr;
-        }
+        SDL_zero(_turnMark);
     }
 
-    SDL_bool Initialize();  // Needs to be called successfully before Run()
-    void Run();             // Main loop
+    SDL_bool Initialize();          // Needs to be called successfully before Run()
+    SDL_bool InitializeHeadless();  // Or this one before RunHeadless(), renders to memory with no window
+    void Run();                     // Main loop, the simulation gets its own thread unless --single-thread
+    // Runs the simulation as fast as it will go, no rendering or pacing.  Player 1 follows the replay if
+    // there is one, otherwise everyone is on autopilot.  Returns StateChecksum() after the last tick.
+    // With a pVideo (and GameOptions::szVideoFile set) each tick is drawn offscreen and handed to it,
+    // and exported too with GameOptions::szExportName
+    Uint32 RunHeadless(Uint32 cTicks, const Replay *pReplay = nullptr, FrameWriter *pVideo = nullptr);
+    // Plays a recording back in the window, with pause, single steps and seeking (the keys are listed
+    // in PumpReplayEvents()).  The roster has to be the replay's
+    void RunReplay(const Replay &replay);
+    // Each tick from now on adds its facts to the game pFacts has begun (see FactWriter), nullptr stops it
+    void SetFactWriter(FactWriter *pFacts) { _pFacts = pFacts; }
+
+    Uint16 PlayerCount() { return _cPlayers; }
+    Uint16 GhostCount() { return _cGhosts; }
+    Uint32 GhostCatches() { return _cGhostCatches; }
+    Uint32 LevelsCompleted() { return _cLevelsCompleted; }
+    Uint32 PowerPelletsEaten() { return _cPowerPelletsEaten; }
+#ifdef ENABLE_PROFILER
+    const FrameProfiler& Profiler() { return _profiler; }
+#endif
 
 private:
     enum class GameState
@@ -55,15 +146,57 @@ private:
         Exiting                 // App is closing
     };
 
+    enum class GhostType
+    {
+        Blinky = 0,
+        Pinky,
+        Inky,
+        Clyde
+    };
+
     // Methods
+    static const char* GameStateName(GameState state);
+    static bool IsStaticState(GameState state);
+    SDL_bool LoadResources();
     void Cleanup();
+    void RunLockstep();
+    void RunThreaded();
+    static int SimulationThread(void *pData);
+    bool PumpEvents();
+    bool StepGame();
+    void TrackStaticScreens(bool fWasStatic, bool fIsStatic);
+    void WakeSimulation();
     void InitializeSprites();
+    void QueueInput(const SDL_KeyboardEvent &keyEvent);
+    void DrainInput();
     bool ProcessInput(Direction *pInputDirection);
-    Uint16 HandlePelletCollision();
+    Direction AutopilotInput();
+    void HandleTileEvents();
+    Uint16 HandlePelletCollision(ActorId id, Uint16 row, Uint16 col);
     GameState HandleGhostCollision();
-    void Render();
-    void RenderAITargets(size_t ghostIndex);
+    SweptPoint GetSweptPoint(Sprite *pSprite);
+    GameState UpdateSimulation(Direction inputDirection);
+    Uint32 StateChecksum();
+    size_t WorldStateBytes();
+    void SaveWorldState(Uint8 *pState);
+    void RestoreWorldState(const Uint8 *pState);
+    void RecordFacts();
+    bool PumpReplayEvents(const Replay &replay);
+    void StepReplay(const Replay &replay);
+    void SeekReplay(const Replay &replay, Uint32 tick);
+    void RenderTimeline(const Replay &replay);
+    SDL_Rect TimelineRect();
+    void CaptureSnapshot();
+    bool NeedsRender(const RenderSnapshot &snapshot);
+    void Render(const RenderSnapshot &snapshot);
+    void RenderAITarget(const TargetDraw &target);
+    void Present(const RenderSnapshot &snapshot);
+    void ExportFrame(const RenderSnapshot &snapshot);
+    void CycleHeatmap();
+    void RenderHeatmap();
     void InitLevel();
+    static SDL_Rect MazeTextureRect() { return { 0, 0, Constants::TileTextureWidth, Constants::TileTextureHeight }; }
+    static SDL_Rect MazeTileRect() { return { 0, 0, Constants::TileWidth, Constants::TileHeight }; }
     
     
     // GameState Handlers
@@ -73,20 +206,89 @@ private:
     GameState OnLevelComplete();
     
     // Members
+    GameOptions _options;               // Command line settings
     bool _fInitialized;                 // Tracks if we've started SDL
+    bool _fHeadless;                    // No window, nothing to render to the screen
+    bool _fKeyboardPlayer;              // Player 1 follows the input (keyboard or replay), otherwise everyone is on autopilot
+    bool _fPowerPelletEaten;            // Ghosts are told at the start of the next frame, before anything moves
     GameState _state;                   // current GameState
     SDL_Renderer *_pSDLRenderer;        // SDL renderer object
     SDL_Window *_pSDLWindow;            // SDL window object
+    SDL_Surface *_pSDLSurface;          // Render target when headless (instead of the window)
     TextureWrapper *_pTilesTexture;     // Texture that holds the maze tiles
     TextureWrapper *_pSpriteTexture;    // Texture that holds the sprite frames
     TextureWrapper *_pTitleTexture;     // Texture that holds the title screen
+    AnimationRegistry *_pAnimations;    // Frames and animation clips shared by the sprites
+    ActorStore *_pActorStore;           // Moving state of the player and ghosts
     Maze *_pMaze;                       // Maze - playing area
-    Player *_pPlayer;                   // The player sprite PacManClone
-    Blinky *_pBlinky;                   // Blinky
-    Pinky  *_pPinky;                    // Pinky
-    Inky  *_pInky;                      // Inky
-    Clyde *_pClyde;                     // Clyde
-    Ghost* _pGhosts[4];                 // Stick our ghosts in here for easy access to common code
+    TiledMap *_pMazeView;               // The render side's own copy of the maze layout, drawn with the snapshot's tiles
+    Arena _arena;                       // Session data (the roster arrays, ActorStore, ...), then the level's (the maze map)
+    size_t _levelMark;                  // Where the level's part of _arena starts
+    OccupancyGrid *_pOccupancy;         // Ghosts bucketed by tile for the collision checks
+    Uint16 _cPlayers;                   // Roster sizes, 1 player and 4 ghosts unless in stress mode
+    Player **_ppPlayers;                // The player sprites PacManClone, the first is on the keyboard
+    Uint16 _cGhosts;
+    Ghost **_ppGhosts;                  // Stick our ghosts in here for easy access to common code
+    GhostType *_pGhostTypes;            // Which ghost each entry of _ppGhosts is
+    Uint8 *_pWorldState;                // SaveWorldState() of the recorder's keyframe, RunHeadless()'s check or the viewer's start
+    FactWriter *_pFacts;                // Not owned, nullptr unless building a fact file
+    Uint16 _cPelletsEaten;              // Pellets eaten this level
+    Uint32 _cGhostCatches;              // Times a ghost caught a player (only counted, stress mode isn't fatal)
+    Uint32 _cLevelsCompleted;           // Session totals
+    Uint32 _cPowerPelletsEaten;
+    Uint32 _autopilotSeed;              // Random state for the players that drive themselves
+    Uint32 _cSimFrames;                 // Simulation steps taken
+    Uint32 _replayTick;                 // Viewer, ticks of the replay played so far
+    bool _fReplayPaused;
+    bool _fReplayKeyframes;             // Viewer, the replay's keyframes fit this build and seeking can use them
+    bool _fScrubbing;                   // Viewer, the mouse button went down on the timeline and hasn't come up
+    Uint32 _cSeeks;                     // Viewer, for the report at exit
+    Uint64 _cSeekTicks;                 // Ticks simulated to get to where a seek was going
+    Uint64 _seekCounter;                // SDL_GetPerformanceCounter() ticks it all took
+    InputState _input;                  // Player 1's keys and the turn it's waiting to take
+    FramePacer _pacer;                  // Holds the steps to Constants::FramesPerSecond
+    TurnMark _turnMark;                 // Player 1's latest turn on a key press
+    Uint8 _tileBlueMod;                 // Color mod for the maze tiles, the level complete flash
+    Uint32 _sceneVersion;               // Bumped every step that might change the picture, see RenderSnapshot::sceneVersion
+    Uint32 _staticStartTicks;           // When the static screen that's up started
+    double _staticStartCpu;             // ProcessCpuSeconds() then
+    Uint32 _staticTicks;                // Time on the static screens so far, and the CPU it took, reported at exit
+    double _staticCpuSeconds;
+
+    // Between the simulation and the render side.  Everything above belongs to the simulation once its thread
+    // is running, the main thread only pumps events, samples the keyboard and draws the published snapshots
+    TripleBuffer<RenderSnapshot> _snapshots;
+    bool _fClipSet;                     // Render side, the clip rect only needs setting once
+    RenderCommandList _renderCommands;  // Render side, the frame being drawn
+    SDL_Texture *_pRenderTextures[static_cast<int>(RenderTexture::Count)];  // What each RenderTexture is
+    bool _fCaptureRequested;            // F12 with --capture-frame, the next frame drawn is saved
+    bool _fFrameCaptured;
+    DiskStream *_pCaptureStream;        // Render side, only open with --capture-frame, each capture is added to the end
+    SharedExport _export;               // Render side, only open with --export
+    Uint32 _presentedScene;             // Render side, sceneVersion of what's on screen (0 before the first frame)
+    bool _fRepaint;                     // Render side, the window was uncovered and needs drawing even if nothing changed
+    Heatmap _heatmap;                   // Render side, only built with --heatmap
+    HeatmapLayer _heatmapLayer;         // Render side, which one is over the maze, Count while none is
+    Uint32 _cFramesNotRedrawn;          // Render side, snapshots of a static screen that was already up
+    DiskWriter _diskWriter;             // Writes the latency CSV, the replay and frame captures, so neither loop waits on the disk
+    LatencyProbe _latency;              // Render side, input to photon time of the turns
+    Uint32 _presentedTurn;              // Render side, TurnMark::id of the latest turn presented
+    FrameTimeHistogram _frameTimes;     // Render side, present to present
+    double _targetFrameMs;              // What that should be
+    Uint32 _wakeEventType;              // Pushed by the simulation when the main thread is waiting on a static screen
+    SDL_sem *_pInputSignal;             // Posted by the main thread when the simulation is waiting on the title screen
+    InputQueue _inputQueue;             // Key events, from the main thread's event pump to ProcessInput()
+    std::atomic<bool> _fQuitRequested;  // Window closed, set by the main thread
+    std::atomic<bool> _fSimulationDone; // The state machine has exited, set by the simulation thread
+    std::atomic<bool> _fRenderIdle;     // The main thread is waiting for a change, a published one needs to wake it
+    std::atomic<bool> _fSimulationIdle; // The simulation is waiting for input, new input needs to wake it
+#ifdef ENABLE_PROFILER
+    FrameProfiler _profiler;            // Where each frame's time goes (each simulation step when threaded), F3 shows it
+    FrameProfiler _presentProfiler;     // The main thread's loop when threaded, each presented frame
+    FrameProfiler *_pPresentProfiler;   // Whichever of the two the main thread's phases go to
+    TraceRecorder _trace;               // Timeline of the session, only open with --trace
+#endif
+    ReplayRecorder _recorder;           // Only open with --record
 };
 }
 }
\ No newline at end of file
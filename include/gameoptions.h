@@ -0,0 +1,62 @@
+#pragma once
+#include "SDL.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // How the frame rate is held, see FramePacer
+    enum class FramePacing
+    {
+        Delay = 0,      // SDL_Delay() the rest of the 16ms
+        Precise,        // Sleep then spin to exact 60Hz deadlines
+        Vsync           // The present waits for the display, the simulation steps on a fixed timestep
+    };
+
+    // Settings from the command line.  With no arguments we get the normal game
+    struct GameOptions
+    {
+        GameOptions() :
+            cPlayers(1),
+            cGhosts(4),
+            fStress(false),
+            fStressBenchmark(false),
+            cBenchmarkTicks(2000),
+            szTraceFile(nullptr),
+            szRecordFile(nullptr),
+            fSingleThread(false),
+            szCaptureFile(nullptr),
+            szVideoFile(nullptr),
+            szReplayFile(nullptr),
+            cVideoTicks(0),
+            szExportName(nullptr),
+            fIdleWait(true),
+            szLatencyFile(nullptr),
+            szHeatmapFile(nullptr),
+            pacing(FramePacing::Delay)
+        {
+        }
+
+        Uint16 cPlayers;            // Only player 1 is on the keyboard, the rest drive themselves
+        Uint16 cGhosts;             // Cycles through the ghost types enabled in gameharness.cpp
+        bool fStress;               // Stress mode: any number of players/ghosts, ghost catches are counted, not fatal
+        bool fStressBenchmark;      // Run the headless ticks/second vs actor count sweep instead of the game
+        Uint32 cBenchmarkTicks;     // Ticks to run for each step of the sweep
+        const char *szTraceFile;    // Chrome trace JSON of the session goes here (profiling builds only), points into argv
+        const char *szRecordFile;   // Replay of the session goes here, points into argv
+        bool fSingleThread;         // Simulate and present on the one thread, frame by frame in lockstep
+        const char *szCaptureFile;  // A frame's render commands go here (see RenderCommandList), points into argv
+        const char *szVideoFile;    // Render a simulated game to this video instead, headless (see FrameWriter), points into argv
+        const char *szReplayFile;   // Recording to play back in the window, or for player 1 of the video to follow, points into argv
+        Uint32 cVideoTicks;         // Length of the video, 0 for the whole replay (or a minute without one)
+        const char *szExportName;   // Each frame and the game state go to shared memory by this name (see SharedExport), points into argv
+        bool fIdleWait;             // Static screens (the title, the wait before a level) are drawn once and then wait for events
+        const char *szLatencyFile;  // Input to photon time of each turn goes here as CSV (see LatencyProbe), points into argv
+        const char *szHeatmapFile;  // Fact file to build heatmaps from for the overlay on the maze (see Heatmap), points into argv
+        FramePacing pacing;
+    };
+
+    // Fills in the options from argv, returns false (after printing the usage) if they don't make sense
+    bool ParseGameOptions(int argc, char* argv[], GameOptions *pOptions);
+}
+}
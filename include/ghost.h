@@ -16,13 +16,10 @@ namespace PacManClone
     class Ghost : public Sprite
     {
     public:
-        Ghost(TextureWrapper *pTextureWrapper, Uint16 cxFrame, Uint16 cyFrame, Uint16 cFramesTotal, Uint16 cAnimationsTotal);
+        Ghost(TextureWrapper *pTextureWrapper, ActorStore *pActorStore, Uint16 cxFrame, Uint16 cyFrame, Uint16 cFramesTotal, Uint16 cAnimationsTotal);
 
         virtual ~Ghost()
         {
-            SafeDelete<Decision>(_pPrevDecision);
-            SafeDelete<Decision>(_pCurrentDecision);
-            SafeDelete<Decision>(_pNextDecision);
         }
 
         // "Interface" for Ghosts to implement
@@ -38,10 +35,21 @@ namespace PacManClone
         Uint16 TargetRow() { return _targetRow; }
         Uint16 TargetCol() { return _targetCol; }
         SDL_Color TargetColor() { return _targetColor; }
+        bool IsScattering() { return _fScatter; }
+
+        // What the ghost keeps outside the ActorStore (its timers, scatter and decisions), for replay keyframes
+        static size_t StateBytes();
+        void SaveState(Uint8 *pState);
+        void RestoreState(const Uint8 *pState);
 
     protected:
+        // Held by value, a ghost makes one of these for every tile it enters
         struct Decision
         {
+            Decision() : Decision(0, 0, Direction::None)
+            {
+            }
+
             Decision(Uint16 r, Uint16 c, Direction newDirection) :
                 row(r),
                 col(c),
@@ -68,18 +76,22 @@ namespace PacManClone
             ExitingPen,
         };
 
-        void InitializeCommon();
+        Mode GetMode() { return static_cast<Mode>(ActorMode()); }
+        void SetMode(Mode mode);
+
+        void InitializeCommon(AnimationRegistry::FrameTableId frameTableId, Uint16 yTexture);
         Direction ShortestDirectionToTarget(Uint16 originRow, Uint16 originCol, Uint16 targetRow, Uint16 targetCol, Maze *pMaze);
         Direction GetNextDirection(Uint16 r, Uint16 c, Maze *pMaze);
-        Decision* GetNextDecision(Player *pPlayer, Maze* pMaze);
+        Decision GetNextDecision(Player *pPlayer, Maze* pMaze);
+        void ResetDecisions(Uint16 row, Uint16 col);
         bool IsGhostWarpingOut(Maze* pMaze);
         bool IsGhostPenned()
         {
-            return (_currentCol > 10 && _currentCol < 17 && _currentRow > 15 && _currentRow < 18);
+            return (CurrentCol() > 10 && CurrentCol() < 17 && CurrentRow() > 15 && CurrentRow() < 18);
         }
         
         void Stop() { SetVelocity(0.0, 0.0); }
-        bool IsStopped() { return (DX() == 0.0 && DY() == 0.0); }
+        bool IsStopped() { return (DX() == 0 && DY() == 0); }
         void SetPenTimerMax(Uint32 max) { _penTimerMax = max; }
         void OnExitingPen(Player* pPlayer, Maze* pMaze);
         void OnWarpingOut(Player* pPlayer, Maze* pMaze);
@@ -91,19 +103,17 @@ namespace PacManClone
 
         StateTimer _penTimer;           // Timer used to exit initial pen area
         StateTimer _scatterTimer;       // Timer used to exit scatter
-        Uint16 _currentRow;             // Current cell location
-        Uint16 _currentCol;
         Uint16 _scatterRow;             // Target during scatter mode
         Uint16 _scatterCol;
         Uint16 _targetRow;
         Uint16 _targetCol;
         SDL_Color _targetColor;
         Uint32 _penTimerMax;
-        Mode _mode;                     // Chase, scatter, etc
         bool _fScatter;                 // Scattering
-        Decision *_pNextDecision;       // Decision for the coming cell
-        Decision *_pCurrentDecision;    // Decision for our current cell
-        Decision *_pPrevDecision;       // Decision last cell (for reversing easily)
+        bool _fHasNextDecision;         // _nextDecision has been made for the coming cell
+        Decision _nextDecision;         // Decision for the coming cell
+        Decision _currentDecision;      // Decision for our current cell
+        Decision _prevDecision;         // Decision last cell (for reversing easily)
     };
 }
 }
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+#include "SDL.h"
+#include "factstore.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // What a heatmap shows on each tile
+    enum class HeatmapLayer : Uint8
+    {
+        Players = 0,        // Ticks the players spent on it
+        Ghosts,             // Ticks the ghosts spent on it
+        PelletTimes,        // How far into the level its pellet was eaten, on average
+        Collisions,         // Players caught on it (only stress mode games have any)
+        Count
+    };
+
+    // Lower case, as factquery's --layer takes them
+    const char* HeatmapLayerName(HeatmapLayer layer);
+
+    // Per tile totals over every game in a fact file, for level design.  Build() scans the file on several
+    // threads (see FactStore::Scan()), each adding into counts of its own so no two ever touch the same
+    // counter, and adds those up once they're all done.  Each layer then gets a level from 0 to 1 per tile,
+    // log scaled for the counts since a few tiles see far more than the rest, and a color from that for
+    // TiledMap::RenderOverlay()
+    class Heatmap
+    {
+    public:
+        Heatmap();
+        ~Heatmap();
+
+        // Replaces anything built before
+        void Build(const FactStore &store, Uint32 cThreads);
+        bool IsBuilt() { return _pColors != nullptr; }
+
+        Uint16 Rows() { return _cRows; }
+        Uint16 Cols() { return _cCols; }
+        // Ticks for Players and Ghosts, pellets eaten for PelletTimes, catches for Collisions
+        Uint64 Count(HeatmapLayer layer, Uint16 row, Uint16 col) { return _pCounts[LayerCell(layer, row, col)]; }
+        // 0 for the coolest tile to 1 for the hottest, less than 0 where there's nothing to show
+        float Level(HeatmapLayer layer, Uint16 row, Uint16 col) { return _pLevels[LayerCell(layer, row, col)]; }
+        // Rows * cols of them, transparent where there's nothing to show
+        const SDL_Color* Colors(HeatmapLayer layer) { return _pColors + (static_cast<Uint32>(layer) * _cCells); }
+        // One line saying what the layer's hottest color stands for, in the profiler font's characters
+        void Describe(HeatmapLayer layer, char *szText, size_t cchText);
+
+    private:
+        struct ScanCounts;
+        static void ScanSegment(const FactStore &store, const FactSegment &segment, void *pContext);
+        void SetLevels();
+        Uint32 LayerCell(HeatmapLayer layer, Uint16 row, Uint16 col) { return (static_cast<Uint32>(layer) * _cCells) + (row * _cCols) + col; }
+
+        Uint16 _cRows;
+        Uint16 _cCols;
+        Uint32 _cCells;
+        Uint64 _cGames;
+        Uint64 _cTicks;
+        Uint64 *_pCounts;                   // Each layer's cells, one after the other
+        Uint64 *_pPelletTicks;              // Per cell, ticks into the level summed over the pellets eaten there
+        Uint64 _maxCounts[static_cast<int>(HeatmapLayer::Count)];
+        double _earliestPellet;             // Mean ticks into the level of the first and last tiles to be eaten
+        double _latestPellet;
+        float *_pLevels;                    // Each layer's, laid out like _pCounts
+        SDL_Color *_pColors;
+    };
+}
+}
@@ -9,7 +9,7 @@ namespace XplatGameTutorial
         class Inky : public Ghost
         {
         public:
-            Inky(TextureWrapper* pTextureWrapper);
+            Inky(TextureWrapper* pTextureWrapper, ActorStore* pActorStore);
 
             // "Interface" for my ghosts to implement
             bool Initialize();
@@ -0,0 +1,118 @@
+#pragma once
+#include "SDL.h"
+#include <atomic>
+#include "utils.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // The keys the game plays with, the four directions match Direction
+    enum class InputKey : Uint8
+    {
+        Up = 0,
+        Down,
+        Left,
+        Right,
+        Escape,
+        Count
+    };
+
+    // A key going down or up, with SDL's timestamp of when it did (SDL_GetTicks() time)
+    struct InputEvent
+    {
+        Uint32 timestamp;
+        Uint64 counter;                     // The same on the SDL_GetPerformanceCounter() clock, for timing latency
+        InputKey key;
+        bool fDown;
+    };
+
+    // Key events on their way from the thread that pumps SDL's events to the simulation, in the order
+    // they happened.  Sampling the keyboard once a frame loses a tap that starts and ends in between, the
+    // events don't.  One writer thread and one reader thread, neither ever waits on the other
+    class InputQueue
+    {
+    public:
+        static const Uint32 Capacity = 64;     // A power of 2.  Several seconds of frantic typing
+
+        InputQueue() :
+            _head(0),
+            _tail(0),
+            _cDropped(0)
+        {
+        }
+
+        // Writer side, false (and the event is dropped) if the reader has fallen that far behind
+        bool Push(const InputEvent &event);
+        // Reader side, false once it's empty
+        bool Pop(InputEvent *pEvent);
+
+        Uint32 Dropped() { return _cDropped; }
+
+    private:
+        InputEvent _events[Capacity];
+        std::atomic<Uint32> _head;          // Next to pop, written by the reader
+        std::atomic<Uint32> _tail;          // Next to push, written by the writer
+        Uint32 _cDropped;                   // Writer thread only
+    };
+
+    // What the key events add up to for player 1, simulation side.  A direction pressed is kept as the
+    // desired turn until the player takes it, so a turn asked for a little before a corner (or a tap too
+    // short to still be down when the player gets there) isn't lost.  Otherwise the direction held is
+    // the input, as with sampling the keyboard
+    class InputState
+    {
+    public:
+        InputState()
+        {
+            Reset();
+            SDL_zero(_pressOrder);
+            _cPresses = 0;
+            _fEscape = false;
+            _cTurnsTaken = 0;
+            _cTurnsBuffered = 0;
+            _cTurnsReplaced = 0;
+            _bufferedMs = 0;
+        }
+
+        void Apply(const InputEvent &event);
+        // The direction for this tick: the desired turn, or failing that the held key pressed last
+        Direction Current();
+        // Escape was pressed since the last time this was asked, or is still down
+        bool TakeEscape();
+        // After the tick, facing is the way player 1 ended up going.  A desired turn it took is done with,
+        // returns true if there was one.  msNow is SDL_GetTicks(), like the event timestamps
+        bool OnTick(Direction facing, Uint32 msNow);
+        // Starting a level, any turn asked for before doesn't carry over (held keys still count)
+        void Reset()
+        {
+            _desiredTurn = Direction::None;
+            _desiredTimestamp = 0;
+            _desiredCounter = 0;
+            _fDesiredMissed = false;
+        }
+
+        Uint32 TurnsTaken() { return _cTurnsTaken; }
+        Uint32 TurnsBuffered() { return _cTurnsBuffered; }     // Taken on a later tick than the one the press came in on
+        Uint32 TurnsReplaced() { return _cTurnsReplaced; }     // Pressed but superseded by another before they could be taken
+        Uint32 BufferedMs() { return _bufferedMs; }            // From the press to the tick the turn was taken in ms, the buffered ones summed
+        Direction DesiredTurn() { return _desiredTurn; }
+        Uint32 DesiredTimestamp() { return _desiredTimestamp; }
+        Uint64 DesiredCounter() { return _desiredCounter; }
+        bool DesiredMissed() { return _fDesiredMissed; }
+
+    private:
+        Direction _desiredTurn;             // Pressed and not yet taken
+        Uint32 _desiredTimestamp;
+        Uint64 _desiredCounter;
+        bool _fDesiredMissed;               // The desired turn has been through a tick without being taken
+        Uint32 _pressOrder[static_cast<int>(InputKey::Count)];     // 0 while up, otherwise when it went down (in presses)
+        Uint32 _cPresses;
+        bool _fEscape;
+        Uint32 _cTurnsTaken;
+        Uint32 _cTurnsBuffered;
+        Uint32 _cTurnsReplaced;
+        Uint32 _bufferedMs;
+    };
+}
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "SDL.h"
+#include "rendersnapshot.h"
+#include "diskwriter.h"
+#include "profiler.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Input to photon latency: how long from a key going down to the SDL_RenderPresent() of the first frame
+    // showing the turn it caused, split at the simulation step that took the turn.  Each turn is a sample,
+    // the recent ones are shown in the overlay (F3), the whole session's go to a CSV (--latency-csv) and
+    // are summed up at exit.  Turns pressed before they could be taken only go to the CSV, their time is
+    // mostly the wait for the corner.  Render side only, the simulation's half arrives as a TurnMark in
+    // the snapshot.  The present is as far as we can see, the display's scan out comes on top
+    class LatencyProbe
+    {
+    public:
+        static const Uint32 HistorySamples = 128;   // For the overlay, must be a power of 2
+
+        // The three spans timed
+        enum class Span
+        {
+            InputToTick = 0,        // Waiting for a step, then the step
+            TickToPresent,          // Waiting to be drawn, drawing and presenting
+            InputToPresent,
+            Count
+        };
+
+        LatencyProbe();
+        ~LatencyProbe();
+
+        // Every sample goes to szFileName as well, written by pWriter.  szConfig describes the run, for comparing CSVs
+        bool OpenCsv(DiskWriter *pWriter, const char *szFileName, const char *szConfig);
+        void Close();
+
+        // The frame showing the turn was presented at presentCounter (SDL_GetPerformanceCounter() time)
+        void AddSample(const TurnMark &turn, Uint64 presentCounter);
+
+        Uint32 SampleCount() { return _cSamples; }      // Not counting the buffered turns
+        // Percentile of the whole session so far, to the histogram's resolution
+        double SessionPercentile(Span span, Uint32 percent);
+        // One line of the whole session's 50th/95th/99th percentiles, for the exit report
+        void PrintSummary();
+#ifdef ENABLE_PROFILER
+        // Percentiles of the recent samples in a panel OverlayHeight() tall at yTop
+        void RenderOverlay(SDL_Renderer *pSDLRenderer, int yTop);
+        static int OverlayHeight();
+#endif
+
+    private:
+        static const Uint32 HistogramBuckets = 1024;
+        static const int BucketsPerMs = 4;          // So up to 256ms, anything longer lands in the last one
+
+        double _recent[static_cast<int>(Span::Count)][HistorySamples];  // ms, a ring
+        Uint32 _histogram[static_cast<int>(Span::Count)][HistogramBuckets];
+        Uint32 _cSamples;
+        Uint32 _cBuffered;
+        DiskWriter *_pWriter;
+        DiskStream *_pCsv;
+        double _msPerCounter;
+    };
+}
+}
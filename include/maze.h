@@ -46,6 +46,34 @@ namespace PacManClone
             SetTileIndexAt(row, col, 49);
         }
 
+        // Which of the level's pellets are gone, a bit per tile, for replay keyframes
+        static size_t PelletStateBytes() { return ((Constants::MapRows * Constants::MapCols) + 7) / 8; }
+
+        void SavePellets(Uint8 *pState)
+        {
+            SDL_memset(pState, 0, PelletStateBytes());
+            for (Uint16 i = 0; i < _cRows * _cCols; i++)
+            {
+                Uint16 original = Constants::MapIndicies[i];
+                if (((original == 16) || (original == 13)) && (_pMapIndicies[i] == 49))
+                {
+                    pState[i / 8] |= static_cast<Uint8>(1 << (i % 8));
+                }
+            }
+        }
+
+        // The map has to be freshly initialized, with every pellet still there
+        void RestorePellets(const Uint8 *pState)
+        {
+            for (Uint16 i = 0; i < _cRows * _cCols; i++)
+            {
+                if ((pState[i / 8] & (1 << (i % 8))) != 0)
+                {
+                    EatPellet(i / _cCols, i % _cCols);
+                }
+            }
+        }
+
         SDL_bool IsTileSolid(Uint16 row, Uint16 col)
         {
             return (Constants::CollisionMap[
@@ -101,6 +129,7 @@ namespace PacManClone
             // No promises on whether this is solid, etc
         }
 
+        using TiledMap::Render;
         void Render(SDL_Renderer *pSDLRenderer)
         {
             TiledMap::Render(pSDLRenderer);
@@ -116,19 +145,19 @@ namespace PacManClone
             // Now based on the direction, are we ahead of or behind that center pixel?
             if (pSprite->DX() < 0)
             {
-                result = (pSprite->X() <= centerPoint.x) ? SDL_TRUE : SDL_FALSE;
+                result = (pSprite->X() <= IntToCoord(centerPoint.x)) ? SDL_TRUE : SDL_FALSE;
             }
             else if (pSprite->DX() > 0)
             {
-                result = (pSprite->X() > centerPoint.x) ? SDL_TRUE : SDL_FALSE;
+                result = (pSprite->X() > IntToCoord(centerPoint.x)) ? SDL_TRUE : SDL_FALSE;
             }
             else if (pSprite->DY() < 0)
             {
-                result = (pSprite->Y() <= centerPoint.y) ? SDL_TRUE : SDL_FALSE;
+                result = (pSprite->Y() <= IntToCoord(centerPoint.y)) ? SDL_TRUE : SDL_FALSE;
             }
             else if (pSprite->DY() > 0)
             {
-                result = (pSprite->Y() > centerPoint.y) ? SDL_TRUE : SDL_FALSE;
+                result = (pSprite->Y() > IntToCoord(centerPoint.y)) ? SDL_TRUE : SDL_FALSE;
             }
             return result;
         }
@@ -0,0 +1,51 @@
+#pragma once
+#include "SDL.h"
+#include "arena.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Per tile buckets of actors, so "who is in this tile" is a walk of a short list instead of a
+    // comparison against every actor.  Each tile holds the head of a doubly linked list threaded
+    // through flat arrays (one set of links per item), so an item can hop from one tile to the next
+    // in constant time and nothing is allocated once created.  Items are small integers chosen by the
+    // owner (e.g. an index into its roster).
+    class OccupancyGrid
+    {
+    public:
+        static const Uint16 InvalidItem = 0xFFFF;
+
+        // rows, cols - size of the map
+        // cItemsMax - items are expected to be in the range [0, cItemsMax)
+        // pArena - where the arrays are carved from, they live as long as it does
+        OccupancyGrid(Uint16 rows, Uint16 cols, Uint16 cItemsMax, Arena *pArena);
+        ~OccupancyGrid();
+
+        // What the constructor takes from the arena
+        static size_t ArenaBytes(Uint16 rows, Uint16 cols, Uint16 cItemsMax);
+
+        // Empty every tile
+        void Clear();
+        // Put an item in the tile, taking it out of the one it was in (if any)
+        void Move(Uint16 item, Uint16 row, Uint16 col);
+        // Take an item out of the grid (e.g. it went off the map)
+        void Remove(Uint16 item);
+
+        // Iterate the items in a tile: for (i = First(r, c); i != InvalidItem; i = Next(i))
+        Uint16 First(Uint16 row, Uint16 col) { return _pHeads[(row * _cCols) + col]; }
+        Uint16 Next(Uint16 item) { return _pNext[item]; }
+
+    private:
+        static const Uint16 NoCell = 0xFFFF;
+
+        Uint16 _cRows;
+        Uint16 _cCols;
+        Uint16 _cItemsMax;
+        Uint16 *_pHeads;        // First item in each tile
+        Uint16 *_pNext;         // Next item in the same tile
+        Uint16 *_pPrev;         // Previous item in the same tile
+        Uint16 *_pCell;         // Which tile (row * cols + col) each item is in, NoCell if none
+    };
+}
+}
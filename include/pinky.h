@@ -9,7 +9,7 @@ namespace XplatGameTutorial
         class Pinky : public Ghost
         {
         public:
-            Pinky(TextureWrapper* pTextureWrapper);
+            Pinky(TextureWrapper* pTextureWrapper, ActorStore* pActorStore);
 
             // "Interface" for my ghosts to implement
             bool Initialize();
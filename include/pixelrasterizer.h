@@ -0,0 +1,104 @@
+#pragma once
+#include "SDL.h"
+#include "rendersnapshot.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Draws frames into small 8 bit grayscale buffers with nothing but the CPU, for feeding the game's
+    // pixels to agents by the thousand rather than to a screen.  The tile and sprite atlases are decoded
+    // once into grayscale at the output scale, each sprite frame with a byte mask from its color key
+    // (Constants::SDLColorMagenta), after which drawing is plain row copies (SSE2, or AVX2 when the
+    // build targets it) from the atlases into the caller's buffer.  Drawing reads nothing but the
+    // atlases and makes no SDL calls, so any number of threads can draw at once (see RasterPool)
+    //
+    // The output covers the maze (the map bounds the clip rect is set to), scaled down by 1, 2 or 4
+    class PixelRasterizer
+    {
+    public:
+        PixelRasterizer();
+        ~PixelRasterizer();
+
+        // Loads the atlases with SDL_image, once, before any drawing.  mapBounds is where the maze is on
+        // the screen, the sprites' screen positions are taken relative to it
+        bool Initialize(const char *szTilesImage, const char *szSpritesImage, SDL_Rect mapBounds,
+            Uint16 rows, Uint16 cols, Uint16 tileSize, int scale);
+
+        int Width() const { return _width; }
+        int Height() const { return _height; }
+        size_t FrameBytes() const { return static_cast<size_t>(_width) * _height; }
+
+        // pMapIndicies is rows * cols tiles, pSprites in draw order.  pPixels is FrameBytes(), a row
+        // every Width() bytes
+        void Draw(const Uint16 *pMapIndicies, const SpriteDraw *pSprites, Uint32 cSprites, Uint8 *pPixels) const;
+        void Draw(const RenderSnapshot &snapshot, Uint8 *pPixels) const;
+
+    private:
+        // An image at the output scale, a gray byte per pixel and (with a color key) a mask byte per pixel,
+        // 0xFF where it's drawn and 0 where it's see through
+        struct Atlas
+        {
+            Uint8 *pGray;
+            Uint8 *pMask;
+            int width;
+            int height;
+        };
+
+        bool LoadAtlas(const char *szFileName, bool fColorKey, Atlas *pAtlas);
+        static void FreeAtlas(Atlas *pAtlas);
+
+        Atlas _tiles;
+        Atlas _sprites;
+        int _scale;
+        SDL_Rect _mapBounds;            // Screen pixels
+        Uint16 _rows;
+        Uint16 _cols;
+        int _tileSize;                  // Output pixels
+        int _tilesPerAtlasRow;
+        int _width;                     // Output size, the map bounds over the scale
+        int _height;
+    };
+
+    // Worker threads that split a batch of frames between them (and the calling thread)
+    class RasterPool
+    {
+    public:
+        RasterPool();
+        ~RasterPool();
+
+        // cThreads counts the caller, so 1 draws everything on the calling thread
+        bool Start(int cThreads);
+        void Stop();
+        int ThreadCount() { return _cWorkers + 1; }
+
+        // Draws snapshot i into pPixels + (i * rasterizer.FrameBytes()), returns once they're all done.
+        // One batch at a time, from one thread
+        void DrawAll(const PixelRasterizer &rasterizer, const RenderSnapshot *pSnapshots, Uint32 cSnapshots, Uint8 *pPixels);
+
+    private:
+        static const int MaxWorkers = 63;
+
+        struct Worker
+        {
+            RasterPool *pPool;
+            int index;                  // 1 based, the caller takes the first share
+            SDL_Thread *pThread;
+            SDL_sem *pStart;            // Posted for each batch, one per worker so each draws its own share
+        };
+
+        static int WorkerThread(void *pData);
+        void DrawShare(int index);
+
+        Worker _workers[MaxWorkers];
+        int _cWorkers;
+        SDL_sem *_pDone;                // Posted by each worker as it finishes its share
+        bool _fStopping;
+        // The batch being drawn, set before the workers are started
+        const PixelRasterizer *_pRasterizer;
+        const RenderSnapshot *_pSnapshots;
+        Uint32 _cSnapshots;
+        Uint8 *_pPixels;
+    };
+}
+}
@@ -9,7 +9,7 @@ namespace PacManClone
     class Player : public Sprite
     {
     public:
-        Player(TextureWrapper *pTextureWrapper);
+        Player(TextureWrapper *pTextureWrapper, ActorStore *pActorStore);
         virtual ~Player();
 
         bool Initialize();
@@ -32,19 +32,20 @@ namespace PacManClone
             WarpingIn
         };
 
+        Mode GetMode() { return static_cast<Mode>(ActorMode()); }
+        void SetMode(Mode mode);
+
         void ProcessPlayerInput(Maze* pMaze, Direction direction);
         void DoBoundsCheck(Maze* pMaze);
 
-        bool IsWarpingOut(Maze* pMaze)
+        bool IsWarpingOut(Maze* /*pMaze*/)
         {
-            SDL_Point spritePoint = { static_cast<int>(X()), static_cast<int>(Y()) };
-            Uint16 row, col;
-            pMaze->GetTileRowCol(spritePoint, row, col);
+            Uint16 row = 0;
+            Uint16 col = 0;
+            GetTile(row, col);
             return ((row == Constants::WarpRow) && 
                 ((col == Constants::WarpColPlayerLeft) || (col == Constants::WarpColPlayerRight)));
         }
-
-        Mode _mode;
     };
 }
 }
\ No newline at end of file
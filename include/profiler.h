@@ -0,0 +1,122 @@
+#pragma once
+#include "SDL.h"
+#include <atomic>
+
+// Debug builds time the phases of every frame and can show the results over the game (F3).
+// Release builds (NDEBUG) compile all of it out, PROFILE_PHASE expands to nothing, unless
+// ENABLE_PROFILER is defined on the command line (the makefile does for the soak test)
+#if !defined(NDEBUG) && !defined(ENABLE_PROFILER)
+#define ENABLE_PROFILER
+#endif
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // The parts of a frame we time, in the order they happen
+    enum class ProfilePhase
+    {
+        EventPump = 0,      // SDL_PollEvent loop
+        Input,              // ProcessInput
+        Players,            // ActorStore update and Player::Update
+        Ghosts,             // Ghost::Update
+        Collision,          // Pellets (tile events) and ghost collisions
+        Render,             // Drawing the frame
+        Present,            // SDL_RenderPresent
+        Delay,              // SDL_Delay to hold the frame rate
+        Count
+    };
+
+#ifdef ENABLE_PROFILER
+    class TraceRecorder;
+
+    const char* ProfilePhaseName(ProfilePhase phase);
+
+    // The overlay's font, for other panels drawn alongside it.  Letters, digits and '.' only
+    void DrawOverlayText(SDL_Renderer *pSDLRenderer, int x, int y, const char *szText);
+    int OverlayLineHeight();
+
+    // Timings for one frame, in SDL_GetPerformanceCounter() ticks
+    struct FrameSample
+    {
+        Uint64 startTicks;                                          // When the frame began
+        Uint64 frameTicks;                                          // The whole frame, start to end
+        Uint64 phaseTicks[static_cast<int>(ProfilePhase::Count)];   // Time spent in each phase
+    };
+
+    // Collects the phase timings for each frame into a ring of the most recent frames.  There is a single
+    // writer (the game loop), frames are published with an atomic counter so readers on any thread can
+    // copy them out without a lock.  A reader that gets lapped while copying finds out and drops the frame.
+    // Each phase (and the frame as a whole) can also be passed on to a TraceRecorder as a span
+    class FrameProfiler
+    {
+    public:
+        static const Uint32 HistoryFrames = 256;    // Must be a power of 2
+
+        FrameProfiler();
+
+        // Writer side, called by the game loop
+        void BeginFrame();
+        void EndFrame();
+        void AddPhase(ProfilePhase phase, Uint64 startTicks, Uint64 endTicks);
+        // Not owned, nullptr to stop tracing
+        void SetTraceRecorder(TraceRecorder *pTrace) { _pTrace = pTrace; }
+
+        // Reader side.  Frames are numbered from 0, the ring holds [FramesWritten() - HistoryFrames, FramesWritten())
+        Uint32 FramesWritten() const { return _cFramesWritten.load(std::memory_order_acquire); }
+        // Copies the frame out, false if it is no longer (or not yet) in the ring
+        bool GetFrame(Uint32 frame, FrameSample *pSample) const;
+        // Every frame so far added up (startTicks is unused), writer thread only
+        const FrameSample& Totals() const { return _totals; }
+
+        void ToggleOverlay() { _fOverlayVisible = !_fOverlayVisible; }
+        bool IsOverlayVisible() { return _fOverlayVisible; }
+        // Rolling average and p99 of each phase, plus a graph of the recent frame times, in a panel
+        // OverlayHeight() tall at yTop.  szTitle heads the phase column (8 characters at most)
+        void RenderOverlay(SDL_Renderer *pSDLRenderer, int yTop, const char *szTitle);
+        static int OverlayHeight();
+
+    private:
+        FrameSample _ring[HistoryFrames];
+        std::atomic<Uint32> _cFramesWritten;
+        FrameSample _current;                       // Frame being timed, copied into the ring at EndFrame
+        FrameSample _totals;
+        bool _fOverlayVisible;
+        TraceRecorder *_pTrace;
+        double _msPerTick;                          // SDL_GetPerformanceCounter() ticks to ms
+    };
+
+    // Times the enclosing scope into one phase of the current frame
+    class ScopedPhaseTimer
+    {
+    public:
+        ScopedPhaseTimer(FrameProfiler *pProfiler, ProfilePhase phase) :
+            _pProfiler(pProfiler),
+            _phase(phase),
+            _startTicks(SDL_GetPerformanceCounter())
+        {
+        }
+
+        ~ScopedPhaseTimer()
+        {
+            _pProfiler->AddPhase(_phase, _startTicks, SDL_GetPerformanceCounter());
+        }
+
+    private:
+        FrameProfiler *_pProfiler;
+        ProfilePhase _phase;
+        Uint64 _startTicks;
+    };
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_PHASE(pProfiler, phase) ScopedPhaseTimer PROFILE_CONCAT(phaseTimer, __LINE__)((pProfiler), ProfilePhase::phase)
+#define PROFILE_BEGIN_FRAME(pProfiler) (pProfiler)->BeginFrame()
+#define PROFILE_END_FRAME(pProfiler) (pProfiler)->EndFrame()
+#else
+#define PROFILE_PHASE(pProfiler, phase)
+#define PROFILE_BEGIN_FRAME(pProfiler)
+#define PROFILE_END_FRAME(pProfiler)
+#endif
+}
+}
@@ -0,0 +1,108 @@
+#pragma once
+#include "SDL.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    class DiskStream;
+
+    // Draw order, everything in a layer is drawn before anything in the next one
+    enum class RenderLayer : Uint8
+    {
+        Background = 0,     // The maze tiles, or the title screen
+        Sprites,            // Players then ghosts
+        Debug,              // The ghosts' AI targets
+        Count
+    };
+
+    // The textures a command can draw from, RenderCommandList::Execute() is handed the SDL_Texture for each
+    enum class RenderTexture : Uint8
+    {
+        None = 0,           // Primitives drawn in a color
+        Tiles,
+        Sprites,
+        Title,
+        Count
+    };
+
+    enum class RenderPrimitive : Uint8
+    {
+        Copy = 0,           // SDL_RenderCopy
+        FillRect,           // SDL_RenderFillRect
+        Line,               // SDL_RenderDrawLine
+        Points              // SDL_RenderDrawPoints
+    };
+
+    // One draw call, recorded rather than made
+    struct RenderCommand
+    {
+        RenderLayer layer;
+        RenderTexture texture;
+        RenderPrimitive primitive;
+        SDL_Color color;            // Copy: the texture's color mod, otherwise the draw color
+        SDL_Rect source;            // Copy: rect on the texture (w == 0 for all of it).  Points: x is the first point, w the count
+        SDL_Rect target;            // Copy (w == 0 for the whole target) and FillRect: rect on the screen.  Line: from (x, y) to (w, h)
+    };
+
+    // Frame's worth of draw calls.  Everything is recorded first, then sorted by layer and texture (in the
+    // order recorded within each) so the copies from one texture go out together, then executed against a
+    // renderer.  A list can be saved to a file and loaded back, so a captured frame can be drawn over and
+    // over with no game behind it (see the microbenchmark).  Saving adds the list to the end of the file,
+    // loading takes the last one.  Sized once up front, recording past the capacity is a programming
+    // error and the command is dropped
+    //
+    // On disk, everything little endian:
+    //   "PMRL", Uint16 version, Uint16 flags (1 = sorted), Uint32 commands, Uint32 points
+    // followed by each command (Uint8 layer, texture, primitive, Uint8 r, g, b, a, then the source
+    // and target rects as Sint32 x, y, w, h) and each point (Sint32 x, y)
+    class RenderCommandList
+    {
+    public:
+        RenderCommandList();
+        ~RenderCommandList();
+
+        bool Reserve(Uint32 cCommandsMax, Uint32 cPointsMax);
+        void Clear();
+
+        // Recording
+        void Copy(RenderLayer layer, RenderTexture texture, const SDL_Rect *pSource, const SDL_Rect *pTarget,
+            SDL_Color colorMod = { 255, 255, 255, 255 });
+        void FillRect(RenderLayer layer, const SDL_Rect &rect, SDL_Color color);
+        void Line(RenderLayer layer, int x1, int y1, int x2, int y2, SDL_Color color);
+        void Points(RenderLayer layer, const SDL_Point *pPoints, Uint32 cPoints, SDL_Color color);
+
+        // Into layer and texture order, keeping the recorded order within each.  Linear (a counting sort)
+        void Sort();
+        // Makes the calls in the list's current order.  ppTextures has an entry for each RenderTexture,
+        // copies from a nullptr one are skipped.  The renderer's draw color is left as it was
+        void Execute(SDL_Renderer *pSDLRenderer, SDL_Texture *const *ppTextures);
+        // Sort() then Execute(), the list is kept until the next Clear() (e.g. to Save() it)
+        void Flush(SDL_Renderer *pSDLRenderer, SDL_Texture *const *ppTextures);
+
+        // Copies the list into the stream as one span, false if the stream dropped it.  Nothing waits on the disk
+        bool Save(DiskStream *pStream);
+        // Prints why and returns false on failure.  Sizes the list to fit the file
+        bool Load(const char *szFileName);
+        // What Save() writes for a list this size
+        static Uint32 SavedBytes(Uint32 cCommands, Uint32 cPoints);
+        Uint32 SavedBytesMax() { return SavedBytes(_cCommandsMax, _cPointsMax); }
+
+        Uint32 Count() { return _cCommands; }
+        Uint32 PointCount() { return _cPoints; }
+
+    private:
+        bool Add(const RenderCommand &command);
+
+        RenderCommand *_pCommands;
+        RenderCommand *_pSortScratch;       // Sort() works from here back into _pCommands
+        Uint32 _cCommands;
+        Uint32 _cCommandsMax;
+        SDL_Point *_pPoints;                // The Points commands' points, referenced by index
+        Uint32 _cPoints;
+        Uint32 _cPointsMax;
+        bool _fSorted;
+        Uint8 *_pSaved;                     // Save() lays the list out here, sized for the most Reserve() allows
+    };
+}
+}
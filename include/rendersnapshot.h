@@ -0,0 +1,80 @@
+#pragma once
+#include "SDL.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // One sprite's frame, where to draw it from on the sprite texture and where on the screen
+    struct SpriteDraw
+    {
+        SDL_Rect source;
+        SDL_Rect target;
+        bool fVisible;
+    };
+
+    // A ghost's AI target (the debug view drawn over each ghost in the normal game)
+    struct TargetDraw
+    {
+        enum class Extra : Uint8
+        {
+            None = 0,
+            LineToPoint,            // Inky, a line from the target to Blinky
+            CircleAroundPoint       // Clyde, his "too close to the player" radius around himself
+        };
+
+        SDL_Rect tile;
+        SDL_Color color;
+        Extra extra;
+        SDL_Point point;
+    };
+
+    // An actor as the simulation sees it, for what's exported alongside the frame (see SharedExport)
+    struct ActorState
+    {
+        Sint16 x;                   // Position, screen pixels
+        Sint16 y;
+        Uint8 direction;            // Direction
+        Uint8 mode;                 // Player::Mode or Ghost::Mode
+        Uint8 fVisible;
+        Uint8 reserved;
+    };
+
+    // The latest turn player 1 took on a key press, for timing how long it takes to show (see LatencyProbe)
+    struct TurnMark
+    {
+        Uint32 id;                  // Counts the turns from 1, 0 before the first
+        Uint32 tick;                // Simulation step that took it
+        Uint8 direction;            // Direction
+        bool fBuffered;             // Pressed before it could be taken, the wait for the corner is in the time
+        Uint64 inputCounter;        // When the key went down, SDL_GetPerformanceCounter() time
+        Uint64 tickCounter;         // When that step had finished updating
+    };
+
+    // Everything needed to draw one frame, captured by the simulation at the end of a step.  Once
+    // published (see TripleBuffer) it is only read, so the render side never looks at the live game
+    struct RenderSnapshot
+    {
+        Uint32 frame;               // Simulation step it was taken after
+        Uint32 sceneVersion;        // Changes whenever the picture might have, a static screen keeps the one it started with
+        bool fStatic;               // The title or the wait before a level, nothing moves
+        bool fTitle;                // Title screen, nothing else is drawn, otherwise the maze and sprites
+        Uint8 tileBlueMod;          // Color mod for the tiles, the level complete flash
+        SDL_Rect mapBounds;         // Drawing is clipped to the maze
+        Uint32 mapVersion;          // Maze::Version() the tiles were copied at, 0 before the first (Initialize() starts it at 1)
+        Uint16 *pMapIndicies;       // Copy of the maze's tile indicies (Constants::MapRows * Constants::MapCols)
+        Uint16 cPlayers;
+        Uint16 cGhosts;
+        SpriteDraw *pSprites;       // Players then ghosts, in roster order
+        TargetDraw *pTargets;       // One per ghost, nullptr when not drawn (stress mode)
+
+        // Not drawn, just passed along with the frame when it's exported
+        Uint8 gameState;            // GameHarness::GameState
+        Uint16 cPelletsEaten;       // This level
+        Uint32 cLevelsCompleted;
+        Uint32 cGhostCatches;
+        ActorState *pActors;        // Players then ghosts, nullptr unless exporting (--export)
+        TurnMark turn;              // Timed once the first frame showing it is presented
+    };
+}
+}
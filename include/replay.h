@@ -0,0 +1,119 @@
+#pragma once
+#include "SDL.h"
+#include "utils.h"
+#include "diskwriter.h"
+#include "constants.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // What a recording needs to be played back: the roster it was made with and how it ended.  The
+    // simulation is deterministic, so replaying the same input from a fresh start has to arrive at
+    // the same checksum (see GameHarness::StateChecksum())
+    struct ReplayInfo
+    {
+        bool fStress;               // Roster came from cPlayers/cGhosts rather than the normal game
+        Uint16 cPlayers;
+        Uint16 cGhosts;
+        Uint32 cTicks;              // Simulation ticks recorded
+        Uint32 checksum;            // State after the last tick
+    };
+
+    // On disk, everything little endian:
+    //   "PMCR", Uint16 version, Uint16 flags (1 = stress), Uint16 players, Uint16 ghosts, Uint32 ticks, Uint32 checksum
+    // followed by one byte per tick, the keyboard player's Direction for that tick.  The other players
+    // are on autopilot, which is seeded the same every run, so they don't need recording.
+    // Version 2 adds keyframes, so playback can start anywhere without simulating everything before it.
+    // Every KeyframeInterval ticks the whole state of the world (GameHarness::SaveWorldState()) goes in
+    // ahead of that tick's input, and the file ends with an index of them:
+    //   { Uint32 tick, Uint32 checksum, Uint32 hash, Uint32 offset } per keyframe
+    //   Uint32 interval, Uint32 keyframe bytes, Uint32 keyframes, "PMCK"
+    // The keyframes are the game's memory as is, so they're only good for the build that wrote them.  The
+    // hash (FNV-1a of the keyframe's bytes) catches a damaged file before anything is restored from it, the
+    // checksum (StateChecksum() at that tick) tells a player whether one restored properly
+
+    // Writes the keyboard player's input as the game runs, through a DiskWriter so the simulation never
+    // waits on the file.  The tick count and checksum in the header are filled in by Close()
+    class ReplayRecorder
+    {
+    public:
+        static const Uint32 KeyframeInterval = 10 * Constants::FramesPerSecond;
+
+        ReplayRecorder();
+        ~ReplayRecorder();
+
+        // keyframeBytes - the size of every keyframe, the same all session
+        bool Open(DiskWriter *pWriter, const char *szFileName, bool fStress, Uint16 cPlayers, Uint16 cGhosts, Uint32 keyframeBytes);
+        // Whether the next tick wants a keyframe ahead of it
+        bool KeyframeDue() { return ((_info.cTicks % KeyframeInterval) == 0) && (_cKeyframes < MaxKeyframes); }
+        // pState - the world before the next tick, checksum - StateChecksum() of it
+        void AddKeyframe(const Uint8 *pState, Uint32 checksum);
+        // input - what the keyboard player did this tick, checksum - the state after it
+        void AddTick(Direction input, Uint32 checksum);
+        void Close();
+        bool IsOpen() { return _pStream != nullptr; }
+
+    private:
+        static const Uint32 StreamCapacity = 64 * 1024;     // Minutes of ticks, the writer empties it every 100ms
+        static const Uint32 MaxKeyframes = 4096;            // Over 11 hours, the rest of a longer session goes without
+
+        struct KeyframeEntry
+        {
+            Uint32 tick;
+            Uint32 checksum;
+            Uint32 hash;
+            Uint32 offset;                  // From the start of the file
+        };
+
+        void EncodeHeader(Uint8 *pHeader);
+
+        DiskWriter *_pWriter;
+        DiskStream *_pStream;
+        ReplayInfo _info;
+        Uint32 _cbWritten;                  // Where the next write lands in the file
+        Uint32 _keyframeBytes;
+        KeyframeEntry *_pKeyframes;         // The index, written out by Close()
+        Uint32 _cKeyframes;
+    };
+
+    // A recording loaded into memory for playback
+    class Replay
+    {
+    public:
+        Replay();
+        ~Replay();
+
+        // Prints why and returns false if the file can't be used
+        bool Load(const char *szFileName);
+
+        const ReplayInfo& Info() const { return _info; }
+        Direction Input(Uint32 tick) const { return static_cast<Direction>(_pInputs[tick]); }
+
+        // None in a version 1 recording
+        Uint32 KeyframeCount() const { return _cKeyframes; }
+        Uint32 KeyframeBytes() const { return _keyframeBytes; }
+        Uint32 KeyframeTick(Uint32 index) const { return index * _keyframeInterval; }
+        Uint32 KeyframeChecksum(Uint32 index) const { return _pKeyframeChecksums[index]; }
+        const Uint8* KeyframeState(Uint32 index) const { return _pKeyframes + (static_cast<size_t>(index) * _keyframeBytes); }
+        // The last keyframe at or before the tick (the first is at tick 0).  They're evenly spaced, so
+        // it's a divide rather than a search
+        Uint32 KeyframeBefore(Uint32 tick) const
+        {
+            SDL_assert(_cKeyframes > 0);
+            return SDL_min(tick / _keyframeInterval, _cKeyframes - 1);
+        }
+
+    private:
+        bool LoadKeyframes(const char *szFileName, SDL_RWops *pFile);
+
+        ReplayInfo _info;
+        Uint8 *_pInputs;            // One per tick
+        Uint32 _keyframeInterval;
+        Uint32 _keyframeBytes;
+        Uint32 _cKeyframes;
+        Uint8 *_pKeyframes;         // One after the other
+        Uint32 *_pKeyframeChecksums;
+    };
+}
+}
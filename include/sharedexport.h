@@ -0,0 +1,98 @@
+#pragma once
+#include "SDL.h"
+#include <atomic>
+#include "rendersnapshot.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // The start of the shared memory, written once by Open() and then only the published count changes
+    struct SharedExportHeader
+    {
+        char magic[4];                  // "PMSX", written last so a reader can tell the rest is there
+        Uint32 version;                 // SharedExport::Version
+        Uint32 headerBytes;             // Where slot 0 starts
+        Uint32 slotCount;
+        Uint32 slotBytes;               // Distance from one slot to the next
+        Uint32 maxActors;               // ActorState entries in each slot
+        Uint32 mapRows;
+        Uint32 mapCols;
+        Uint32 actorsOffset;            // From the start of a slot
+        Uint32 mapOffset;               // Uint16 tile indicies, mapRows * mapCols of them
+        Uint32 pixelsOffset;
+        Uint32 width;                   // The frame, 32 bit ARGB (B, G, R, A bytes in memory)
+        Uint32 height;
+        Uint32 pitch;
+        std::atomic<Uint64> published;  // Frames published, the newest is in slot (published - 1) % slotCount
+    };
+
+    // The start of each slot.  The sequence is a seqlock, odd while the slot is being written and even
+    // once it's done, (2 * n) + 2 for the nth frame published
+    struct SharedExportSlot
+    {
+        std::atomic<Uint64> sequence;
+        Uint64 frame;                   // Simulation step the frame was drawn from
+        Uint32 gameState;
+        Uint32 cPelletsEaten;
+        Uint32 cLevelsCompleted;
+        Uint32 cGhostCatches;
+        Uint32 mapVersion;
+        Uint16 cPlayers;
+        Uint16 cGhosts;
+    };
+
+    // Publishes each drawn frame, and the game state it was drawn from, to named shared memory (a POSIX
+    // shm object, a file mapping on Windows) so trainers and dashboards in other processes can read them
+    // in place.  The frames go round a ring of SlotCount slots, so a reader has a few frames' grace
+    // before the one it's reading is reused.  There are no locks, a reader checks its read afterwards:
+    //
+    //   n = header.published (acquire), slot = (n - 1) % slotCount
+    //   s1 = slot.sequence (acquire), odd means try again
+    //   ... read what's wanted from the slot ...
+    //   acquire fence, s2 = slot.sequence, the read is good if s1 == s2
+    //
+    // One writer, the render side
+    class SharedExport
+    {
+    public:
+        static const Uint32 Version = 1;
+        static const Uint32 SlotCount = 4;
+
+        SharedExport();
+        ~SharedExport();
+
+        // Creates (or takes over) the shared memory called szName, for frames of width x height and up to
+        // maxActors actors a frame
+        bool Open(const char *szName, int width, int height, Uint16 maxActors, Uint16 mapRows, Uint16 mapCols);
+        // Unmaps and removes the name, readers that still have it mapped keep what they have
+        void Close();
+        bool IsOpen() { return _pHeader != nullptr; }
+
+        // Marks the next slot as being written and returns it, fill it in (and its actors, map and pixels)
+        // then EndWrite() publishes it.  AbandonWrite() gives up on it instead, the slot stays odd so readers
+        // never take what's in it and published doesn't move
+        SharedExportSlot* BeginWrite();
+        void EndWrite();
+        void AbandonWrite();
+
+        ActorState* Actors(SharedExportSlot *pSlot) { return reinterpret_cast<ActorState*>(reinterpret_cast<Uint8*>(pSlot) + _pHeader->actorsOffset); }
+        Uint16* MapIndicies(SharedExportSlot *pSlot) { return reinterpret_cast<Uint16*>(reinterpret_cast<Uint8*>(pSlot) + _pHeader->mapOffset); }
+        void* Pixels(SharedExportSlot *pSlot) { return reinterpret_cast<Uint8*>(pSlot) + _pHeader->pixelsOffset; }
+        int Pitch() { return static_cast<int>(_pHeader->pitch); }
+        Uint64 Published() { return _cPublished; }
+
+    private:
+        static Uint32 Align(Uint32 cb) { return (cb + 63) & ~63u; }  // Cache lines, and keeps every section aligned
+
+        SharedExportHeader *_pHeader;
+        SharedExportSlot *_pWriting;    // Between BeginWrite() and EndWrite()
+        Uint64 _cPublished;
+        size_t _cbMapping;
+        char _szName[256];              // As created, for removing it again
+#ifdef _WIN32
+        void *_hMapping;
+#endif
+    };
+}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include "utils.h"
 #include "spriteanimation.h"
+#include "actorstore.h"
 #include <map>
 
 namespace XplatGameTutorial
@@ -11,17 +12,26 @@ namespace PacManClone
     // be animated, and they have a position and velocity.  Pac-Man and the Ghosts are very obvious examples of sprites, but
     // they can be used for other purposes, such as the "text" output and the bonus fruit in the future.
     // It would also be possible to make the larger pellets (or even the smaller ones) into animated sprites.
+    // The moving state (position, velocity, animation counters) lives in a shared ActorStore so every actor
+    // can be updated in one pass, and the frames and clips are shared through the store's AnimationRegistry.
     class Sprite
     {
     public:
         // pTextureWrapper - pointer to loaded texture that holds our sprite frames
+        // pActorStore - storage for the moving state, a slot is claimed for this sprite
         // cxFrame - width of a frame in pixels
         // cyFrame - height of a frame in pixels
         // cFramesTotal - total frames to load
         // cAnimationsTotal - total number of animation sequences needed
-        Sprite(TextureWrapper *pTextureWrapper, Uint16 cxFrame, Uint16 cyFrame, Uint16 cFramesTotal, Uint16 cAnimationsTotal);
+        Sprite(TextureWrapper *pTextureWrapper, ActorStore *pActorStore, Uint16 cxFrame, Uint16 cyFrame, Uint16 cFramesTotal, Uint16 cAnimationsTotal);
         virtual ~Sprite();
 
+        // Point the sprite at a shared table of frames in the registry.  Returns true if this is the first sprite
+        // to use the table, in which case the frames still need to be loaded below
+        bool UseFrameTable(AnimationRegistry::FrameTableId frameTableId);
+        // Point the sprite at a shared set of animation clips.  Returns true if they still need to be loaded below
+        bool UseClipSet(AnimationRegistry::ClipSetId clipSetId);
+
         // All frames are the same size once created above (cxFrame * cyFrame)
         // index - frame index to assign the image to 
         // xTexture - x coordinate on loaded texture
@@ -31,9 +41,9 @@ namespace PacManClone
         bool LoadFrames(Uint16 indexStart, Uint16 xTextureStart, Uint16 yTextureStart, Uint16 cFramesToLoad);
 
         //  Saves a series of frames to cycle through in order at a given speed (frame delay per update)
-        // index - animation index to assign the sequence to
+        // index - animation index (within the clip set) to assign the sequence to
         // animationType - Currently either loop or once
-        // pSequence - pointer to list of frames
+        // pSequence - pointer to list of frames, this is not copied so it must outlive the registry
         // cFramesInSequence - total frames in the sequence passed in
         // animationSpeed - the delay between frame updates
         void LoadAnimationSequence(Uint16 index, AnimationType animationType, int* pSequence, Uint16 cFramesInSequence, Uint16 animationSpeed);
@@ -42,48 +52,72 @@ namespace PacManClone
         // Set a new (already loaded) animation sequence as the current
         void SetAnimation(Uint16 index);
         // Set a new velocity
-        void SetVelocity(double dx, double dy);
+        void SetVelocity(Coord dx, Coord dy);
         // Set a new position (normally handled via Update but on death, etc)
-        void ResetPosition(double x, double y); 
+        void ResetPosition(Coord x, Coord y); 
         // This is only needed for sprites that have no animation, the frame will not update
         void SetFrame(Uint16 frameIndex);
         // Offset from the pixel (X,Y) location of the sprite for the frame (defaults to 0)
         void SetFrameOffset(int xOffset, int yOffset);
         // If the sprite isn't visible, it won't render
         void SetVisible(SDL_bool visible);
-        // Applies current state to the object (velocity, animation, etc)
-        void Update();
         // Draw it to the renderer
         void Render(SDL_Renderer *pSDLRenderer);
+        // Where Render() would copy the current frame from on the texture and to on the screen,
+        // false if the sprite is hidden and would draw nothing
+        bool GetDraw(SDL_Rect *pSource, SDL_Rect *pTarget);
         // Some quick accessors
-        double X() { return _x; }
-        double Y() { return _y; }
-        double DX() { return _dx; }
-        double DY() { return _dy; }
+        Coord X() { return _pActorStore->X(_id); }
+        Coord Y() { return _pActorStore->Y(_id); }
+        Coord DX() { return _pActorStore->DX(_id); }
+        Coord DY() { return _pActorStore->DY(_id); }
+        Coord PrevX() { return _pActorStore->PrevX(_id); }
+        Coord PrevY() { return _pActorStore->PrevY(_id); }
         Uint16 Width() { return _cxFrame; }
         Uint16 Height() { return _cyFrame; }
+        ActorId Id() { return _id; }
+
+        // The tile under the sprite, tracked by the ActorStore as it moves.  Same contract as
+        // TiledMap::GetTileRowCol(), false and row/col left alone if off the map
+        bool GetTile(Uint16 &row, Uint16 &col)
+        {
+            if (_pActorStore->TileRow(_id) == ActorStore::OffMap)
+            {
+                return false;
+            }
+            row = _pActorStore->TileRow(_id);
+            col = _pActorStore->TileCol(_id);
+            return true;
+        }
 
-        Uint16 CurrentAnimation() { return _currentAnimationIndex; }
+        Uint16 CurrentAnimation() { return _pActorStore->Clip(_id) - _clipBase; }
         Direction CurrentDirection();
         bool IsOutOfView(SDL_Rect &rect);
 
     protected:
-        double _x;                              // Position
-        double _y;
-        double _dx;                             // Velocity
-        double _dy;
-        Uint16 _cFramesTotal;                   // Total number of frames to allocate
-        SDL_Rect *_pFrames;                     // Frame rects in the texture
+        // Current cell and owner defined state, also kept in the ActorStore
+        Uint16 CurrentRow() { return _pActorStore->Row(_id); }
+        Uint16 CurrentCol() { return _pActorStore->Col(_id); }
+        void SetCurrentCell(Uint16 row, Uint16 col) { _pActorStore->SetCell(_id, row, col); }
+        Uint8 ActorMode() { return _pActorStore->Mode(_id); }
+        void SetActorMode(Uint8 mode) { _pActorStore->SetMode(_id, mode); }
+#ifdef ENABLE_PROFILER
+        TraceRecorder* Trace() { return _pActorStore->Trace(); }
+#endif
+
+        ActorStore *_pActorStore;               // Not owned by the sprite class
+        ActorId _id;                            // Our slot in the store
+        Uint16 _cFramesTotal;                   // Total number of frames in the frame table
+        SDL_Rect *_pFrames;                     // Frame rects in the texture, shared and not owned by the sprite class
         Uint16 _cxFrame;                        // Width of a frame
         Uint16 _cyFrame;                        // Height of a frame
         int _cxFrameOffset;                     // Offset of left side of frame from position (can be negative)
         int _cyFrameOffset;                     // Offset of Top side of frame from position
-        Uint16 _currentAnimationIndex;          // Index to the current animation sequence
         Uint16 _cAnimationsTotal;               // Total number of animation sequences
+        ClipId _clipBase;                       // First clip of our set in the registry (InvalidClip if not animated)
         Uint16 _staticFrameIndex;               // Index in non-animated sprite to frame to draw
         SDL_bool _fVisible;                     // Visibility flag
         TextureWrapper *_pTextureWrapper;       // Not owned by the sprite class
-        SpriteAnimation** _ppSpriteAnimations;  // Is owned and holds the list of animation sequences
     };
 }
 }
\ No newline at end of file
@@ -1,5 +1,7 @@
 #pragma once
 #include "SDL_image.h"
+#include "arena.h"
+#include "rendercommands.h"
 
 namespace XplatGameTutorial
 {
@@ -24,23 +26,35 @@ namespace PacManClone
             _cRows(rows),
             _tileSize(0),
             _pTileTexture(nullptr),
-            _cTilesOnTexture(0)
+            _cTilesOnTexture(0),
+            _version(0)
         {
             SDL_memset(&_textureRect, 0, sizeof(SDL_Rect));
         }
 
+        // The tile rects and indicies belong to the arena passed to Initialize()
         virtual ~TiledMap()
         {
-            // Free our allocated memory
-            delete[] _pMapIndicies;
-            delete[] _pTileRects;
         }
 
-        // Initialize our map with the texture and map data
-        bool Initialize(SDL_Rect textureRect, SDL_Rect tileRect, SDL_Texture *pTexture, Uint16 *pMapIndices, Uint16 countOfIndicies);
+        // Initialize our map with the texture and map data.  The map's memory is carved from pArena, so
+        // to start the map over, rewind the arena to before the last call and call it again
+        bool Initialize(SDL_Rect textureRect, SDL_Rect tileRect, SDL_Texture *pTexture, Uint16 *pMapIndices, Uint16 countOfIndicies, Arena *pArena);
+        // What Initialize() takes from the arena
+        static size_t ArenaBytes(SDL_Rect textureRect, SDL_Rect tileRect, Uint16 countOfIndicies);
         
         // Draw to the renderer at the current offset, etc
         virtual void Render(SDL_Renderer *pSDLRenderer);
+        // Same, but with the tiles from pMapIndicies (rows * cols of them) rather than our own
+        void Render(SDL_Renderer *pSDLRenderer, const Uint16 *pMapIndicies);
+        // Same again, but recorded into a command list as copies from texture, the tile texture's id there
+        void Render(RenderCommandList *pCommands, RenderLayer layer, RenderTexture texture, const Uint16 *pMapIndicies, SDL_Color colorMod);
+        // Blends a color over each tile, rows * cols of them, skipping any that are fully transparent
+        void RenderOverlay(SDL_Renderer *pSDLRenderer, const SDL_Color *pTileColors);
+
+        // The tile indicies, rows * cols of them, and a count that changes whenever any of them do
+        const Uint16* MapIndicies() { return _pMapIndicies; }
+        Uint32 Version() { return _version; }
         
         // Given an [row][col] location, return the (X,Y) coordinates on the screen
         SDL_Point GetTileCoordinates(Uint16 row, Uint16 col);
@@ -51,7 +65,11 @@ namespace PacManClone
         
     protected:
         Uint16 GetTileIndexAt(Uint16 row, Uint16 col) { return _pMapIndicies[(row * _cCols) + col]; }
-        void SetTileIndexAt(Uint16 row, Uint16 col, Uint16 index) { _pMapIndicies[(row * _cCols) + col] = index; }
+        void SetTileIndexAt(Uint16 row, Uint16 col, Uint16 index)
+        {
+            _pMapIndicies[(row * _cCols) + col] = index;
+            _version++;
+        }
         
         Uint16 _cxScreen;           // Total screen (window) width in pixels
         Uint16 _cyScreen;           // Total screen height
@@ -67,6 +85,7 @@ namespace PacManClone
         SDL_Rect _textureRect;      // Size of the texture
         SDL_Texture *_pTileTexture; // Texture that holds the tiles (must be evenly divisible by tile size)
         Uint16 _cTilesOnTexture;    // Total number of tiles on the texture
+        Uint32 _version;            // Bumped by Initialize() and every tile change
     };
 }
 }
\ No newline at end of file
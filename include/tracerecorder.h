@@ -0,0 +1,87 @@
+#pragma once
+#include "SDL.h"
+#include <stdio.h>
+#include "profiler.h"
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+#ifdef ENABLE_PROFILER
+    // Writes a timeline of the game to a Chrome trace event JSON file (load it in chrome://tracing or
+    // ui.perfetto.dev).  Spans come from the frame profiler's phase timers, instants are things like state
+    // and mode changes.  The game thread only copies each event into a buffer, full buffers are handed to a
+    // writer thread that formats and writes them, so a long soak costs the game next to nothing.  If the writer
+    // falls behind and every buffer is in use, events are dropped (and counted) rather than stalling a frame
+    class TraceRecorder
+    {
+    public:
+        TraceRecorder();
+        ~TraceRecorder();
+
+        // Creates the file and starts the writer thread
+        bool Open(const char *szFileName);
+        // Flushes everything recorded so far, finishes the file and stops the writer thread
+        void Close();
+        bool IsOpen() { return _pFile != nullptr; }
+
+        // Names, categories and details must be string literals (or otherwise outlive the recorder), only
+        // the pointers are kept until the writer thread gets to them.  Both do nothing unless Open()
+        //
+        // Something that took time, in SDL_GetPerformanceCounter() ticks
+        void Span(const char *szName, const char *szCategory, Uint64 startTicks, Uint64 durationTicks);
+        // Something that happened now.  id is the actor it happened to (-1 for none), szDetail can be nullptr
+        void Instant(const char *szName, const char *szCategory, Sint32 id, const char *szDetail);
+
+        Uint32 DroppedEvents() { return _cDropped; }
+
+    private:
+        static const Uint32 EventsPerBuffer = 4096;
+        static const Uint32 BufferCount = 8;
+
+        struct Event
+        {
+            const char *szName;
+            const char *szCategory;
+            const char *szDetail;
+            Uint64 startTicks;
+            Uint64 durationTicks;
+            Sint32 id;
+            char type;                  // Chrome trace phase, 'X' for a span, 'i' for an instant
+        };
+
+        struct Buffer
+        {
+            Event events[EventsPerBuffer];
+            Uint32 cEvents;
+        };
+
+        static int WriterThread(void *pData);
+        void Append(const Event &event);
+        void Submit();
+        void WriteBuffer(Buffer *pBuffer);
+
+        FILE *_pFile;
+        SDL_Thread *_pThread;
+        SDL_mutex *_pLock;              // Guards the queues and _fClosing
+        SDL_cond *_pPending;            // Signalled when a buffer is queued for writing (or we're closing)
+        Buffer *_pBuffers;              // BufferCount of them
+        Buffer *_pCurrent;              // Being filled by the game thread
+        Buffer *_pQueue[BufferCount];   // Full buffers waiting for the writer, oldest first
+        Uint32 _cQueued;
+        Buffer *_pFree[BufferCount];    // Empty buffers
+        Uint32 _cFree;
+        bool _fClosing;
+        bool _fFirstEvent;              // Writer thread only, no comma before the first event
+        Uint32 _cDropped;
+        Uint64 _baseTicks;              // Timestamps in the file are relative to Open()
+        double _usPerTick;
+    };
+
+#define TRACE_INSTANT(pRecorder, szName, szCategory, id, szDetail) \
+    do { if ((pRecorder) != nullptr) { (pRecorder)->Instant((szName), (szCategory), (id), (szDetail)); } } while (0)
+#else
+#define TRACE_INSTANT(pRecorder, szName, szCategory, id, szDetail)
+#endif
+}
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <atomic>
+
+namespace XplatGameTutorial
+{
+namespace PacManClone
+{
+    // Hands the latest of a stream of T from one writer thread to one reader thread without either
+    // waiting on the other.  There are three slots: the writer fills the back one while the reader
+    // holds the front one, and the middle one holds the newest finished T.  Publishing swaps the back
+    // and middle slots, acquiring swaps the front and middle slots, each with a single atomic exchange.
+    // A reader that falls behind skips straight to the newest, a writer that gets ahead overwrites the
+    // one the reader hasn't picked up yet
+    template <class T> class TripleBuffer
+    {
+    public:
+        // The slots are value initialized, so a POD T starts out zeroed rather than indeterminate
+        TripleBuffer() :
+            _slots(),
+            _back(0),
+            _middle(1),
+            _front(2)
+        {
+        }
+
+        // For setting up the slots before either thread starts
+        T& Slot(int index) { return _slots[index]; }
+
+        // Writer side: fill in Back() then Publish() it
+        T& Back() { return _slots[_back]; }
+        void Publish()
+        {
+            _back = _middle.exchange(_back | FreshBit, std::memory_order_acq_rel) & IndexMask;
+        }
+
+        // Reader side: true if there was something newer than Front() and it is now in Front()
+        bool Acquire()
+        {
+            if ((_middle.load(std::memory_order_relaxed) & FreshBit) == 0)
+            {
+                return false;
+            }
+            _front = _middle.exchange(_front, std::memory_order_acq_rel) & IndexMask;
+            return true;
+        }
+        const T& Front() { return _slots[_front]; }
+
+    private:
+        static const int IndexMask = 3;
+        static const int FreshBit = 4;      // Set in _middle when the writer has published since the last Acquire()
+
+        T _slots[3];
+        int _back;                          // Writer thread only
+        std::atomic<int> _middle;           // Slot index, plus FreshBit
+        int _front;                         // Reader thread only
+    };
+}
+}
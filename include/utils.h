@@ -7,10 +7,17 @@ namespace XplatGameTutorial
 namespace PacManClone
 {
     // Oneshot timer for state transistions
+    // By default it runs off the wall clock, timers that are part of the simulation are given the
+    // simulation clock instead so they behave the same no matter how fast (or slow) the updates run
     class StateTimer
     {
     public:
-        StateTimer() : _startTicks(0), _targetTicks(0), _fStarted(false)
+        StateTimer() : StateTimer(nullptr)
+        {
+        }
+
+        // pClock - ms counter to use instead of SDL_GetTicks(), not owned
+        explicit StateTimer(const Uint32 *pClock) : _startTicks(0), _targetTicks(0), _fStarted(false), _pClock(pClock)
         {
         }
 
@@ -18,18 +25,31 @@ namespace PacManClone
         {
             SDL_assert(!_fStarted);
             SDL_assert(_startTicks == 0);
-            _startTicks = SDL_GetTicks();
+            _startTicks = Now();
             _targetTicks = waitTicks;
             _fStarted = true;
         }
 
         void Reset() { _fStarted = false; _startTicks = 0; }
         bool IsStarted() { return _fStarted; }
-        bool IsDone() { return IsStarted() && (SDL_GetTicks() - _startTicks > _targetTicks); }
+        bool IsDone() { return IsStarted() && (Now() - _startTicks > _targetTicks); }
+
+        // For saving and restoring the timer with the rest of the simulation, the clock stays as it is
+        Uint32 StartTicks() { return _startTicks; }
+        Uint32 TargetTicks() { return _targetTicks; }
+        void Restore(Uint32 startTicks, Uint32 targetTicks, bool fStarted)
+        {
+            _startTicks = startTicks;
+            _targetTicks = targetTicks;
+            _fStarted = fStarted;
+        }
     private:
+        Uint32 Now() { return (_pClock != nullptr) ? *_pClock : SDL_GetTicks(); }
+
         Uint32 _startTicks;
         Uint32 _targetTicks;
         bool _fStarted;
+        const Uint32 *_pClock;
     };
 
     // Simple enum to denote the 4 possible directions
@@ -58,7 +78,12 @@ namespace PacManClone
     SDL_Texture* LoadTexture(const char *szFileName, SDL_Renderer *pSDLRenderer, SDL_Color *pSdlTransparencyColorKey);
     
     // Sets up our SDL environment and Window
-    bool InitializeSDL(SDL_Window **ppSDLWindow, SDL_Renderer **ppSDLRenderer);
+    bool InitializeSDL(SDL_Window **ppSDLWindow, SDL_Renderer **ppSDLRenderer, bool fVsync);
+    // Same, but with a software renderer drawing into a screen sized surface instead of a window
+    bool InitializeSDLHeadless(SDL_Surface **ppSDLSurface, SDL_Renderer **ppSDLRenderer);
+
+    // CPU time used by the whole process so far (every thread, user and kernel)
+    double ProcessCpuSeconds();
 
     // TODO - helper to calculate distance between 2 cells
     double Distance(Uint16 row1, Uint16 col1, Uint16 row2, Uint16 col2);
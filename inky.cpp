@@ -3,8 +3,8 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-Inky::Inky(TextureWrapper* pTextureWrapper) :
-    Ghost(pTextureWrapper, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
+Inky::Inky(TextureWrapper* pTextureWrapper, ActorStore* pActorStore) :
+    Ghost(pTextureWrapper, pActorStore, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
         Constants::GhostTotalFrameCount, Constants::GhostTotalAnimationCount),
     _pBlinky(nullptr)
 {
@@ -12,10 +12,9 @@ Inky::Inky(TextureWrapper* pTextureWrapper) :
 
 bool Inky::Initialize()
 {
-    // Each ghost will have its own set of frames, so each will override this method and implement
-    // the specific loading data
-    InitializeCommon();
-    LoadFrames(0, 0, 128, 8);
+    // Each ghost will have its own set of frames (shared by every ghost of the same type), so each will
+    // override this method and implement the specific loading data
+    InitializeCommon(AnimationRegistry::FrameTableId::Inky, 128);
     _scatterRow = Constants::InkyScatterRow;
     _scatterCol = Constants::InkyScatterCol;
     _targetColor = Constants::InkyDrawColor;
@@ -30,17 +29,14 @@ bool Inky::Reset(Maze *pMaze)
     // There is no "penned" mode, just placement will take care of that.  Inky is the only
     // ghost that is supposed to start outside of the pen, but since he's the only one for now
     // put him inside to test out that code path.
-    _currentRow = Constants::GhostPenRow;
-    _currentCol = Constants::GhostPenCol - 2;
-    ResetPosition(playerStartCoord.x, playerStartCoord.y);
-    SetVelocity(0, Constants::GhostBaseSpeed * -1.75);
+    SetCurrentCell(Constants::GhostPenRow, Constants::GhostPenCol - 2);
+    ResetPosition(IntToCoord(playerStartCoord.x), IntToCoord(playerStartCoord.y));
+    SetVelocity(0, -Constants::GhostSpeed);
 
-    SafeDelete<Decision>(_pNextDecision);
-    SafeDelete<Decision>(_pCurrentDecision);
-    _pCurrentDecision = new Decision(Constants::GhostPenRow, Constants::GhostPenCol - 2, CurrentDirection());
+    ResetDecisions(Constants::GhostPenRow, Constants::GhostPenCol - 2);
     _penTimer.Reset();
     SetPenTimerMax(5000);
-    _mode = Mode::Chase;
+    SetMode(Mode::Chase);
     _fScatter = false;
 
     return true;
@@ -54,7 +50,7 @@ Direction Inky::MakeBranchDecision(Uint16 nRow, Uint16 nCol, Player* pPlayer, Ma
 
     Direction result = CurrentDirection();
 
-    SDL_Point playerPoint = { static_cast<int>(pPlayer->X()), static_cast<int>(pPlayer->Y()) };
+    SDL_Point playerPoint = { CoordToInt(pPlayer->X()), CoordToInt(pPlayer->Y()) };
     if (_fScatter)
     {
         _targetRow = _scatterRow;
@@ -64,10 +60,9 @@ Direction Inky::MakeBranchDecision(Uint16 nRow, Uint16 nCol, Player* pPlayer, Ma
     {
         pPlayer->GetTilePlayerFacingWithOriginalBug(pMaze, 2, _targetRow, _targetCol);
 
-        SDL_Point blinkyPoint{ static_cast<int>(GetBlinkyReference()->X()), static_cast<int>(GetBlinkyReference()->Y()) };
         Uint16 blinkyRow = 0;
         Uint16 blinkyCol = 0;
-        pMaze->GetTileRowCol(blinkyPoint, blinkyRow, blinkyCol);
+        GetBlinkyReference()->GetTile(blinkyRow, blinkyCol);
 
         _targetRow = (2 * _targetRow) - blinkyRow;
         _targetCol = (2 * _targetCol) - blinkyCol;
@@ -0,0 +1,104 @@
+#include "include/inputqueue.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+bool InputQueue::Push(const InputEvent &event)
+{
+    Uint32 tail = _tail.load(std::memory_order_relaxed);
+    if (tail - _head.load(std::memory_order_acquire) >= Capacity)
+    {
+        _cDropped++;
+        return false;
+    }
+    _events[tail & (Capacity - 1)] = event;
+    _tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool InputQueue::Pop(InputEvent *pEvent)
+{
+    Uint32 head = _head.load(std::memory_order_relaxed);
+    if (head == _tail.load(std::memory_order_acquire))
+    {
+        return false;
+    }
+    *pEvent = _events[head & (Capacity - 1)];
+    _head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+void InputState::Apply(const InputEvent &event)
+{
+    int key = static_cast<int>(event.key);
+    if (!event.fDown)
+    {
+        _pressOrder[key] = 0;
+        return;
+    }
+
+    _pressOrder[key] = ++_cPresses;
+    if (event.key == InputKey::Escape)
+    {
+        _fEscape = true;
+    }
+    else
+    {
+        if ((_desiredTurn != Direction::None) && (_desiredTurn != static_cast<Direction>(key)))
+        {
+            _cTurnsReplaced++;
+        }
+        _desiredTurn = static_cast<Direction>(key);
+        _desiredTimestamp = event.timestamp;
+        _desiredCounter = event.counter;
+        _fDesiredMissed = false;
+    }
+}
+
+Direction InputState::Current()
+{
+    if (_desiredTurn != Direction::None)
+    {
+        return _desiredTurn;
+    }
+
+    Direction held = Direction::None;
+    Uint32 latest = 0;
+    for (int key = static_cast<int>(InputKey::Up); key <= static_cast<int>(InputKey::Right); key++)
+    {
+        if (_pressOrder[key] > latest)
+        {
+            latest = _pressOrder[key];
+            held = static_cast<Direction>(key);
+        }
+    }
+    return held;
+}
+
+bool InputState::TakeEscape()
+{
+    bool fEscape = _fEscape || (_pressOrder[static_cast<int>(InputKey::Escape)] != 0);
+    _fEscape = false;
+    return fEscape;
+}
+
+bool InputState::OnTick(Direction facing, Uint32 msNow)
+{
+    if (_desiredTurn == Direction::None)
+    {
+        return false;
+    }
+
+    if (facing == _desiredTurn)
+    {
+        _cTurnsTaken++;
+        if (_fDesiredMissed)
+        {
+            _cTurnsBuffered++;
+            _bufferedMs += msNow - _desiredTimestamp;
+        }
+        _desiredTurn = Direction::None;
+        return true;
+    }
+    _fDesiredMissed = true;
+    return false;
+}
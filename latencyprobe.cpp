@@ -0,0 +1,174 @@
+#include "include/latencyprobe.h"
+#include <stdio.h>
+#include <algorithm>
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    const int SpanCount = static_cast<int>(LatencyProbe::Span::Count);
+#ifdef ENABLE_PROFILER
+    const char *SpanNames[SpanCount] = { "Step", "Present", "Total" };      // Only the overlay shows them
+#endif
+    const char *DirectionNames[] = { "up", "down", "left", "right", "none" };
+    const Uint32 CsvCapacity = 16 * 1024;       // A couple of hundred lines, the writer empties it every 100ms
+
+    // Overlay layout, the same look as the profiler's panels
+    const int Margin = 4;
+    const int PanelWidth = 264;
+}
+
+LatencyProbe::LatencyProbe() :
+    _cSamples(0),
+    _cBuffered(0),
+    _pWriter(nullptr),
+    _pCsv(nullptr),
+    _msPerCounter(1000.0 / SDL_GetPerformanceFrequency())
+{
+    SDL_zero(_recent);
+    SDL_zero(_histogram);
+}
+
+LatencyProbe::~LatencyProbe()
+{
+    Close();
+}
+
+bool LatencyProbe::OpenCsv(DiskWriter *pWriter, const char *szFileName, const char *szConfig)
+{
+    SDL_assert(_pCsv == nullptr);
+    _pCsv = pWriter->Open(szFileName, CsvCapacity, DiskStream::Overflow::Drop);
+    if (_pCsv == nullptr)
+    {
+        printf("Failed to open %s for the latency samples\n", szFileName);
+        return false;
+    }
+    _pWriter = pWriter;
+
+    char szLine[256];
+    int cch = SDL_snprintf(szLine, sizeof(szLine), "# %s\nturn,tick,direction,buffered,input_to_tick_ms,tick_to_present_ms,input_to_present_ms\n",
+        szConfig);
+    _pCsv->Write(szLine, SDL_min(static_cast<Uint32>(cch), static_cast<Uint32>(sizeof(szLine) - 1)));
+    return true;
+}
+
+void LatencyProbe::Close()
+{
+    if (_pCsv != nullptr)
+    {
+        _pWriter->Close(_pCsv, nullptr, 0);
+        _pCsv = nullptr;
+        _pWriter = nullptr;
+    }
+}
+
+void LatencyProbe::AddSample(const TurnMark &turn, Uint64 presentCounter)
+{
+    // The key's time is estimated from SDL's millisecond timestamp, so it can come out a touch after the step
+    double ms[SpanCount];
+    ms[static_cast<int>(Span::InputToTick)] = (turn.tickCounter > turn.inputCounter) ? (turn.tickCounter - turn.inputCounter) * _msPerCounter : 0.0;
+    ms[static_cast<int>(Span::TickToPresent)] = (presentCounter - turn.tickCounter) * _msPerCounter;
+    ms[static_cast<int>(Span::InputToPresent)] = ms[static_cast<int>(Span::InputToTick)] + ms[static_cast<int>(Span::TickToPresent)];
+
+    if (_pCsv != nullptr)
+    {
+        char szLine[96];
+        int cch = SDL_snprintf(szLine, sizeof(szLine), "%u,%u,%s,%d,%.3f,%.3f,%.3f\n", turn.id, turn.tick,
+            DirectionNames[SDL_min(turn.direction, 4)], turn.fBuffered ? 1 : 0, ms[0], ms[1], ms[2]);
+        _pCsv->Write(szLine, SDL_min(static_cast<Uint32>(cch), static_cast<Uint32>(sizeof(szLine) - 1)));
+    }
+
+    // A buffered turn's time is mostly the player getting to the corner, which says nothing about the loop
+    if (turn.fBuffered)
+    {
+        _cBuffered++;
+        return;
+    }
+    for (int span = 0; span < SpanCount; span++)
+    {
+        _recent[span][_cSamples & (HistorySamples - 1)] = ms[span];
+        Uint32 bucket = static_cast<Uint32>(ms[span] * BucketsPerMs);
+        _histogram[span][SDL_min(bucket, HistogramBuckets - 1)]++;
+    }
+    _cSamples++;
+}
+
+// Upper edge of the bucket the percentile falls in
+double LatencyProbe::SessionPercentile(Span span, Uint32 percent)
+{
+    if (_cSamples == 0)
+    {
+        return 0.0;
+    }
+
+    Uint32 rank = (((_cSamples - 1) * percent) / 100) + 1;
+    Uint32 cSeen = 0;
+    Uint32 bucket = 0;
+    for (; bucket < HistogramBuckets - 1; bucket++)
+    {
+        cSeen += _histogram[static_cast<int>(span)][bucket];
+        if (cSeen >= rank)
+        {
+            break;
+        }
+    }
+    return static_cast<double>(bucket + 1) / BucketsPerMs;
+}
+
+void LatencyProbe::PrintSummary()
+{
+    if (_cSamples == 0)
+    {
+        return;
+    }
+    printf("Input to present over %u turns, %u buffered ones left out (p50/p95/p99 ms): step %.2f/%.2f/%.2f, present %.2f/%.2f/%.2f, total %.2f/%.2f/%.2f\n",
+        _cSamples, _cBuffered,
+        SessionPercentile(Span::InputToTick, 50), SessionPercentile(Span::InputToTick, 95), SessionPercentile(Span::InputToTick, 99),
+        SessionPercentile(Span::TickToPresent, 50), SessionPercentile(Span::TickToPresent, 95), SessionPercentile(Span::TickToPresent, 99),
+        SessionPercentile(Span::InputToPresent, 50), SessionPercentile(Span::InputToPresent, 95), SessionPercentile(Span::InputToPresent, 99));
+}
+
+#ifdef ENABLE_PROFILER
+void LatencyProbe::RenderOverlay(SDL_Renderer *pSDLRenderer, int yTop)
+{
+    Uint32 cRecent = SDL_min(_cSamples, HistorySamples);
+    if (cRecent == 0)
+    {
+        return;
+    }
+
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(pSDLRenderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(pSDLRenderer, 0, 0, 0, 192);
+    SDL_Rect panel = { 0, yTop, PanelWidth, OverlayHeight() };
+    SDL_RenderFillRect(pSDLRenderer, &panel);
+
+    // Percentiles of the recent turns in ms, the spans one to a line
+    char szLine[40];
+    int y = yTop + Margin;
+    SDL_SetRenderDrawColor(pSDLRenderer, 0, 255, 255, 255);
+    SDL_snprintf(szLine, sizeof(szLine), "%-8s %6s %6s %6s", "LATENCY", "P50", "P95", "P99");
+    DrawOverlayText(pSDLRenderer, Margin, y, szLine);
+    static double sorted[HistorySamples];
+    for (int span = 0; span < SpanCount; span++)
+    {
+        y += OverlayLineHeight();
+        SDL_memcpy(sorted, _recent[span], cRecent * sizeof(double));
+        std::sort(sorted, sorted + cRecent);
+        SDL_snprintf(szLine, sizeof(szLine), "%-8s %6.1f %6.1f %6.1f", SpanNames[span], sorted[((cRecent - 1) * 50) / 100],
+            sorted[((cRecent - 1) * 95) / 100], sorted[((cRecent - 1) * 99) / 100]);
+        DrawOverlayText(pSDLRenderer, Margin, y, szLine);
+    }
+    y += OverlayLineHeight();
+    SDL_snprintf(szLine, sizeof(szLine), "%u of %u turns", cRecent, _cSamples);
+    DrawOverlayText(pSDLRenderer, Margin, y, szLine);
+
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, blendMode);
+}
+
+int LatencyProbe::OverlayHeight()
+{
+    return ((SpanCount + 2) * OverlayLineHeight()) + (2 * Margin);
+}
+#endif
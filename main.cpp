@@ -4,13 +4,130 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-int main(int /*argc*/, char* /*argv*/[])
+// Headless ticks/second as the number of actors grows.  Each step is a fresh harness so the
+// roster (and everything sized from it) matches the actor count
+static int RunStressBenchmark(const GameOptions &options)
 {
-    GameHarness gameHarness;
+    const Uint16 ghostCounts[] = { 4, 16, 64, 256, 1024, 4096, 16384 };
+    const Uint64 frequency = SDL_GetPerformanceFrequency();
+
+    printf("%8s %8s %8s %12s %12s %10s\n", "players", "ghosts", "ticks", "ticks/sec", "us/tick", "catches");
+    for (size_t i = 0; i < SDL_arraysize(ghostCounts); i++)
+    {
+        GameOptions stepOptions = options;
+        stepOptions.fStress = true;
+        stepOptions.cGhosts = ghostCounts[i];
+
+        GameHarness gameHarness(stepOptions);
+        if (gameHarness.InitializeHeadless() != SDL_TRUE)
+        {
+            return 1;
+        }
+
+        // Cleanup is part of RunHeadless, so grab what we need to report first
+        Uint16 cPlayers = gameHarness.PlayerCount();
+        Uint64 start = SDL_GetPerformanceCounter();
+        gameHarness.RunHeadless(stepOptions.cBenchmarkTicks);
+        Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+
+        double seconds = static_cast<double>(elapsed) / frequency;
+        printf("%8u %8u %8u %12.0f %12.2f %10u\n", cPlayers, ghostCounts[i], stepOptions.cBenchmarkTicks,
+            stepOptions.cBenchmarkTicks / seconds, (seconds * 1000000.0) / stepOptions.cBenchmarkTicks,
+            gameHarness.GhostCatches());
+    }
+    return 0;
+}
+
+// A simulated game drawn offscreen into a video, no window or display needed.  Player 1 follows the replay,
+// with the roster it was recorded with, or without one everyone is on autopilot
+static int RenderVideo(const GameOptions &options)
+{
+    GameOptions videoOptions = options;
+    Replay replay;
+    const Replay *pReplay = nullptr;
+    Uint32 cTicks = (options.cVideoTicks > 0) ? options.cVideoTicks : (60 * Constants::FramesPerSecond);
+    if (options.szReplayFile != nullptr)
+    {
+        if (!replay.Load(options.szReplayFile))
+        {
+            return 1;
+        }
+        pReplay = &replay;
+        videoOptions.fStress = replay.Info().fStress;
+        videoOptions.cPlayers = replay.Info().cPlayers;
+        videoOptions.cGhosts = replay.Info().cGhosts;
+        cTicks = (options.cVideoTicks > 0) ? SDL_min(options.cVideoTicks, replay.Info().cTicks) : replay.Info().cTicks;
+    }
+
+    GameHarness gameHarness(videoOptions);
+    if (gameHarness.InitializeHeadless() != SDL_TRUE)
+    {
+        return 1;
+    }
+    FrameWriter video;
+    if (!video.Open(options.szVideoFile, Constants::ScreenWidth, Constants::ScreenHeight, Constants::FramesPerSecond))
+    {
+        return 1;
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    gameHarness.RunHeadless(cTicks, pReplay, &video);
+    double seconds = static_cast<double>(SDL_GetPerformanceCounter() - start) / SDL_GetPerformanceFrequency();
+    printf("%u frames written to %s in %.1f seconds (%.0f frames/sec), the writer held up the game %u times\n",
+        video.FramesWritten(), options.szVideoFile, seconds, video.FramesWritten() / seconds, video.Stalls());
+    return ((video.FramesWritten() == cTicks) && !video.Failed()) ? 0 : 1;
+}
+
+// A recording played back in the window, where it can be paused, stepped and scrubbed through
+static int ViewReplay(const GameOptions &options)
+{
+    Replay replay;
+    if (!replay.Load(options.szReplayFile))
+    {
+        return 1;
+    }
+    GameOptions viewOptions = options;
+    viewOptions.fStress = replay.Info().fStress;
+    viewOptions.cPlayers = replay.Info().cPlayers;
+    viewOptions.cGhosts = replay.Info().cGhosts;
+    viewOptions.szRecordFile = nullptr;
+
+    GameHarness gameHarness(viewOptions);
+    if (gameHarness.Initialize() != SDL_TRUE)
+    {
+        return 1;
+    }
+    gameHarness.RunReplay(replay);
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    GameOptions options;
+    if (!ParseGameOptions(argc, argv, &options))
+    {
+        return 1;
+    }
+
+    if (options.fStressBenchmark)
+    {
+        return RunStressBenchmark(options);
+    }
+    if (options.szVideoFile != nullptr)
+    {
+        return RenderVideo(options);
+    }
+    if (options.szReplayFile != nullptr)
+    {
+        return ViewReplay(options);
+    }
+
+    GameHarness gameHarness(options);
 
     if (gameHarness.Initialize() == SDL_TRUE)
-    { 
+    {
         gameHarness.Run();
     }
+    ALLOC_REPORT();
     return 0;
 }
@@ -0,0 +1,86 @@
+#include "include/occupancygrid.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+OccupancyGrid::OccupancyGrid(Uint16 rows, Uint16 cols, Uint16 cItemsMax, Arena *pArena) :
+    _cRows(rows),
+    _cCols(cols),
+    _cItemsMax(cItemsMax),
+    _pHeads(pArena->Allocate<Uint16>(rows * cols)),
+    _pNext(pArena->Allocate<Uint16>(cItemsMax)),
+    _pPrev(pArena->Allocate<Uint16>(cItemsMax)),
+    _pCell(pArena->Allocate<Uint16>(cItemsMax))
+{
+    Clear();
+}
+
+// The arrays belong to the arena
+OccupancyGrid::~OccupancyGrid()
+{
+}
+
+size_t OccupancyGrid::ArenaBytes(Uint16 rows, Uint16 cols, Uint16 cItemsMax)
+{
+    return Arena::Bytes<Uint16>(rows * cols) + (3 * Arena::Bytes<Uint16>(cItemsMax));
+}
+
+// The links are overwritten as items are added, so only the heads and cells need resetting
+void OccupancyGrid::Clear()
+{
+    for (int i = 0; i < _cRows * _cCols; i++)
+    {
+        _pHeads[i] = InvalidItem;
+    }
+
+    for (Uint16 i = 0; i < _cItemsMax; i++)
+    {
+        _pCell[i] = NoCell;
+    }
+}
+
+// Unlink from the old tile and push onto the front of the new one
+void OccupancyGrid::Move(Uint16 item, Uint16 row, Uint16 col)
+{
+    SDL_assert(row < _cRows && col < _cCols);
+    SDL_assert(item < _cItemsMax);
+
+    Uint16 cell = (row * _cCols) + col;
+    if (_pCell[item] == cell)
+    {
+        return;
+    }
+
+    Remove(item);
+    _pCell[item] = cell;
+    _pPrev[item] = InvalidItem;
+    _pNext[item] = _pHeads[cell];
+    if (_pHeads[cell] != InvalidItem)
+    {
+        _pPrev[_pHeads[cell]] = item;
+    }
+    _pHeads[cell] = item;
+}
+
+void OccupancyGrid::Remove(Uint16 item)
+{
+    SDL_assert(item < _cItemsMax);
+    if (_pCell[item] == NoCell)
+    {
+        return;
+    }
+
+    if (_pPrev[item] != InvalidItem)
+    {
+        _pNext[_pPrev[item]] = _pNext[item];
+    }
+    else
+    {
+        _pHeads[_pCell[item]] = _pNext[item];
+    }
+
+    if (_pNext[item] != InvalidItem)
+    {
+        _pPrev[_pNext[item]] = _pPrev[item];
+    }
+    _pCell[item] = NoCell;
+}
@@ -3,18 +3,17 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-Pinky::Pinky(TextureWrapper* pTextureWrapper) :
-    Ghost(pTextureWrapper, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
+Pinky::Pinky(TextureWrapper* pTextureWrapper, ActorStore* pActorStore) :
+    Ghost(pTextureWrapper, pActorStore, Constants::GhostSpriteWidth, Constants::GhostSpriteHeight,
         Constants::GhostTotalFrameCount, Constants::GhostTotalAnimationCount)
 {
 }
 
 bool Pinky::Initialize()
 {
-    // Each ghost will have its own set of frames, so each will override this method and implement
-    // the specific loading data
-    InitializeCommon();
-    LoadFrames(0, 0, 96, 8);
+    // Each ghost will have its own set of frames (shared by every ghost of the same type), so each will
+    // override this method and implement the specific loading data
+    InitializeCommon(AnimationRegistry::FrameTableId::Pinky, 96);
     _scatterRow = Constants::PinkyScatterRow;
     _scatterCol = Constants::PinkyScatterCol;
     _targetColor = Constants::PinkyDrawColor;
@@ -29,17 +28,14 @@ bool Pinky::Reset(Maze *pMaze)
     // There is no "penned" mode, just placement will take care of that.  Pinky is the only
     // ghost that is supposed to start outside of the pen, but since he's the only one for now
     // put him inside to test out that code path.
-    _currentRow = Constants::GhostPenRow;
-    _currentCol = Constants::GhostPenCol + 2;
-    ResetPosition(playerStartCoord.x, playerStartCoord.y);
-    SetVelocity(0, Constants::GhostBaseSpeed * -1.75);
+    SetCurrentCell(Constants::GhostPenRow, Constants::GhostPenCol + 2);
+    ResetPosition(IntToCoord(playerStartCoord.x), IntToCoord(playerStartCoord.y));
+    SetVelocity(0, -Constants::GhostSpeed);
 
-    SafeDelete<Decision>(_pNextDecision);
-    SafeDelete<Decision>(_pCurrentDecision);
-    _pCurrentDecision = new Decision(Constants::GhostPenRow, Constants::GhostPenCol + 2, CurrentDirection());
+    ResetDecisions(Constants::GhostPenRow, Constants::GhostPenCol + 2);
     _penTimer.Reset();
     SetPenTimerMax(2000);
-    _mode = Mode::Chase;
+    SetMode(Mode::Chase);
     _fScatter = false;
 
     return true;
@@ -50,7 +46,7 @@ Direction Pinky::MakeBranchDecision(Uint16 nRow, Uint16 nCol, Player* pPlayer, M
     // Pinky's target tile is 4 tiles ahead of the player's current tile
     Direction result = CurrentDirection();
 
-    SDL_Point playerPoint = { static_cast<int>(pPlayer->X()), static_cast<int>(pPlayer->Y()) };
+    SDL_Point playerPoint = { CoordToInt(pPlayer->X()), CoordToInt(pPlayer->Y()) };
     if (_fScatter)
     {
         _targetRow = _scatterRow;
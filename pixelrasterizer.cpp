@@ -0,0 +1,390 @@
+#include "include/pixelrasterizer.h"
+#include "include/constants.h"
+#include "SDL_image.h"
+#include <stdio.h>
+
+// SSE2 is always there on x64, AVX2 only when the build asks for it (make AVX2=1, or /arch:AVX2).
+// DISABLE_SIMD leaves just the portable version, for checking the others against
+#ifndef DISABLE_SIMD
+#if defined(__AVX2__)
+#define RASTER_AVX2
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define RASTER_SSE2
+#include <emmintrin.h>
+#endif
+#endif
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    Uint8 Luma(int r, int g, int b)
+    {
+        return static_cast<Uint8>(((77 * r) + (150 * g) + (29 * b) + 128) >> 8);
+    }
+
+    // Rounds toward negative infinity, sprites can be partly off the left or top of the map
+    int FloorDiv(int value, int divisor)
+    {
+        return (value >= 0) ? (value / divisor) : -((divisor - 1 - value) / divisor);
+    }
+
+    // The widest copies the build allows first, then whatever's left a word and a byte at a time
+    void CopyRow(Uint8 *pTarget, const Uint8 *pSource, int cb)
+    {
+        int i = 0;
+#ifdef RASTER_AVX2
+        for (; i + 32 <= cb; i += 32)
+        {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pTarget + i),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + i)));
+        }
+#endif
+#ifdef RASTER_SSE2
+        for (; i + 16 <= cb; i += 16)
+        {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget + i),
+                _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i)));
+        }
+#endif
+        for (; i + 8 <= cb; i += 8)
+        {
+            Uint64 source;
+            SDL_memcpy(&source, pSource + i, 8);
+            SDL_memcpy(pTarget + i, &source, 8);
+        }
+        for (; i < cb; i++)
+        {
+            pTarget[i] = pSource[i];
+        }
+    }
+
+    // target = (source & mask) | (target & ~mask), the mask is 0xFF or 0 per pixel
+    void MaskedCopyRow(Uint8 *pTarget, const Uint8 *pSource, const Uint8 *pMask, int cb)
+    {
+        int i = 0;
+#ifdef RASTER_AVX2
+        for (; i + 32 <= cb; i += 32)
+        {
+            __m256i source = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource + i));
+            __m256i mask = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pMask + i));
+            __m256i target = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pTarget + i));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(pTarget + i), _mm256_blendv_epi8(target, source, mask));
+        }
+#endif
+#ifdef RASTER_SSE2
+        for (; i + 16 <= cb; i += 16)
+        {
+            __m128i source = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + i));
+            __m128i mask = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pMask + i));
+            __m128i target = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pTarget + i));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pTarget + i),
+                _mm_or_si128(_mm_and_si128(mask, source), _mm_andnot_si128(mask, target)));
+        }
+#endif
+        for (; i + 8 <= cb; i += 8)
+        {
+            Uint64 source;
+            Uint64 mask;
+            Uint64 target;
+            SDL_memcpy(&source, pSource + i, 8);
+            SDL_memcpy(&mask, pMask + i, 8);
+            SDL_memcpy(&target, pTarget + i, 8);
+            target = (source & mask) | (target & ~mask);
+            SDL_memcpy(pTarget + i, &target, 8);
+        }
+        for (; i < cb; i++)
+        {
+            pTarget[i] = (pSource[i] & pMask[i]) | (pTarget[i] & ~pMask[i]);
+        }
+    }
+}
+
+PixelRasterizer::PixelRasterizer() :
+    _scale(1),
+    _rows(0),
+    _cols(0),
+    _tileSize(0),
+    _tilesPerAtlasRow(0),
+    _width(0),
+    _height(0)
+{
+    SDL_zero(_tiles);
+    SDL_zero(_sprites);
+    SDL_zero(_mapBounds);
+}
+
+PixelRasterizer::~PixelRasterizer()
+{
+    FreeAtlas(&_tiles);
+    FreeAtlas(&_sprites);
+}
+
+bool PixelRasterizer::Initialize(const char *szTilesImage, const char *szSpritesImage, SDL_Rect mapBounds,
+    Uint16 rows, Uint16 cols, Uint16 tileSize, int scale)
+{
+    SDL_assert((scale == 1) || (scale == 2) || (scale == 4));
+    SDL_assert((tileSize % scale) == 0);
+    _scale = scale;
+    _mapBounds = mapBounds;
+    _rows = rows;
+    _cols = cols;
+    _tileSize = tileSize / scale;
+    _width = mapBounds.w / scale;
+    _height = mapBounds.h / scale;
+
+    FreeAtlas(&_tiles);
+    FreeAtlas(&_sprites);
+    if (!LoadAtlas(szTilesImage, false, &_tiles) || !LoadAtlas(szSpritesImage, true, &_sprites))
+    {
+        return false;
+    }
+    _tilesPerAtlasRow = _tiles.width / _tileSize;
+    return true;
+}
+
+// Each output pixel is the average of the scale x scale block under it.  With a color key only the
+// pixels that aren't keyed out count, and the output pixel is drawn if at least half of them are
+bool PixelRasterizer::LoadAtlas(const char *szFileName, bool fColorKey, Atlas *pAtlas)
+{
+    SDL_Surface *pLoaded = IMG_Load(szFileName);
+    if (pLoaded == nullptr)
+    {
+        printf("IMG_Load(%s) failed, error = %s\n", szFileName, IMG_GetError());
+        return false;
+    }
+    SDL_Surface *pSurface = SDL_ConvertSurfaceFormat(pLoaded, SDL_PIXELFORMAT_ARGB8888, 0);
+    SDL_FreeSurface(pLoaded);
+    if (pSurface == nullptr)
+    {
+        printf("SDL_ConvertSurfaceFormat() failed for %s, error = %s\n", szFileName, SDL_GetError());
+        return false;
+    }
+
+    pAtlas->width = pSurface->w / _scale;
+    pAtlas->height = pSurface->h / _scale;
+    pAtlas->pGray = new Uint8[pAtlas->width * pAtlas->height];
+    pAtlas->pMask = fColorKey ? new Uint8[pAtlas->width * pAtlas->height] : nullptr;
+
+    const SDL_Color &key = Constants::SDLColorMagenta;
+    const Uint32 keyPixel = (static_cast<Uint32>(key.r) << 16) | (static_cast<Uint32>(key.g) << 8) | key.b;
+    SDL_LockSurface(pSurface);
+    for (int y = 0; y < pAtlas->height; y++)
+    {
+        for (int x = 0; x < pAtlas->width; x++)
+        {
+            int r = 0;
+            int g = 0;
+            int b = 0;
+            int cOpaque = 0;
+            for (int dy = 0; dy < _scale; dy++)
+            {
+                const Uint32 *pRow = reinterpret_cast<const Uint32*>(
+                    static_cast<const Uint8*>(pSurface->pixels) + (((y * _scale) + dy) * pSurface->pitch));
+                for (int dx = 0; dx < _scale; dx++)
+                {
+                    Uint32 pixel = pRow[(x * _scale) + dx];
+                    if (fColorKey && ((pixel & 0x00FFFFFF) == keyPixel))
+                    {
+                        continue;
+                    }
+                    r += (pixel >> 16) & 0xFF;
+                    g += (pixel >> 8) & 0xFF;
+                    b += pixel & 0xFF;
+                    cOpaque++;
+                }
+            }
+
+            int index = (y * pAtlas->width) + x;
+            bool fDrawn = (cOpaque * 2 >= _scale * _scale);
+            pAtlas->pGray[index] = fDrawn ? Luma(r / cOpaque, g / cOpaque, b / cOpaque) : 0;
+            if (pAtlas->pMask != nullptr)
+            {
+                pAtlas->pMask[index] = fDrawn ? 0xFF : 0;
+            }
+        }
+    }
+    SDL_UnlockSurface(pSurface);
+    SDL_FreeSurface(pSurface);
+    return true;
+}
+
+void PixelRasterizer::FreeAtlas(Atlas *pAtlas)
+{
+    delete[] pAtlas->pGray;
+    delete[] pAtlas->pMask;
+    SDL_zerop(pAtlas);
+}
+
+void PixelRasterizer::Draw(const Uint16 *pMapIndicies, const SpriteDraw *pSprites, Uint32 cSprites, Uint8 *pPixels) const
+{
+    // The maze covers the whole output, so every pixel gets written and there's no need to clear it
+    for (int r = 0; r < _rows; r++)
+    {
+        for (int c = 0; c < _cols; c++)
+        {
+            Uint16 tile = pMapIndicies[(r * _cols) + c];
+            const Uint8 *pSource = _tiles.pGray + ((tile / _tilesPerAtlasRow) * _tileSize * _tiles.width) +
+                ((tile % _tilesPerAtlasRow) * _tileSize);
+            Uint8 *pTarget = pPixels + (r * _tileSize * _width) + (c * _tileSize);
+            for (int y = 0; y < _tileSize; y++)
+            {
+                CopyRow(pTarget + (y * _width), pSource + (y * _tiles.width), _tileSize);
+            }
+        }
+    }
+
+    // Clipped to the maze the same way the screen is
+    for (Uint32 i = 0; i < cSprites; i++)
+    {
+        const SpriteDraw &sprite = pSprites[i];
+        if (!sprite.fVisible)
+        {
+            continue;
+        }
+
+        int xSource = sprite.source.x / _scale;
+        int ySource = sprite.source.y / _scale;
+        int xTarget = FloorDiv(sprite.target.x - _mapBounds.x, _scale);
+        int yTarget = FloorDiv(sprite.target.y - _mapBounds.y, _scale);
+        int width = sprite.target.w / _scale;
+        int height = sprite.target.h / _scale;
+        if (xTarget < 0)
+        {
+            xSource -= xTarget;
+            width += xTarget;
+            xTarget = 0;
+        }
+        if (yTarget < 0)
+        {
+            ySource -= yTarget;
+            height += yTarget;
+            yTarget = 0;
+        }
+        width = SDL_min(width, _width - xTarget);
+        height = SDL_min(height, _height - yTarget);
+        if ((width <= 0) || (height <= 0))
+        {
+            continue;
+        }
+
+        for (int y = 0; y < height; y++)
+        {
+            int sourceOffset = ((ySource + y) * _sprites.width) + xSource;
+            MaskedCopyRow(pPixels + ((yTarget + y) * _width) + xTarget, _sprites.pGray + sourceOffset,
+                _sprites.pMask + sourceOffset, width);
+        }
+    }
+}
+
+void PixelRasterizer::Draw(const RenderSnapshot &snapshot, Uint8 *pPixels) const
+{
+    Draw(snapshot.pMapIndicies, snapshot.pSprites, snapshot.cPlayers + snapshot.cGhosts, pPixels);
+}
+
+RasterPool::RasterPool() :
+    _cWorkers(0),
+    _pDone(nullptr),
+    _fStopping(false),
+    _pRasterizer(nullptr),
+    _pSnapshots(nullptr),
+    _cSnapshots(0),
+    _pPixels(nullptr)
+{
+}
+
+RasterPool::~RasterPool()
+{
+    Stop();
+}
+
+bool RasterPool::Start(int cThreads)
+{
+    SDL_assert((_cWorkers == 0) && (cThreads >= 1) && (cThreads <= MaxWorkers + 1));
+    _pDone = SDL_CreateSemaphore(0);
+    _fStopping = false;
+    for (int i = 0; i < cThreads - 1; i++)
+    {
+        Worker &worker = _workers[_cWorkers];
+        worker.pPool = this;
+        worker.index = _cWorkers + 1;
+        worker.pStart = SDL_CreateSemaphore(0);
+        worker.pThread = SDL_CreateThread(WorkerThread, "RasterWorker", &worker);
+        if (worker.pThread == nullptr)
+        {
+            printf("SDL_CreateThread() failed, error = %s\n", SDL_GetError());
+            SDL_DestroySemaphore(worker.pStart);
+            Stop();
+            return false;
+        }
+        _cWorkers++;
+    }
+    return true;
+}
+
+void RasterPool::Stop()
+{
+    _fStopping = true;
+    for (int i = 0; i < _cWorkers; i++)
+    {
+        SDL_SemPost(_workers[i].pStart);
+    }
+    for (int i = 0; i < _cWorkers; i++)
+    {
+        SDL_WaitThread(_workers[i].pThread, nullptr);
+        SDL_DestroySemaphore(_workers[i].pStart);
+    }
+    _cWorkers = 0;
+    SDL_DestroySemaphore(_pDone);
+    _pDone = nullptr;
+}
+
+void RasterPool::DrawAll(const PixelRasterizer &rasterizer, const RenderSnapshot *pSnapshots, Uint32 cSnapshots, Uint8 *pPixels)
+{
+    // The semaphores order these writes before the workers read them
+    _pRasterizer = &rasterizer;
+    _pSnapshots = pSnapshots;
+    _cSnapshots = cSnapshots;
+    _pPixels = pPixels;
+    for (int i = 0; i < _cWorkers; i++)
+    {
+        SDL_SemPost(_workers[i].pStart);
+    }
+    DrawShare(0);
+    for (int i = 0; i < _cWorkers; i++)
+    {
+        SDL_SemWait(_pDone);
+    }
+}
+
+// Each thread takes a contiguous run of the batch, so no two write the same frame
+void RasterPool::DrawShare(int index)
+{
+    Uint32 cThreads = static_cast<Uint32>(_cWorkers + 1);
+    Uint32 first = (_cSnapshots * index) / cThreads;
+    Uint32 last = (_cSnapshots * (index + 1)) / cThreads;
+    size_t cbFrame = _pRasterizer->FrameBytes();
+    for (Uint32 i = first; i < last; i++)
+    {
+        _pRasterizer->Draw(_pSnapshots[i], _pPixels + (i * cbFrame));
+    }
+}
+
+int RasterPool::WorkerThread(void *pData)
+{
+    Worker *pWorker = static_cast<Worker*>(pData);
+    RasterPool *pPool = pWorker->pPool;
+    for (;;)
+    {
+        SDL_SemWait(pWorker->pStart);
+        if (pPool->_fStopping)
+        {
+            break;
+        }
+        pPool->DrawShare(pWorker->index);
+        SDL_SemPost(pPool->_pDone);
+    }
+    return 0;
+}
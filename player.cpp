@@ -2,26 +2,47 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-Player::Player(TextureWrapper *pTextureWrapper) :
-    Sprite(pTextureWrapper, Constants::PlayerSpriteWidth, Constants::PlayerSpriteHeight,
-        Constants::PlayerTotalFrameCount, Constants::PlayerTotalAnimationCount),
-    _mode(Mode::Normal)   
+Player::Player(TextureWrapper *pTextureWrapper, ActorStore *pActorStore) :
+    Sprite(pTextureWrapper, pActorStore, Constants::PlayerSpriteWidth, Constants::PlayerSpriteHeight,
+        Constants::PlayerTotalFrameCount, Constants::PlayerTotalAnimationCount)
 {
+    SetMode(Mode::Normal);
 }
 
 Player::~Player()
 {
 }
 
+// Mode changes (i.e. the warps) show up in the trace
+void Player::SetMode(Mode mode)
+{
+#ifdef ENABLE_PROFILER
+    static const char *ModeNames[] = { "Player normal", "Player warping out", "Player warping in" };
+    if (mode != GetMode())
+    {
+        TRACE_INSTANT(Trace(), ModeNames[static_cast<int>(mode)], "player", Id(), nullptr);
+    }
+#endif
+    SetActorMode(static_cast<Uint8>(mode));
+}
+
 bool Player::Initialize()
 {
-    LoadFrames(0, 0, 0, 10);
-    LoadFrames(10, 0, Constants::PlayerSpriteHeight, 10);
-    LoadAnimationSequence(Constants::AnimationIndexLeft, AnimationType::Loop, Constants::PlayerAnimation_LEFT, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexRight, AnimationType::Loop, Constants::PlayerAnimation_RIGHT, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexUp, AnimationType::Loop, Constants::PlayerAnimation_UP, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexDown, AnimationType::Loop, Constants::PlayerAnimation_DOWN, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
-    LoadAnimationSequence(Constants::AnimationIndexDeath, AnimationType::Once, Constants::PlayerAnimation_DEATH, Constants::PlayerAnimationDeathFrameCount, Constants::PlayerAnimationSpeed);
+    // Frames and clips are shared, only the first player through needs to load them
+    if (UseFrameTable(AnimationRegistry::FrameTableId::Player))
+    {
+        LoadFrames(0, 0, 0, 10);
+        LoadFrames(10, 0, Constants::PlayerSpriteHeight, 10);
+    }
+
+    if (UseClipSet(AnimationRegistry::ClipSetId::Player))
+    {
+        LoadAnimationSequence(Constants::AnimationIndexLeft, AnimationType::Loop, Constants::PlayerAnimation_LEFT, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexRight, AnimationType::Loop, Constants::PlayerAnimation_RIGHT, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexUp, AnimationType::Loop, Constants::PlayerAnimation_UP, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexDown, AnimationType::Loop, Constants::PlayerAnimation_DOWN, Constants::PlayerAnimationFrameCount, Constants::PlayerAnimationSpeed);
+        LoadAnimationSequence(Constants::AnimationIndexDeath, AnimationType::Once, Constants::PlayerAnimation_DEATH, Constants::PlayerAnimationDeathFrameCount, Constants::PlayerAnimationSpeed);
+    }
     SetFrameOffset(1 - (Constants::PlayerSpriteWidth / 2), 1 - (Constants::PlayerSpriteHeight / 2));
     return true;
 }
@@ -31,17 +52,17 @@ bool Player::Reset(Maze *pMaze)
     SetAnimation(Constants::AnimationIndexLeft);
     SDL_Point playerStartCoord = pMaze->GetTileCoordinates(Constants::PlayerStartRow, Constants::PlayerStartCol);
     playerStartCoord.x += Constants::TileWidth / 2;
-    ResetPosition(playerStartCoord.x, playerStartCoord.y);
-    SetVelocity(Constants::PlayerMaxSpeed * -.75, 0);  // Eventually speeds will be based on level, dots eaten, etc
-    _mode = Mode::Normal;
+    ResetPosition(IntToCoord(playerStartCoord.x), IntToCoord(playerStartCoord.y));
+    SetVelocity(-Constants::PlayerSpeed, 0);  // Eventually speeds will be based on level, dots eaten, etc
+    SetMode(Mode::Normal);
     return true;
 }
 
+// Movement itself has already been applied by the ActorStore this frame, so this
+// reacts to where we ended up
 void Player::Update(Maze* pMaze, Direction inputDirection)
 {
-    Sprite::Update();
-
-    switch (_mode)
+    switch (GetMode())
     {
     case Mode::Normal:
     {
@@ -50,7 +71,7 @@ void Player::Update(Maze* pMaze, Direction inputDirection)
         {
             // If we've reached a warp tile, stop taking input and let the warp
             // subroutine handle movement
-            _mode = Mode::WarpingOut;
+            SetMode(Mode::WarpingOut);
         }
         else
         {
@@ -70,13 +91,13 @@ void Player::Update(Maze* pMaze, Direction inputDirection)
             // Place at other end of screen out of view...
             if (DX() > 0)
             {
-                ResetPosition(mapRect.x - Width(), Y());
-                _mode = Mode::WarpingIn;
+                ResetPosition(IntToCoord(mapRect.x - Width()), Y());
+                SetMode(Mode::WarpingIn);
             }
             else if (DX() < 0)
             {
-                ResetPosition(mapRect.x + mapRect.w + Width(), Y());
-                _mode = Mode::WarpingIn;
+                ResetPosition(IntToCoord(mapRect.x + mapRect.w + Width()), Y());
+                SetMode(Mode::WarpingIn);
             }
         }
         break;
@@ -84,23 +105,22 @@ void Player::Update(Maze* pMaze, Direction inputDirection)
     case Mode::WarpingIn:
     {
             // Just keep moving until back in view...
-        SDL_Point playerPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
-        Uint16 row, col;
-        pMaze->GetTileRowCol(playerPoint, row, col);
+        Uint16 row = 0;
+        Uint16 col = 0;
+        GetTile(row, col);
         if ((row == Constants::WarpRow) && ((col == Constants::WarpColPlayerLeft + 1) || (col == Constants::WarpColPlayerRight - 1)))
         {
             // Start accepting player input again..
-            _mode = Mode::Normal;
+            SetMode(Mode::Normal);
         }
         break;
     }
     }
 }
 
-void Player::GetTilePlayerFacingWithOriginalBug(Maze* pMaze, Uint16 cSpaces, Uint16 &row, Uint16 &col)
+void Player::GetTilePlayerFacingWithOriginalBug(Maze* /*pMaze*/, Uint16 cSpaces, Uint16 &row, Uint16 &col)
 {
-    SDL_Point playerPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
-    pMaze->GetTileRowCol(playerPoint, row, col);
+    GetTile(row, col);
 
     Direction playerFacing = Facing();
     switch (playerFacing)
@@ -169,10 +189,9 @@ void Player::ProcessPlayerInput(Maze* pMaze, Direction direction)
         return;
     }
 
-    SDL_Point playerPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
     Uint16 playerRow = 0;
     Uint16 playerCol = 0;
-    pMaze->GetTileRowCol(playerPoint, playerRow, playerCol);
+    GetTile(playerRow, playerCol);
 
     // Given a player's current state (location, direction, animation) check if the player can move in a given direction, and if
     // so position the player on the new track at the new velocity
@@ -213,25 +232,25 @@ void Player::ProcessPlayerInput(Maze* pMaze, Direction direction)
     {
         // Set a new animation and position the player with a new velocity
         SDL_Point tilePoint = pMaze->GetTileCoordinates(playerRow, playerCol);
-        ResetPosition(tilePoint.x, tilePoint.y);
+        ResetPosition(IntToCoord(tilePoint.x), IntToCoord(tilePoint.y));
 
         // Set Direction
         switch (direction)
         {
         case Direction::Up:
-            SetVelocity(0, Constants::PlayerMaxSpeed * -.75);
+            SetVelocity(0, -Constants::PlayerSpeed);
             SetAnimation(Constants::AnimationIndexUp);
             break;
         case Direction::Down:
-            SetVelocity(0, Constants::PlayerMaxSpeed * .75);
+            SetVelocity(0, Constants::PlayerSpeed);
             SetAnimation(Constants::AnimationIndexDown);
             break;
         case Direction::Left:
-            SetVelocity(Constants::PlayerMaxSpeed * -.75, 0);
+            SetVelocity(-Constants::PlayerSpeed, 0);
             SetAnimation(Constants::AnimationIndexLeft);
             break;
         case Direction::Right:
-            SetVelocity(Constants::PlayerMaxSpeed * .75, 0);
+            SetVelocity(Constants::PlayerSpeed, 0);
             SetAnimation(Constants::AnimationIndexRight);
             break;
         case Direction::None:
@@ -243,7 +262,7 @@ void Player::ProcessPlayerInput(Maze* pMaze, Direction direction)
 // Don't allow the player to wander through a solid wall
 void Player::DoBoundsCheck(Maze* pMaze)
 {
-    SDL_Point playerPoint = { static_cast<int>(X()), static_cast<int>(Y()) };
+    SDL_Point playerPoint = { CoordToInt(X()), CoordToInt(Y()) };
 
     // Need to check bounds in direction moving (account for width of half the sprite)
     // This is because the sprite is double the size of the tiles and placed along the centerline
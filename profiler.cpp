@@ -0,0 +1,264 @@
+#include "include/profiler.h"
+
+#ifdef ENABLE_PROFILER
+#include <algorithm>
+#include "include/constants.h"
+#include "include/tracerecorder.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+namespace
+{
+    const int PhaseCount = static_cast<int>(ProfilePhase::Count);
+
+    const char *PhaseNames[PhaseCount] = { "Pump", "Input", "Player", "Ghost", "Collide", "Render", "Present", "Delay" };
+    const SDL_Color PhaseColors[PhaseCount] =
+    {
+        { 128, 128, 128, 255 },
+        { 0, 255, 255, 255 },
+        { 255, 255, 0, 255 },
+        { 255, 0, 0, 255 },
+        { 255, 128, 0, 255 },
+        { 0, 128, 255, 255 },
+        { 255, 0, 255, 255 },
+        { 0, 96, 0, 255 }
+    };
+
+    // 3x5 pixel font, one bit per pixel, rows top to bottom and the leftmost pixel is the high bit
+    const Uint16 DigitGlyphs[] = { 0x7B6F, 0x2C97, 0x73E7, 0x73CF, 0x5BC9, 0x79CF, 0x79EF, 0x7249, 0x7BEF, 0x7BCF };
+    const Uint16 LetterGlyphs[] =
+    {
+        0x2BED, 0x6BAE, 0x3923, 0x6B6E, 0x79A7, 0x79A4, 0x396B, 0x5BED, 0x7497,
+        0x126A, 0x5BAD, 0x4927, 0x5FED, 0x6B6D, 0x2B6A, 0x6BA4, 0x2B73, 0x6BAD,
+        0x388E, 0x7492, 0x5B6F, 0x5B6A, 0x5BFD, 0x5AAD, 0x5A92, 0x72A7
+    };
+    const Uint16 PeriodGlyph = 0x0002;
+    const int GlyphScale = 2;                       // Screen pixels per font pixel
+    const int GlyphAdvance = 4 * GlyphScale;
+    const int LineHeight = 7 * GlyphScale;
+
+    // Overlay layout
+    const int GraphFrames = 128;
+    const int GraphBarWidth = 2;
+    const int GraphHeight = 64;
+    const int Margin = 4;
+    const int PanelWidth = GraphFrames * GraphBarWidth + (2 * Margin);
+    const int PanelHeight = ((PhaseCount + 2) * LineHeight) + GraphHeight + (3 * Margin);
+
+    // No font library, so the overlay spells things out with rectangles.  Letters (all shown as upper
+    // case), digits and '.' only, anything else is a space
+    void DrawText(SDL_Renderer *pSDLRenderer, int x, int y, const char *szText)
+    {
+        for (const char *pch = szText; *pch != '\0'; pch++, x += GlyphAdvance)
+        {
+            Uint16 glyph = 0;
+            if ((*pch >= '0') && (*pch <= '9'))
+            {
+                glyph = DigitGlyphs[*pch - '0'];
+            }
+            else if ((*pch >= 'A') && (*pch <= 'Z'))
+            {
+                glyph = LetterGlyphs[*pch - 'A'];
+            }
+            else if ((*pch >= 'a') && (*pch <= 'z'))
+            {
+                glyph = LetterGlyphs[*pch - 'a'];
+            }
+            else if (*pch == '.')
+            {
+                glyph = PeriodGlyph;
+            }
+
+            for (int bit = 0; bit < 15; bit++)
+            {
+                if (glyph & (0x4000 >> bit))
+                {
+                    SDL_Rect pixel = { x + ((bit % 3) * GlyphScale), y + ((bit / 3) * GlyphScale), GlyphScale, GlyphScale };
+                    SDL_RenderFillRect(pSDLRenderer, &pixel);
+                }
+            }
+        }
+    }
+
+    void SetDrawColor(SDL_Renderer *pSDLRenderer, const SDL_Color &color)
+    {
+        SDL_SetRenderDrawColor(pSDLRenderer, color.r, color.g, color.b, color.a);
+    }
+
+    // value at the given percentile of the first count entries, reorders them
+    double Percentile(double *pValues, Uint32 count, Uint32 percent)
+    {
+        Uint32 index = ((count - 1) * percent) / 100;
+        std::nth_element(pValues, pValues + index, pValues + count);
+        return pValues[index];
+    }
+}
+
+const char* XplatGameTutorial::PacManClone::ProfilePhaseName(ProfilePhase phase)
+{
+    return PhaseNames[static_cast<int>(phase)];
+}
+
+void XplatGameTutorial::PacManClone::DrawOverlayText(SDL_Renderer *pSDLRenderer, int x, int y, const char *szText)
+{
+    DrawText(pSDLRenderer, x, y, szText);
+}
+
+int XplatGameTutorial::PacManClone::OverlayLineHeight()
+{
+    return LineHeight;
+}
+
+FrameProfiler::FrameProfiler() :
+    _cFramesWritten(0),
+    _fOverlayVisible(false),
+    _pTrace(nullptr),
+    _msPerTick(1000.0 / SDL_GetPerformanceFrequency())
+{
+    SDL_zero(_ring);
+    SDL_zero(_current);
+    SDL_zero(_totals);
+}
+
+void FrameProfiler::BeginFrame()
+{
+    SDL_zero(_current);
+    _current.startTicks = SDL_GetPerformanceCounter();
+}
+
+void FrameProfiler::AddPhase(ProfilePhase phase, Uint64 startTicks, Uint64 endTicks)
+{
+    _current.phaseTicks[static_cast<int>(phase)] += endTicks - startTicks;
+    if (_pTrace != nullptr)
+    {
+        _pTrace->Span(ProfilePhaseName(phase), "phase", startTicks, endTicks - startTicks);
+    }
+}
+
+// Publish the frame.  Write the slot first, then bump the counter so readers never see a frame
+// before it is complete
+void FrameProfiler::EndFrame()
+{
+    _current.frameTicks = SDL_GetPerformanceCounter() - _current.startTicks;
+    if (_pTrace != nullptr)
+    {
+        _pTrace->Span("Frame", "frame", _current.startTicks, _current.frameTicks);
+    }
+
+    _totals.frameTicks += _current.frameTicks;
+    for (int phase = 0; phase < PhaseCount; phase++)
+    {
+        _totals.phaseTicks[phase] += _current.phaseTicks[phase];
+    }
+
+    Uint32 frame = _cFramesWritten.load(std::memory_order_relaxed);
+    _ring[frame & (HistoryFrames - 1)] = _current;
+    _cFramesWritten.store(frame + 1, std::memory_order_release);
+}
+
+// The slot can be overwritten while we copy it, so check the frame was still in the ring afterwards
+bool FrameProfiler::GetFrame(Uint32 frame, FrameSample *pSample) const
+{
+    if ((FramesWritten() - frame - 1) >= HistoryFrames)
+    {
+        return false;
+    }
+
+    *pSample = _ring[frame & (HistoryFrames - 1)];
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (FramesWritten() - frame) <= HistoryFrames;
+}
+
+int FrameProfiler::OverlayHeight()
+{
+    return PanelHeight;
+}
+
+void FrameProfiler::RenderOverlay(SDL_Renderer *pSDLRenderer, int yTop, const char *szTitle)
+{
+    const double GraphMaxMs = 2.0 * Constants::TicksPerFrame;
+
+    // Gather what's in the ring, newest last
+    static FrameSample samples[HistoryFrames];
+    static double values[HistoryFrames];
+    Uint32 cSamples = 0;
+    Uint32 cFrames = FramesWritten();
+    for (Uint32 frame = (cFrames > HistoryFrames) ? cFrames - HistoryFrames : 0; frame < cFrames; frame++)
+    {
+        if (GetFrame(frame, &samples[cSamples]))
+        {
+            cSamples++;
+        }
+    }
+    if (cSamples == 0)
+    {
+        return;
+    }
+
+    SDL_BlendMode blendMode;
+    SDL_GetRenderDrawBlendMode(pSDLRenderer, &blendMode);
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, SDL_BLENDMODE_BLEND);
+    SDL_SetRenderDrawColor(pSDLRenderer, 0, 0, 0, 192);
+    SDL_Rect panel = { 0, yTop, PanelWidth, PanelHeight };
+    SDL_RenderFillRect(pSDLRenderer, &panel);
+
+    // Table of averages and p99s in ms, with the whole frame at the bottom
+    char szLine[32];
+    int y = yTop + Margin;
+    SDL_SetRenderDrawColor(pSDLRenderer, 255, 255, 255, 255);
+    SDL_snprintf(szLine, sizeof(szLine), "%-8s %6s %6s", szTitle, "AVG", "P99");
+    DrawText(pSDLRenderer, Margin, y, szLine);
+    for (int phase = 0; phase <= PhaseCount; phase++)
+    {
+        y += LineHeight;
+        double total = 0.0;
+        for (Uint32 i = 0; i < cSamples; i++)
+        {
+            Uint64 ticks = (phase < PhaseCount) ? samples[i].phaseTicks[phase] : samples[i].frameTicks;
+            values[i] = ticks * _msPerTick;
+            total += values[i];
+        }
+
+        SDL_snprintf(szLine, sizeof(szLine), "%-8s %6.2f %6.2f", (phase < PhaseCount) ? PhaseNames[phase] : "Frame",
+            total / cSamples, Percentile(values, cSamples, 99));
+        if (phase < PhaseCount)
+        {
+            SetDrawColor(pSDLRenderer, PhaseColors[phase]);
+        }
+        else
+        {
+            SDL_SetRenderDrawColor(pSDLRenderer, 255, 255, 255, 255);
+        }
+        DrawText(pSDLRenderer, Margin, y, szLine);
+    }
+
+    // Frame time graph, one bar per frame stacked by phase.  The line is the frame budget
+    int graphBottom = yTop + PanelHeight - Margin;
+    double pixelsPerMs = GraphHeight / GraphMaxMs;
+    Uint32 first = (cSamples > GraphFrames) ? cSamples - GraphFrames : 0;
+    for (Uint32 i = first; i < cSamples; i++)
+    {
+        int x = Margin + ((i - first) * GraphBarWidth);
+        int barBottom = graphBottom;
+        for (int phase = 0; phase < PhaseCount; phase++)
+        {
+            int height = static_cast<int>(samples[i].phaseTicks[phase] * _msPerTick * pixelsPerMs);
+            height = SDL_min(height, barBottom - (graphBottom - GraphHeight));
+            if (height > 0)
+            {
+                SetDrawColor(pSDLRenderer, PhaseColors[phase]);
+                SDL_Rect bar = { x, barBottom - height, GraphBarWidth, height };
+                SDL_RenderFillRect(pSDLRenderer, &bar);
+                barBottom -= height;
+            }
+        }
+    }
+    int budgetY = graphBottom - static_cast<int>(Constants::TicksPerFrame * pixelsPerMs);
+    SDL_SetRenderDrawColor(pSDLRenderer, 255, 255, 255, 255);
+    SDL_RenderDrawLine(pSDLRenderer, Margin, budgetY, PanelWidth - Margin, budgetY);
+
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, blendMode);
+    SDL_SetRenderDrawColor(pSDLRenderer, Constants::RenderDrawColor.r, Constants::RenderDrawColor.g,
+        Constants::RenderDrawColor.b, Constants::RenderDrawColor.a);
+}
+#endif
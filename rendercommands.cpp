@@ -0,0 +1,386 @@
+#include "include/rendercommands.h"
+#include "include/diskwriter.h"
+#include <stdio.h>
+
+using namespace XplatGameTutorial::PacManClone;
+
+static const char RenderListMagic[4] = { 'P', 'M', 'R', 'L' };
+static const Uint16 RenderListVersion = 1;
+static const Uint16 RenderListFlagSorted = 1;
+static const Uint32 RenderListHeaderBytes = 16;
+static const Uint32 RenderCommandBytes = 39;
+static const Uint32 RenderPointBytes = 8;
+static const int TextureCount = static_cast<int>(RenderTexture::Count);
+static const int BucketCount = static_cast<int>(RenderLayer::Count) * TextureCount;
+
+static int Bucket(const RenderCommand &command)
+{
+    return (static_cast<int>(command.layer) * TextureCount) + static_cast<int>(command.texture);
+}
+
+static void WriteLE16(Uint8 *&pBytes, Uint16 value)
+{
+    value = SDL_SwapLE16(value);
+    SDL_memcpy(pBytes, &value, sizeof(value));
+    pBytes += sizeof(value);
+}
+
+static void WriteLE32(Uint8 *&pBytes, Uint32 value)
+{
+    value = SDL_SwapLE32(value);
+    SDL_memcpy(pBytes, &value, sizeof(value));
+    pBytes += sizeof(value);
+}
+
+static void WriteRect(Uint8 *&pBytes, const SDL_Rect &rect)
+{
+    WriteLE32(pBytes, static_cast<Uint32>(rect.x));
+    WriteLE32(pBytes, static_cast<Uint32>(rect.y));
+    WriteLE32(pBytes, static_cast<Uint32>(rect.w));
+    WriteLE32(pBytes, static_cast<Uint32>(rect.h));
+}
+
+static void ReadRect(SDL_RWops *pFile, SDL_Rect *pRect)
+{
+    pRect->x = static_cast<Sint32>(SDL_ReadLE32(pFile));
+    pRect->y = static_cast<Sint32>(SDL_ReadLE32(pFile));
+    pRect->w = static_cast<Sint32>(SDL_ReadLE32(pFile));
+    pRect->h = static_cast<Sint32>(SDL_ReadLE32(pFile));
+}
+
+RenderCommandList::RenderCommandList() :
+    _pCommands(nullptr),
+    _pSortScratch(nullptr),
+    _cCommands(0),
+    _cCommandsMax(0),
+    _pPoints(nullptr),
+    _cPoints(0),
+    _cPointsMax(0),
+    _fSorted(true),
+    _pSaved(nullptr)
+{
+}
+
+RenderCommandList::~RenderCommandList()
+{
+    delete[] _pCommands;
+    delete[] _pSortScratch;
+    delete[] _pPoints;
+    delete[] _pSaved;
+}
+
+bool RenderCommandList::Reserve(Uint32 cCommandsMax, Uint32 cPointsMax)
+{
+    delete[] _pCommands;
+    delete[] _pSortScratch;
+    delete[] _pPoints;
+    delete[] _pSaved;
+    _pCommands = new RenderCommand[SDL_max(cCommandsMax, 1)];
+    _pSortScratch = new RenderCommand[SDL_max(cCommandsMax, 1)];
+    _pPoints = new SDL_Point[SDL_max(cPointsMax, 1)];
+    _pSaved = new Uint8[SavedBytes(cCommandsMax, cPointsMax)];
+    _cCommandsMax = cCommandsMax;
+    _cPointsMax = cPointsMax;
+    Clear();
+    return true;
+}
+
+void RenderCommandList::Clear()
+{
+    _cCommands = 0;
+    _cPoints = 0;
+    _fSorted = true;
+}
+
+bool RenderCommandList::Add(const RenderCommand &command)
+{
+    SDL_assert(_cCommands < _cCommandsMax);
+    if (_cCommands >= _cCommandsMax)
+    {
+        return false;
+    }
+
+    // Anything recorded out of order needs sorting before it's drawn
+    if ((_cCommands > 0) && (Bucket(command) < Bucket(_pCommands[_cCommands - 1])))
+    {
+        _fSorted = false;
+    }
+    _pCommands[_cCommands++] = command;
+    return true;
+}
+
+void RenderCommandList::Copy(RenderLayer layer, RenderTexture texture, const SDL_Rect *pSource, const SDL_Rect *pTarget, SDL_Color colorMod)
+{
+    SDL_assert(texture != RenderTexture::None);
+    RenderCommand command = { layer, texture, RenderPrimitive::Copy, colorMod, { 0, 0, 0, 0 }, { 0, 0, 0, 0 } };
+    if (pSource != nullptr)
+    {
+        command.source = *pSource;
+    }
+    if (pTarget != nullptr)
+    {
+        command.target = *pTarget;
+    }
+    Add(command);
+}
+
+void RenderCommandList::FillRect(RenderLayer layer, const SDL_Rect &rect, SDL_Color color)
+{
+    RenderCommand command = { layer, RenderTexture::None, RenderPrimitive::FillRect, color, { 0, 0, 0, 0 }, rect };
+    Add(command);
+}
+
+void RenderCommandList::Line(RenderLayer layer, int x1, int y1, int x2, int y2, SDL_Color color)
+{
+    RenderCommand command = { layer, RenderTexture::None, RenderPrimitive::Line, color, { 0, 0, 0, 0 }, { x1, y1, x2, y2 } };
+    Add(command);
+}
+
+void RenderCommandList::Points(RenderLayer layer, const SDL_Point *pPoints, Uint32 cPoints, SDL_Color color)
+{
+    SDL_assert(_cPoints + cPoints <= _cPointsMax);
+    if (_cPoints + cPoints > _cPointsMax)
+    {
+        return;
+    }
+
+    RenderCommand command = { layer, RenderTexture::None, RenderPrimitive::Points, color,
+        { static_cast<int>(_cPoints), 0, static_cast<int>(cPoints), 0 }, { 0, 0, 0, 0 } };
+    if (Add(command))
+    {
+        SDL_memcpy(&_pPoints[_cPoints], pPoints, cPoints * sizeof(SDL_Point));
+        _cPoints += cPoints;
+    }
+}
+
+// There are only a handful of (layer, texture) buckets, so count each one, work out where each
+// bucket starts, and deal the commands out in order.  Stable, two passes and no allocation
+void RenderCommandList::Sort()
+{
+    if (_fSorted)
+    {
+        return;
+    }
+
+    Uint32 bucketStart[BucketCount] = {};
+    for (Uint32 i = 0; i < _cCommands; i++)
+    {
+        bucketStart[Bucket(_pCommands[i])]++;
+    }
+    Uint32 next = 0;
+    for (int b = 0; b < BucketCount; b++)
+    {
+        Uint32 count = bucketStart[b];
+        bucketStart[b] = next;
+        next += count;
+    }
+    for (Uint32 i = 0; i < _cCommands; i++)
+    {
+        _pSortScratch[bucketStart[Bucket(_pCommands[i])]++] = _pCommands[i];
+    }
+
+    RenderCommand *pSorted = _pSortScratch;
+    _pSortScratch = _pCommands;
+    _pCommands = pSorted;
+    _fSorted = true;
+}
+
+void RenderCommandList::Execute(SDL_Renderer *pSDLRenderer, SDL_Texture *const *ppTextures)
+{
+    SDL_Color drawColor;
+    SDL_GetRenderDrawColor(pSDLRenderer, &drawColor.r, &drawColor.g, &drawColor.b, &drawColor.a);
+    SDL_Color currentColor = drawColor;
+
+    // The color mod belongs to the texture, only set it when it changes.  Nothing is known about
+    // them coming in, so each texture's first copy sets it
+    SDL_Color colorMods[TextureCount];
+    bool fColorModSet[TextureCount] = {};
+
+    for (Uint32 i = 0; i < _cCommands; i++)
+    {
+        const RenderCommand &command = _pCommands[i];
+        if (command.primitive == RenderPrimitive::Copy)
+        {
+            int texture = static_cast<int>(command.texture);
+            SDL_Texture *pTexture = ppTextures[texture];
+            if (pTexture == nullptr)
+            {
+                continue;
+            }
+            if (!fColorModSet[texture] || (colorMods[texture].r != command.color.r) ||
+                (colorMods[texture].g != command.color.g) || (colorMods[texture].b != command.color.b))
+            {
+                SDL_SetTextureColorMod(pTexture, command.color.r, command.color.g, command.color.b);
+                colorMods[texture] = command.color;
+                fColorModSet[texture] = true;
+            }
+            SDL_RenderCopy(
+                pSDLRenderer,
+                pTexture,
+                (command.source.w != 0) ? &command.source : nullptr,
+                (command.target.w != 0) ? &command.target : nullptr);
+            continue;
+        }
+
+        if ((currentColor.r != command.color.r) || (currentColor.g != command.color.g) ||
+            (currentColor.b != command.color.b) || (currentColor.a != command.color.a))
+        {
+            SDL_SetRenderDrawColor(pSDLRenderer, command.color.r, command.color.g, command.color.b, command.color.a);
+            currentColor = command.color;
+        }
+        switch (command.primitive)
+        {
+        case RenderPrimitive::FillRect:
+            SDL_RenderFillRect(pSDLRenderer, &command.target);
+            break;
+        case RenderPrimitive::Line:
+            SDL_RenderDrawLine(pSDLRenderer, command.target.x, command.target.y, command.target.w, command.target.h);
+            break;
+        case RenderPrimitive::Points:
+            SDL_RenderDrawPoints(pSDLRenderer, &_pPoints[command.source.x], command.source.w);
+            break;
+        case RenderPrimitive::Copy:
+            break;
+        }
+    }
+
+    SDL_SetRenderDrawColor(pSDLRenderer, drawColor.r, drawColor.g, drawColor.b, drawColor.a);
+}
+
+void RenderCommandList::Flush(SDL_Renderer *pSDLRenderer, SDL_Texture *const *ppTextures)
+{
+    Sort();
+    Execute(pSDLRenderer, ppTextures);
+}
+
+Uint32 RenderCommandList::SavedBytes(Uint32 cCommands, Uint32 cPoints)
+{
+    return RenderListHeaderBytes + (cCommands * RenderCommandBytes) + (cPoints * RenderPointBytes);
+}
+
+bool RenderCommandList::Save(DiskStream *pStream)
+{
+    Uint8 *pBytes = _pSaved;
+    SDL_memcpy(pBytes, RenderListMagic, sizeof(RenderListMagic));
+    pBytes += sizeof(RenderListMagic);
+    WriteLE16(pBytes, RenderListVersion);
+    WriteLE16(pBytes, _fSorted ? RenderListFlagSorted : 0);
+    WriteLE32(pBytes, _cCommands);
+    WriteLE32(pBytes, _cPoints);
+    for (Uint32 i = 0; i < _cCommands; i++)
+    {
+        const RenderCommand &command = _pCommands[i];
+        *pBytes++ = static_cast<Uint8>(command.layer);
+        *pBytes++ = static_cast<Uint8>(command.texture);
+        *pBytes++ = static_cast<Uint8>(command.primitive);
+        *pBytes++ = command.color.r;
+        *pBytes++ = command.color.g;
+        *pBytes++ = command.color.b;
+        *pBytes++ = command.color.a;
+        WriteRect(pBytes, command.source);
+        WriteRect(pBytes, command.target);
+    }
+    for (Uint32 i = 0; i < _cPoints; i++)
+    {
+        WriteLE32(pBytes, static_cast<Uint32>(_pPoints[i].x));
+        WriteLE32(pBytes, static_cast<Uint32>(_pPoints[i].y));
+    }
+    SDL_assert(static_cast<Uint32>(pBytes - _pSaved) == SavedBytes(_cCommands, _cPoints));
+
+    // One span, so a list is either all in the file or (if the stream drops it) not at all
+    return pStream->Write(_pSaved, static_cast<Uint32>(pBytes - _pSaved));
+}
+
+bool RenderCommandList::Load(const char *szFileName)
+{
+    SDL_RWops *pFile = SDL_RWFromFile(szFileName, "rb");
+    if (pFile == nullptr)
+    {
+        printf("Failed to open render list file %s, error = %s\n", szFileName, SDL_GetError());
+        return false;
+    }
+
+    // Each capture is added to the end of the file, the last whole one is the latest
+    Sint64 cbFile = SDL_RWsize(pFile);
+    Sint64 offset = 0;
+    Sint64 lastOffset = 0;
+    while (offset + static_cast<Sint64>(RenderListHeaderBytes) <= cbFile)
+    {
+        char magic[sizeof(RenderListMagic)] = {};
+        SDL_RWseek(pFile, offset, RW_SEEK_SET);
+        SDL_RWread(pFile, magic, sizeof(magic), 1);
+        SDL_ReadLE32(pFile);
+        Uint64 cCommands = SDL_ReadLE32(pFile);
+        Uint64 cPoints = SDL_ReadLE32(pFile);
+        Sint64 next = offset + static_cast<Sint64>(RenderListHeaderBytes + (cCommands * RenderCommandBytes) + (cPoints * RenderPointBytes));
+        if ((SDL_memcmp(magic, RenderListMagic, sizeof(magic)) != 0) || (next > cbFile))
+        {
+            break;
+        }
+        lastOffset = offset;
+        offset = next;
+    }
+    SDL_RWseek(pFile, lastOffset, RW_SEEK_SET);
+
+    bool fResult = false;
+    char magic[sizeof(RenderListMagic)] = {};
+    SDL_RWread(pFile, magic, sizeof(magic), 1);
+    Uint16 version = SDL_ReadLE16(pFile);
+    Uint16 flags = SDL_ReadLE16(pFile);
+    Uint32 cCommands = SDL_ReadLE32(pFile);
+    Uint32 cPoints = SDL_ReadLE32(pFile);
+
+    // Every command is 39 bytes and every point 8, so what's left of the file bounds the counts
+    Sint64 cbList = cbFile - lastOffset;
+    if ((SDL_memcmp(magic, RenderListMagic, sizeof(magic)) != 0) || (version != RenderListVersion))
+    {
+        printf("%s is not a render list this version can draw\n", szFileName);
+    }
+    else if ((cbList < 0) || ((static_cast<Uint64>(cCommands) * RenderCommandBytes) + (static_cast<Uint64>(cPoints) * RenderPointBytes) > static_cast<Uint64>(cbList)))
+    {
+        printf("%s is truncated, expected %u commands and %u points\n", szFileName, cCommands, cPoints);
+    }
+    else
+    {
+        Reserve(cCommands, cPoints);
+        fResult = true;
+        for (Uint32 i = 0; (i < cCommands) && fResult; i++)
+        {
+            RenderCommand &command = _pCommands[i];
+            command.layer = static_cast<RenderLayer>(SDL_ReadU8(pFile));
+            command.texture = static_cast<RenderTexture>(SDL_ReadU8(pFile));
+            command.primitive = static_cast<RenderPrimitive>(SDL_ReadU8(pFile));
+            command.color.r = SDL_ReadU8(pFile);
+            command.color.g = SDL_ReadU8(pFile);
+            command.color.b = SDL_ReadU8(pFile);
+            command.color.a = SDL_ReadU8(pFile);
+            ReadRect(pFile, &command.source);
+            ReadRect(pFile, &command.target);
+
+            bool fPointsInRange = (command.source.x >= 0) && (command.source.w >= 0) &&
+                (static_cast<Uint32>(command.source.x) + static_cast<Uint32>(command.source.w) <= cPoints);
+            if ((command.layer >= RenderLayer::Count) || (command.texture >= RenderTexture::Count) ||
+                (command.primitive > RenderPrimitive::Points) ||
+                ((command.primitive == RenderPrimitive::Copy) && (command.texture == RenderTexture::None)) ||
+                ((command.primitive == RenderPrimitive::Points) && !fPointsInRange))
+            {
+                printf("%s has a bad command at %u\n", szFileName, i);
+                fResult = false;
+            }
+        }
+        for (Uint32 i = 0; (i < cPoints) && fResult; i++)
+        {
+            _pPoints[i].x = static_cast<Sint32>(SDL_ReadLE32(pFile));
+            _pPoints[i].y = static_cast<Sint32>(SDL_ReadLE32(pFile));
+        }
+
+        if (fResult)
+        {
+            _cCommands = cCommands;
+            _cPoints = cPoints;
+            _fSorted = (flags & RenderListFlagSorted) != 0;
+        }
+    }
+    SDL_RWclose(pFile);
+    return fResult;
+}
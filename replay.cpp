@@ -0,0 +1,310 @@
+#include "include/replay.h"
+#include "include/constants.h"
+
+using namespace XplatGameTutorial::PacManClone;
+
+static const char ReplayMagic[4] = { 'P', 'M', 'C', 'R' };
+static const char KeyframeMagic[4] = { 'P', 'M', 'C', 'K' };
+static const Uint16 ReplayVersion = 2;
+static const Uint16 ReplayVersionNoKeyframes = 1;
+static const Uint16 ReplayFlagStress = 1;
+static const Uint32 HeaderSize = 20;
+static const Uint32 KeyframeEntrySize = 16;
+static const Uint32 KeyframeTrailerSize = 16;
+
+// FNV-1a, the same as ActorStore::Checksum()
+static Uint32 HashBytes(const Uint8 *pBytes, size_t cb)
+{
+    Uint32 hash = 2166136261u;
+    for (size_t i = 0; i < cb; i++)
+    {
+        hash = (hash ^ pBytes[i]) * 16777619u;
+    }
+    return hash;
+}
+
+static void WriteLE32(Uint8 *&pBytes, Uint32 value)
+{
+    value = SDL_SwapLE32(value);
+    SDL_memcpy(pBytes, &value, sizeof(value));
+    pBytes += sizeof(value);
+}
+
+ReplayRecorder::ReplayRecorder() :
+    _pWriter(nullptr),
+    _pStream(nullptr),
+    _cbWritten(0),
+    _keyframeBytes(0),
+    _pKeyframes(nullptr),
+    _cKeyframes(0)
+{
+    SDL_zero(_info);
+}
+
+ReplayRecorder::~ReplayRecorder()
+{
+    Close();
+    delete[] _pKeyframes;
+}
+
+bool ReplayRecorder::Open(DiskWriter *pWriter, const char *szFileName, bool fStress, Uint16 cPlayers, Uint16 cGhosts, Uint32 keyframeBytes)
+{
+    SDL_assert(!IsOpen());
+
+    // Room for a few keyframes in the ring, a big roster's are far bigger than the ticks in between
+    Uint32 capacity = StreamCapacity;
+    while (capacity < 4 * keyframeBytes)
+    {
+        capacity *= 2;
+    }
+    _pStream = pWriter->Open(szFileName, capacity, DiskStream::Overflow::Wait);
+    if (_pStream == nullptr)
+    {
+        printf("Failed to create replay file %s\n", szFileName);
+        return false;
+    }
+    _pWriter = pWriter;
+
+    SDL_zero(_info);
+    _info.fStress = fStress;
+    _info.cPlayers = cPlayers;
+    _info.cGhosts = cGhosts;
+    _keyframeBytes = keyframeBytes;
+    _cKeyframes = 0;
+    if (_pKeyframes == nullptr)
+    {
+        // Up front, so the ticks never allocate
+        _pKeyframes = new KeyframeEntry[MaxKeyframes];
+    }
+    Uint8 header[HeaderSize];
+    EncodeHeader(header);
+    _pStream->Write(header, sizeof(header));
+    _cbWritten = sizeof(header);
+    return true;
+}
+
+void ReplayRecorder::AddKeyframe(const Uint8 *pState, Uint32 checksum)
+{
+    SDL_assert(KeyframeDue());
+    KeyframeEntry &entry = _pKeyframes[_cKeyframes++];
+    entry.tick = _info.cTicks;
+    entry.checksum = checksum;
+    entry.hash = HashBytes(pState, _keyframeBytes);
+    entry.offset = _cbWritten;
+    _pStream->Write(pState, _keyframeBytes);
+    _cbWritten += _keyframeBytes;
+}
+
+void ReplayRecorder::AddTick(Direction input, Uint32 checksum)
+{
+    Uint8 byte = static_cast<Uint8>(input);
+    _pStream->Write(&byte, sizeof(byte));
+    _cbWritten += sizeof(byte);
+    _info.cTicks++;
+    _info.checksum = checksum;
+}
+
+// Now that we know how it ended, the keyframe index goes on the end and the header at the start gets filled in
+void ReplayRecorder::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    Uint8 entry[KeyframeEntrySize];
+    for (Uint32 i = 0; i < _cKeyframes; i++)
+    {
+        Uint8 *pEntry = entry;
+        WriteLE32(pEntry, _pKeyframes[i].tick);
+        WriteLE32(pEntry, _pKeyframes[i].checksum);
+        WriteLE32(pEntry, _pKeyframes[i].hash);
+        WriteLE32(pEntry, _pKeyframes[i].offset);
+        _pStream->Write(entry, sizeof(entry));
+    }
+    Uint8 trailer[KeyframeTrailerSize];
+    Uint8 *pTrailer = trailer;
+    WriteLE32(pTrailer, KeyframeInterval);
+    WriteLE32(pTrailer, _keyframeBytes);
+    WriteLE32(pTrailer, _cKeyframes);
+    SDL_memcpy(pTrailer, KeyframeMagic, sizeof(KeyframeMagic));
+    _pStream->Write(trailer, sizeof(trailer));
+
+    Uint8 header[HeaderSize];
+    EncodeHeader(header);
+    _pWriter->Close(_pStream, header, sizeof(header));
+    _pStream = nullptr;
+    _pWriter = nullptr;
+}
+
+void ReplayRecorder::EncodeHeader(Uint8 *pHeader)
+{
+    Uint16 fields16[4] = { ReplayVersion, static_cast<Uint16>(_info.fStress ? ReplayFlagStress : 0), _info.cPlayers, _info.cGhosts };
+    Uint32 fields32[2] = { _info.cTicks, _info.checksum };
+    SDL_memcpy(pHeader, ReplayMagic, sizeof(ReplayMagic));
+    pHeader += sizeof(ReplayMagic);
+    for (int i = 0; i < 4; i++)
+    {
+        Uint16 value = SDL_SwapLE16(fields16[i]);
+        SDL_memcpy(pHeader, &value, sizeof(value));
+        pHeader += sizeof(value);
+    }
+    for (int i = 0; i < 2; i++)
+    {
+        WriteLE32(pHeader, fields32[i]);
+    }
+}
+
+Replay::Replay() :
+    _pInputs(nullptr),
+    _keyframeInterval(0),
+    _keyframeBytes(0),
+    _cKeyframes(0),
+    _pKeyframes(nullptr),
+    _pKeyframeChecksums(nullptr)
+{
+    SDL_zero(_info);
+}
+
+Replay::~Replay()
+{
+    delete[] _pInputs;
+    delete[] _pKeyframes;
+    delete[] _pKeyframeChecksums;
+}
+
+bool Replay::Load(const char *szFileName)
+{
+    SDL_RWops *pFile = SDL_RWFromFile(szFileName, "rb");
+    if (pFile == nullptr)
+    {
+        printf("Failed to open replay file %s, error = %s\n", szFileName, SDL_GetError());
+        return false;
+    }
+
+    bool fResult = false;
+    char magic[sizeof(ReplayMagic)] = {};
+    SDL_RWread(pFile, magic, sizeof(magic), 1);
+    Uint16 version = SDL_ReadLE16(pFile);
+    Uint16 flags = SDL_ReadLE16(pFile);
+    _info.fStress = (flags & ReplayFlagStress) != 0;
+    _info.cPlayers = SDL_ReadLE16(pFile);
+    _info.cGhosts = SDL_ReadLE16(pFile);
+    _info.cTicks = SDL_ReadLE32(pFile);
+    _info.checksum = SDL_ReadLE32(pFile);
+
+    delete[] _pInputs;
+    _pInputs = nullptr;
+    _cKeyframes = 0;
+    if ((SDL_memcmp(magic, ReplayMagic, sizeof(magic)) != 0) || ((version != ReplayVersion) && (version != ReplayVersionNoKeyframes)))
+    {
+        printf("%s is not a replay this version can play\n", szFileName);
+    }
+    else if ((_info.cPlayers < 1) || (_info.cPlayers > Constants::MaxPlayers) || (_info.cGhosts > Constants::MaxGhosts))
+    {
+        printf("%s has a roster we can't create (%u players, %u ghosts)\n", szFileName, _info.cPlayers, _info.cGhosts);
+    }
+    else
+    {
+        _pInputs = new Uint8[SDL_max(_info.cTicks, 1)];
+        if (version == ReplayVersion)
+        {
+            fResult = LoadKeyframes(szFileName, pFile);
+        }
+        else if (SDL_RWread(pFile, _pInputs, 1, _info.cTicks) != _info.cTicks)
+        {
+            printf("%s is truncated, expected %u ticks\n", szFileName, _info.cTicks);
+        }
+        else
+        {
+            fResult = true;
+        }
+
+        if (fResult)
+        {
+            for (Uint32 i = 0; i < _info.cTicks; i++)
+            {
+                if (_pInputs[i] > static_cast<Uint8>(Direction::None))
+                {
+                    printf("%s has a bad input at tick %u\n", szFileName, i);
+                    fResult = false;
+                    break;
+                }
+            }
+        }
+    }
+    SDL_RWclose(pFile);
+    return fResult;
+}
+
+// The index at the end says where each keyframe is, everything else in the body is the input.  Checked
+// all the way through, they have to be exactly where the recorder would have put them
+bool Replay::LoadKeyframes(const char *szFileName, SDL_RWops *pFile)
+{
+    Sint64 cbFile = SDL_RWsize(pFile);
+    char magic[sizeof(KeyframeMagic)] = {};
+    if ((cbFile < HeaderSize + KeyframeTrailerSize) || (SDL_RWseek(pFile, cbFile - KeyframeTrailerSize, RW_SEEK_SET) < 0))
+    {
+        printf("%s is truncated, it has no keyframe index\n", szFileName);
+        return false;
+    }
+    _keyframeInterval = SDL_ReadLE32(pFile);
+    _keyframeBytes = SDL_ReadLE32(pFile);
+    _cKeyframes = SDL_ReadLE32(pFile);
+    SDL_RWread(pFile, magic, sizeof(magic), 1);
+    Sint64 cbBody = cbFile - HeaderSize - KeyframeTrailerSize - (static_cast<Sint64>(_cKeyframes) * KeyframeEntrySize);
+    if ((SDL_memcmp(magic, KeyframeMagic, sizeof(magic)) != 0) || (_keyframeInterval == 0) || (_keyframeBytes == 0) ||
+        (cbBody != _info.cTicks + (static_cast<Sint64>(_cKeyframes) * _keyframeBytes)))
+    {
+        printf("%s has a bad keyframe index\n", szFileName);
+        _cKeyframes = 0;
+        return false;
+    }
+
+    Uint8 *pBody = new Uint8[static_cast<size_t>(SDL_max(cbBody, 1))];
+    delete[] _pKeyframes;
+    delete[] _pKeyframeChecksums;
+    _pKeyframes = new Uint8[SDL_max(static_cast<size_t>(_cKeyframes) * _keyframeBytes, 1)];
+    _pKeyframeChecksums = new Uint32[SDL_max(_cKeyframes, 1)];
+    if ((SDL_RWseek(pFile, HeaderSize, RW_SEEK_SET) != HeaderSize) ||
+        (SDL_RWread(pFile, pBody, 1, static_cast<size_t>(cbBody)) != static_cast<size_t>(cbBody)))
+    {
+        printf("Failed to read %s, error = %s\n", szFileName, SDL_GetError());
+        _cKeyframes = 0;
+        delete[] pBody;
+        return false;
+    }
+
+    // Pull the keyframes out of the body, the input between them goes in order into _pInputs
+    bool fResult = true;
+    Uint32 offset = HeaderSize;
+    Uint32 cInputs = 0;
+    Uint32 i = 0;
+    for (; (i < _cKeyframes) && fResult; i++)
+    {
+        Uint32 tick = SDL_ReadLE32(pFile);
+        _pKeyframeChecksums[i] = SDL_ReadLE32(pFile);
+        Uint32 hash = SDL_ReadLE32(pFile);
+        Uint32 keyframeOffset = SDL_ReadLE32(pFile);
+        fResult = (tick == KeyframeTick(i)) && (tick <= _info.cTicks) && (keyframeOffset >= offset) &&
+            (keyframeOffset - offset == tick - cInputs) && (HashBytes(pBody + (keyframeOffset - HeaderSize), _keyframeBytes) == hash);
+        if (fResult)
+        {
+            SDL_memcpy(_pInputs + cInputs, pBody + (offset - HeaderSize), tick - cInputs);
+            SDL_memcpy(_pKeyframes + (static_cast<size_t>(i) * _keyframeBytes), pBody + (keyframeOffset - HeaderSize), _keyframeBytes);
+            cInputs = tick;
+            offset = keyframeOffset + _keyframeBytes;
+        }
+    }
+    if (fResult)
+    {
+        SDL_memcpy(_pInputs + cInputs, pBody + (offset - HeaderSize), _info.cTicks - cInputs);
+    }
+    else
+    {
+        printf("%s is damaged, keyframe %u doesn't match the index\n", szFileName, i - 1);
+        _cKeyframes = 0;
+    }
+    delete[] pBody;
+    return fResult;
+}
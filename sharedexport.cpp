@@ -0,0 +1,161 @@
+#include "include/sharedexport.h"
+#include <stdio.h>
+#include <new>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace XplatGameTutorial::PacManClone;
+
+SharedExport::SharedExport() :
+    _pHeader(nullptr),
+    _pWriting(nullptr),
+    _cPublished(0),
+    _cbMapping(0)
+#ifdef _WIN32
+    , _hMapping(nullptr)
+#endif
+{
+    _szName[0] = '\0';
+}
+
+SharedExport::~SharedExport()
+{
+    Close();
+}
+
+bool SharedExport::Open(const char *szName, int width, int height, Uint16 maxActors, Uint16 mapRows, Uint16 mapCols)
+{
+    SDL_assert(!IsOpen());
+    Uint32 pitch = static_cast<Uint32>(width) * 4;
+    Uint32 headerBytes = Align(sizeof(SharedExportHeader));
+    Uint32 actorsOffset = Align(sizeof(SharedExportSlot));
+    Uint32 mapOffset = actorsOffset + Align(maxActors * sizeof(ActorState));
+    Uint32 pixelsOffset = mapOffset + Align(mapRows * mapCols * sizeof(Uint16));
+    Uint32 slotBytes = pixelsOffset + Align(pitch * height);
+    _cbMapping = headerBytes + (static_cast<size_t>(slotBytes) * SlotCount);
+
+    void *pMapping = nullptr;
+#ifdef _WIN32
+    // Session local, like a POSIX name is to the machine's users
+    SDL_snprintf(_szName, sizeof(_szName), "Local\\%s", szName);
+    _hMapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, static_cast<DWORD>(_cbMapping >> 32),
+        static_cast<DWORD>(_cbMapping & 0xFFFFFFFF), _szName);
+    if (_hMapping == nullptr)
+    {
+        printf("CreateFileMapping(%s) failed, error = %lu\n", _szName, GetLastError());
+        return false;
+    }
+    pMapping = MapViewOfFile(_hMapping, FILE_MAP_ALL_ACCESS, 0, 0, _cbMapping);
+    if (pMapping == nullptr)
+    {
+        printf("MapViewOfFile(%s) failed, error = %lu\n", _szName, GetLastError());
+        CloseHandle(_hMapping);
+        _hMapping = nullptr;
+        return false;
+    }
+#else
+    // POSIX wants the name to start with a slash, and to have no others
+    SDL_snprintf(_szName, sizeof(_szName), "%s%s", (szName[0] == '/') ? "" : "/", szName);
+    int fd = shm_open(_szName, O_CREAT | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        printf("shm_open(%s) failed\n", _szName);
+        return false;
+    }
+    // Cut to nothing first, so whatever a previous run left there reads as zero
+    if ((ftruncate(fd, 0) != 0) || (ftruncate(fd, static_cast<off_t>(_cbMapping)) != 0))
+    {
+        printf("Failed to size %s to %zu bytes\n", _szName, _cbMapping);
+        close(fd);
+        shm_unlink(_szName);
+        return false;
+    }
+    pMapping = mmap(nullptr, _cbMapping, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (pMapping == MAP_FAILED)
+    {
+        printf("mmap(%s) failed\n", _szName);
+        shm_unlink(_szName);
+        return false;
+    }
+#endif
+
+    // The mapping starts out zeroed, so only the atomics need constructing
+    _pHeader = static_cast<SharedExportHeader*>(pMapping);
+    new (&_pHeader->published) std::atomic<Uint64>(0);
+    SDL_assert(_pHeader->published.is_lock_free());
+    _pHeader->version = Version;
+    _pHeader->headerBytes = headerBytes;
+    _pHeader->slotCount = SlotCount;
+    _pHeader->slotBytes = slotBytes;
+    _pHeader->maxActors = maxActors;
+    _pHeader->mapRows = mapRows;
+    _pHeader->mapCols = mapCols;
+    _pHeader->actorsOffset = actorsOffset;
+    _pHeader->mapOffset = mapOffset;
+    _pHeader->pixelsOffset = pixelsOffset;
+    _pHeader->width = width;
+    _pHeader->height = height;
+    _pHeader->pitch = pitch;
+    for (Uint32 i = 0; i < SlotCount; i++)
+    {
+        SharedExportSlot *pSlot = reinterpret_cast<SharedExportSlot*>(static_cast<Uint8*>(pMapping) + headerBytes + (i * slotBytes));
+        new (&pSlot->sequence) std::atomic<Uint64>(0);
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    SDL_memcpy(_pHeader->magic, "PMSX", 4);
+    _cPublished = 0;
+    return true;
+}
+
+void SharedExport::Close()
+{
+    if (_pHeader == nullptr)
+    {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(_pHeader);
+    CloseHandle(_hMapping);
+    _hMapping = nullptr;
+#else
+    munmap(_pHeader, _cbMapping);
+    shm_unlink(_szName);
+#endif
+    _pHeader = nullptr;
+    _pWriting = nullptr;
+}
+
+SharedExportSlot* SharedExport::BeginWrite()
+{
+    SDL_assert(IsOpen() && (_pWriting == nullptr));
+    _pWriting = reinterpret_cast<SharedExportSlot*>(reinterpret_cast<Uint8*>(_pHeader) + _pHeader->headerBytes +
+        ((_cPublished % SlotCount) * _pHeader->slotBytes));
+
+    // Odd, and ordered before any of the writes into the slot
+    _pWriting->sequence.store((2 * _cPublished) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    return _pWriting;
+}
+
+void SharedExport::EndWrite()
+{
+    SDL_assert(_pWriting != nullptr);
+    _cPublished++;
+    _pWriting->sequence.store(2 * _cPublished, std::memory_order_release);
+    _pHeader->published.store(_cPublished, std::memory_order_release);
+    _pWriting = nullptr;
+}
+
+void SharedExport::AbandonWrite()
+{
+    SDL_assert(_pWriting != nullptr);
+    _pWriting = nullptr;
+}
@@ -3,39 +3,43 @@
 
 using namespace XplatGameTutorial::PacManClone;
 
-Sprite::Sprite(TextureWrapper *pTextureWrapper, Uint16 cxFrame, Uint16 cyFrame, Uint16 cFramesTotal, Uint16 cAnimationsTotal) :
-    _x(0.0),
-    _y(0.0),
-    _dx(0.0),
-    _dy(0.0),
+Sprite::Sprite(TextureWrapper *pTextureWrapper, ActorStore *pActorStore, Uint16 cxFrame, Uint16 cyFrame, Uint16 cFramesTotal, Uint16 cAnimationsTotal) :
+    _pActorStore(pActorStore),
+    _id(pActorStore->Add()),
     _cFramesTotal(cFramesTotal),
     _pFrames(nullptr),
     _cxFrame(cxFrame),
     _cyFrame(cyFrame),
     _cxFrameOffset(0),
     _cyFrameOffset(0),
-    _currentAnimationIndex(0),
     _cAnimationsTotal(cAnimationsTotal),
+    _clipBase(AnimationRegistry::InvalidClip),
     _staticFrameIndex(0),
     _fVisible(SDL_TRUE),
-    _pTextureWrapper(pTextureWrapper),
-    _ppSpriteAnimations(nullptr)
+    _pTextureWrapper(pTextureWrapper)
 {
 }
 
 Sprite::~Sprite()
 {
-    // Delete all loaded animations
-    for (int i = 0; i < _cAnimationsTotal; i++)
-    {
-        delete _ppSpriteAnimations[i];
-        _ppSpriteAnimations[i] = nullptr;
-    }
-    // Delete the array holding those animations
-    delete[] _ppSpriteAnimations;
+    // Frames and animations belong to the registry
+}
+
+bool Sprite::UseFrameTable(AnimationRegistry::FrameTableId frameTableId)
+{
+    bool fNeedsLoad = false;
+    _pFrames = _pActorStore->Animations()->FrameTable(frameTableId, _cFramesTotal, &fNeedsLoad);
+    return fNeedsLoad;
+}
 
-    // Delete allocated frame rects
-    delete[] _pFrames;
+bool Sprite::UseClipSet(AnimationRegistry::ClipSetId clipSetId)
+{
+    bool fNeedsLoad = false;
+    _clipBase = _pActorStore->Animations()->ClipSet(clipSetId, _cAnimationsTotal, &fNeedsLoad);
+
+    // Every actor starts on the first clip of its set
+    _pActorStore->SetClip(_id, _clipBase);
+    return fNeedsLoad;
 }
 
 // Loads a single frame at the given coordinates on the texture to the specifed index
@@ -67,13 +71,8 @@ bool Sprite::LoadFrame(Uint16 frameIndex, Uint16 xTexture, Uint16 yTexture)
 
     if (fResult)
     {
-        // On first frame load, allocate the frames
-        if (_pFrames == nullptr)
-        {
-            // If this fails we're OOM and in for crashes anyway....
-            _pFrames = new SDL_Rect[_cFramesTotal]{ {0,0,0,0} };
-        }
-
+        // UseFrameTable() is needed first to know where the frames go
+        SDL_assert(_pFrames != nullptr);
         _pFrames[frameIndex].x = xTexture;
         _pFrames[frameIndex].y = yTexture;
         _pFrames[frameIndex].w = _cxFrame; // Every frame in the sprite is the same size
@@ -98,59 +97,50 @@ bool Sprite::LoadFrames(Uint16 frameIndexStart, Uint16 xTextureStart, Uint16 yTe
     return fResult;
 }
 
-//  Store the given animation sequence at the specified index.  This is mostly delegated to the SpriteAnimation helper class
+//  Store the given animation sequence at the specified index of our clip set in the registry
 void Sprite::LoadAnimationSequence(Uint16 index, AnimationType animationType, int* pSequence, Uint16 cFramesInSequence, Uint16 animationSpeed)
 {
-    // First time allocate the space for the animation helpers
-    if (_ppSpriteAnimations == nullptr)
-    {
-        _ppSpriteAnimations = new SpriteAnimation*[_cAnimationsTotal];
-        SDL_memset(_ppSpriteAnimations, 0, sizeof(SpriteAnimation*) * _cAnimationsTotal);
-    }
-
-    // Creates a new helper for the animation and stores it
-    SpriteAnimation* pAnimation = new SpriteAnimation(cFramesInSequence, pSequence, animationType, animationSpeed);
-    _ppSpriteAnimations[index] = pAnimation;
+    // UseClipSet() is needed first to know where the clips go
+    SDL_assert(_clipBase != AnimationRegistry::InvalidClip);
+    SDL_assert(index < _cAnimationsTotal);
+    _pActorStore->Animations()->SetClip(_clipBase + index, pSequence, cFramesInSequence, animationType, animationSpeed);
 }
 
 void Sprite::ResetAnimation()
 {
-    // Delegate to helper
-    _ppSpriteAnimations[_currentAnimationIndex]->Reset();
+    // Delegate to the store
+    _pActorStore->ResetAnimation(_id);
 }
 
 void Sprite::SetAnimation(Uint16 index)
 {
     // If this isn't already the current animation
     // Because if it is, you wanted ResetAnimation()
-    if (_currentAnimationIndex != index)
+    if (CurrentAnimation() != index)
     {
         // Store it and reset the sequence
-        _currentAnimationIndex = index;
-        _ppSpriteAnimations[_currentAnimationIndex]->Reset();
+        _pActorStore->SetClip(_id, _clipBase + index);
     }
 }
 
 // Store a new velocity
-void Sprite::SetVelocity(double dx, double dy)
+void Sprite::SetVelocity(Coord dx, Coord dy)
 {
-    _dx = dx;
-    _dy = dy;
+    _pActorStore->SetVelocity(_id, dx, dy);
 }
 
-// Manually set a position, normal play position is Update()d but we also
+// Manually set a position, normal play position is updated by the ActorStore but we also
 // need the ability to place it directly
-void Sprite::ResetPosition(double x, double y)
+void Sprite::ResetPosition(Coord x, Coord y)
 {
-    _x = x;
-    _y = y;
+    _pActorStore->SetPosition(_id, x, y);
 }
 
 // Manually set frame index for non-animated sprites
 void Sprite::SetFrame(Uint16 frameIndex)
 {
     // We're assuming this sprite has no animations, so assert it
-    SDL_assert(_ppSpriteAnimations == nullptr);
+    SDL_assert(_clipBase == AnimationRegistry::InvalidClip);
     _staticFrameIndex = frameIndex;
 }
 
@@ -175,52 +165,54 @@ void Sprite::SetVisible(SDL_bool visible)
     _fVisible = visible;
 }
 
-// set new positio based on velocity and update the current animation
-void Sprite::Update()
-{
-    _x += _dx;
-    _y += _dy;
-
-    // Advance animation counters and if needed the frame
-    _ppSpriteAnimations[_currentAnimationIndex]->Update();
-}
-
 // Very similar to the tilemap, only in this case, we're index the frame
 // to draw based on the current animation state (or static frame) instead
 // on a static indexed map of tiles
 void Sprite::Render(SDL_Renderer *pSDLRenderer)
 {
-    if (_fVisible == SDL_TRUE)
+    SDL_Rect sourceRect;
+    SDL_Rect targetRect;
+    if (GetDraw(&sourceRect, &targetRect))
     {
-        // Find the index to the current frame in the current animation and draw it to the renderer
-        // at the correct x,y delta offset
-        int frameIndex = (_ppSpriteAnimations == nullptr) ? _staticFrameIndex : _ppSpriteAnimations[_currentAnimationIndex]->CurrentFrame();
-        SDL_Rect targetRect{ static_cast<int>(_x) + _cxFrameOffset, static_cast<int>(_y) + _cyFrameOffset, _cxFrame, _cyFrame };
         SDL_RenderCopy(
             pSDLRenderer,
             _pTextureWrapper->Ptr(),
-            &_pFrames[frameIndex],
+            &sourceRect,
             &targetRect);
     }
 }
 
+bool Sprite::GetDraw(SDL_Rect *pSource, SDL_Rect *pTarget)
+{
+    if (_fVisible == SDL_TRUE)
+    {
+        // Find the index to the current frame in the current animation, drawn at the correct x,y delta offset
+        int frameIndex = (_clipBase == AnimationRegistry::InvalidClip) ? _staticFrameIndex :
+            _pActorStore->Animations()->Clip(_pActorStore->Clip(_id)).pSequence[_pActorStore->FrameIndex(_id)];
+        *pSource = _pFrames[frameIndex];
+        *pTarget = { CoordToInt(X()) + _cxFrameOffset, CoordToInt(Y()) + _cyFrameOffset, _cxFrame, _cyFrame };
+        return true;
+    }
+    return false;
+}
+
 Direction Sprite::CurrentDirection()
 {
     Direction result = Direction::None;
 
-    if (_dx > 0)
+    if (DX() > 0)
     {
         result = Direction::Right;
     }
-    else if (_dx < 0)
+    else if (DX() < 0)
     {
         result = Direction::Left;
     }
-    else if (_dy > 0)
+    else if (DY() > 0)
     {
         result = Direction::Down;
     }
-    else if (_dy < 0)
+    else if (DY() < 0)
     {
         result = Direction::Up;
     }
@@ -230,11 +222,11 @@ Direction Sprite::CurrentDirection()
 bool Sprite::IsOutOfView(SDL_Rect &rect)
 {
     bool result = false;
-    if (X() > rect.x + rect.w + Width())
+    if (X() > IntToCoord(rect.x + rect.w + Width()))
     {
         result = true;
     }
-    else if (X() < rect.x - Width())
+    else if (X() < IntToCoord(rect.x - Width()))
     {
         result = true;
     }
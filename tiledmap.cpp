@@ -11,7 +11,8 @@ bool TiledMap::Initialize(
     SDL_Rect tileRect,              // size of the tile - the texture should be a multiple of this size...
     SDL_Texture *pTexture,          // texture holding the tiles
     Uint16 *pMapIndices,            // array of indicies to the tiles, should match in size to map
-    Uint16 countOfIndicies)         // again should match, but here to be explicit in the code
+    Uint16 countOfIndicies,         // again should match, but here to be explicit in the code
+    Arena *pArena)                  // where the tile rects and a copy of the indicies are allocated
 {
     // Validate some assumptions
     SDL_assert((textureRect.w % tileRect.w) == 0);
@@ -20,8 +21,9 @@ bool TiledMap::Initialize(
     SDL_assert(pMapIndices != nullptr);
 
     // Copy the map indicies data
-    _pMapIndicies = new Uint16[countOfIndicies] { };
+    _pMapIndicies = pArena->Allocate<Uint16>(countOfIndicies);
     SDL_memcpy(_pMapIndicies, pMapIndices, countOfIndicies * sizeof(Uint16));
+    _version++;
 
     // Copy the texture data
     _pTileTexture = pTexture;
@@ -33,7 +35,7 @@ bool TiledMap::Initialize(
     Uint16 textureTilesPerWidth  = static_cast<Uint16>((_textureRect.w / _tileSize));    // The texture itself does not need to be square
     Uint16 textureTilesPerHeight = static_cast<Uint16>((_textureRect.h / _tileSize));
     _cTilesOnTexture = static_cast<Uint16>(((_textureRect.w / _tileSize) * textureTilesPerHeight));
-    _pTileRects = new SDL_Rect[_cTilesOnTexture] {};
+    _pTileRects = pArena->Allocate<SDL_Rect>(_cTilesOnTexture);
     
     // Center the map, so calculate the offsets
     _cxWidth = (_cCols * _tileSize);
@@ -58,8 +60,19 @@ bool TiledMap::Initialize(
     return true;
 }
 
+size_t TiledMap::ArenaBytes(SDL_Rect textureRect, SDL_Rect tileRect, Uint16 countOfIndicies)
+{
+    size_t cTilesOnTexture = (textureRect.w / tileRect.w) * (textureRect.h / tileRect.h);
+    return Arena::Bytes<Uint16>(countOfIndicies) + Arena::Bytes<SDL_Rect>(cTilesOnTexture);
+}
+
 // Loop through the map of indicies and render each tile in order.  Center the map on the screen
 void TiledMap::Render(SDL_Renderer *pSDLRenderer)
+{
+    Render(pSDLRenderer, _pMapIndicies);
+}
+
+void TiledMap::Render(SDL_Renderer *pSDLRenderer, const Uint16 *pMapIndicies)
 {
     SDL_assert(_cRows * _pTileRects[0].w <= _cxScreen); // Every tile is the same size in this implementation
     SDL_assert(_cCols * _pTileRects[0].h <= _cyScreen);
@@ -71,7 +84,7 @@ void TiledMap::Render(SDL_Renderer *pSDLRenderer)
         {
             targetRect.x = (c * _tileSize) + _cxOffset;
             targetRect.y = (r * _tileSize) + _cyOffset;
-            int currentTileIndex = _pMapIndicies[r * _cCols + c];
+            int currentTileIndex = pMapIndicies[r * _cCols + c];
 
             SDL_RenderCopy(
                 pSDLRenderer,                   // Our renderer - everything goes here that draws
@@ -82,6 +95,49 @@ void TiledMap::Render(SDL_Renderer *pSDLRenderer)
     }
 }
 
+void TiledMap::Render(RenderCommandList *pCommands, RenderLayer layer, RenderTexture texture, const Uint16 *pMapIndicies, SDL_Color colorMod)
+{
+    SDL_Rect targetRect = { 0, 0, _tileSize, _tileSize };
+    for (int r = 0; r < _cRows; r++)
+    {
+        for (int c = 0; c < _cCols; c++)
+        {
+            targetRect.x = (c * _tileSize) + _cxOffset;
+            targetRect.y = (r * _tileSize) + _cyOffset;
+            pCommands->Copy(layer, texture, &_pTileRects[pMapIndicies[r * _cCols + c]], &targetRect, colorMod);
+        }
+    }
+}
+
+void TiledMap::RenderOverlay(SDL_Renderer *pSDLRenderer, const SDL_Color *pTileColors)
+{
+    SDL_BlendMode blendMode;
+    SDL_Color drawColor;
+    SDL_GetRenderDrawBlendMode(pSDLRenderer, &blendMode);
+    SDL_GetRenderDrawColor(pSDLRenderer, &drawColor.r, &drawColor.g, &drawColor.b, &drawColor.a);
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, SDL_BLENDMODE_BLEND);
+
+    SDL_Rect targetRect = { 0, 0, _tileSize, _tileSize };
+    for (int r = 0; r < _cRows; r++)
+    {
+        for (int c = 0; c < _cCols; c++)
+        {
+            const SDL_Color &color = pTileColors[r * _cCols + c];
+            if (color.a == 0)
+            {
+                continue;
+            }
+            targetRect.x = (c * _tileSize) + _cxOffset;
+            targetRect.y = (r * _tileSize) + _cyOffset;
+            SDL_SetRenderDrawColor(pSDLRenderer, color.r, color.g, color.b, color.a);
+            SDL_RenderFillRect(pSDLRenderer, &targetRect);
+        }
+    }
+
+    SDL_SetRenderDrawColor(pSDLRenderer, drawColor.r, drawColor.g, drawColor.b, drawColor.a);
+    SDL_SetRenderDrawBlendMode(pSDLRenderer, blendMode);
+}
+
 // returns the "center" pixel of the tile in 2D space - this helps with the sprite logic
 SDL_Point TiledMap::GetTileCoordinates(Uint16 row, Uint16 col)
 {
@@ -0,0 +1,215 @@
+#include "include/tracerecorder.h"
+
+#ifdef ENABLE_PROFILER
+using namespace XplatGameTutorial::PacManClone;
+
+TraceRecorder::TraceRecorder() :
+    _pFile(nullptr),
+    _pThread(nullptr),
+    _pLock(nullptr),
+    _pPending(nullptr),
+    _pBuffers(nullptr),
+    _pCurrent(nullptr),
+    _cQueued(0),
+    _cFree(0),
+    _fClosing(false),
+    _fFirstEvent(true),
+    _cDropped(0),
+    _baseTicks(0),
+    _usPerTick(1000000.0 / SDL_GetPerformanceFrequency())
+{
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    Close();
+}
+
+bool TraceRecorder::Open(const char *szFileName)
+{
+    SDL_assert(!IsOpen());
+    _pFile = fopen(szFileName, "w");
+    if (_pFile == nullptr)
+    {
+        printf("Failed to create trace file %s\n", szFileName);
+        return false;
+    }
+
+    _pBuffers = new Buffer[BufferCount];
+    for (Uint32 i = 1; i < BufferCount; i++)
+    {
+        _pBuffers[i].cEvents = 0;
+        _pFree[_cFree++] = &_pBuffers[i];
+    }
+    _pCurrent = &_pBuffers[0];
+    _pCurrent->cEvents = 0;
+    _cQueued = 0;
+    _fClosing = false;
+    _fFirstEvent = true;
+    _cDropped = 0;
+    _baseTicks = SDL_GetPerformanceCounter();
+
+    fprintf(_pFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    _pLock = SDL_CreateMutex();
+    _pPending = SDL_CreateCond();
+    _pThread = SDL_CreateThread(WriterThread, "TraceWriter", this);
+    if (_pThread == nullptr)
+    {
+        printf("SDL_CreateThread() failed, error = %s\n", SDL_GetError());
+        Close();
+        return false;
+    }
+    return true;
+}
+
+void TraceRecorder::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+
+    if (_pThread != nullptr)
+    {
+        // Whatever is in the current buffer goes too, there's always room in the queue for every buffer
+        SDL_LockMutex(_pLock);
+        if (_pCurrent->cEvents > 0)
+        {
+            _pQueue[_cQueued++] = _pCurrent;
+        }
+        _pCurrent = nullptr;
+        _fClosing = true;
+        SDL_CondSignal(_pPending);
+        SDL_UnlockMutex(_pLock);
+        SDL_WaitThread(_pThread, nullptr);
+        _pThread = nullptr;
+    }
+
+    fprintf(_pFile, "\n]}\n");
+    fclose(_pFile);
+    _pFile = nullptr;
+    if (_cDropped > 0)
+    {
+        printf("Trace writer fell behind, %u events were dropped\n", _cDropped);
+    }
+
+    SDL_DestroyCond(_pPending);
+    SDL_DestroyMutex(_pLock);
+    _pPending = nullptr;
+    _pLock = nullptr;
+    delete[] _pBuffers;
+    _pBuffers = nullptr;
+    _pCurrent = nullptr;
+    _cFree = 0;
+}
+
+void TraceRecorder::Span(const char *szName, const char *szCategory, Uint64 startTicks, Uint64 durationTicks)
+{
+    Event event = { szName, szCategory, nullptr, startTicks, durationTicks, -1, 'X' };
+    Append(event);
+}
+
+void TraceRecorder::Instant(const char *szName, const char *szCategory, Sint32 id, const char *szDetail)
+{
+    Event event = { szName, szCategory, szDetail, SDL_GetPerformanceCounter(), 0, id, 'i' };
+    Append(event);
+}
+
+// Game thread.  Hands the buffer over once it fills up, without a free one to carry on in the event is dropped
+void TraceRecorder::Append(const Event &event)
+{
+    if (_pCurrent == nullptr)
+    {
+        return;
+    }
+
+    if (_pCurrent->cEvents == EventsPerBuffer)
+    {
+        Submit();
+        if (_pCurrent->cEvents == EventsPerBuffer)
+        {
+            _cDropped++;
+            return;
+        }
+    }
+    _pCurrent->events[_pCurrent->cEvents++] = event;
+}
+
+// Game thread.  Queue the current buffer for writing and carry on in a free one, if there is one
+void TraceRecorder::Submit()
+{
+    if (_pCurrent->cEvents == 0)
+    {
+        return;
+    }
+
+    SDL_LockMutex(_pLock);
+    if (_cFree > 0)
+    {
+        _pQueue[_cQueued++] = _pCurrent;
+        _pCurrent = _pFree[--_cFree];
+        _pCurrent->cEvents = 0;
+        SDL_CondSignal(_pPending);
+    }
+    SDL_UnlockMutex(_pLock);
+}
+
+// Waits for full buffers and writes them out until we're closing and there's nothing left
+int TraceRecorder::WriterThread(void *pData)
+{
+    TraceRecorder *pThis = static_cast<TraceRecorder*>(pData);
+
+    SDL_LockMutex(pThis->_pLock);
+    for (;;)
+    {
+        while ((pThis->_cQueued == 0) && !pThis->_fClosing)
+        {
+            SDL_CondWait(pThis->_pPending, pThis->_pLock);
+        }
+        if (pThis->_cQueued == 0)
+        {
+            break;
+        }
+
+        Buffer *pBuffer = pThis->_pQueue[0];
+        pThis->_cQueued--;
+        SDL_memmove(&pThis->_pQueue[0], &pThis->_pQueue[1], pThis->_cQueued * sizeof(pThis->_pQueue[0]));
+        SDL_UnlockMutex(pThis->_pLock);
+
+        pThis->WriteBuffer(pBuffer);
+
+        SDL_LockMutex(pThis->_pLock);
+        pThis->_pFree[pThis->_cFree++] = pBuffer;
+    }
+    SDL_UnlockMutex(pThis->_pLock);
+    return 0;
+}
+
+// Writer thread.  Timestamps are in microseconds, everything is on the one (game) thread of the one process
+void TraceRecorder::WriteBuffer(Buffer *pBuffer)
+{
+    for (Uint32 i = 0; i < pBuffer->cEvents; i++)
+    {
+        const Event &event = pBuffer->events[i];
+        double ts = static_cast<Sint64>(event.startTicks - _baseTicks) * _usPerTick;
+
+        fprintf(_pFile, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":1,\"ts\":%.3f",
+            _fFirstEvent ? "" : ",\n", event.szName, event.szCategory, event.type, ts);
+        if (event.type == 'X')
+        {
+            fprintf(_pFile, ",\"dur\":%.3f}", event.durationTicks * _usPerTick);
+        }
+        else
+        {
+            // Thread scoped instants show up as markers on the game thread's track
+            fprintf(_pFile, ",\"s\":\"t\",\"args\":{\"id\":%d", event.id);
+            if (event.szDetail != nullptr)
+            {
+                fprintf(_pFile, ",\"detail\":\"%s\"", event.szDetail);
+            }
+            fprintf(_pFile, "}}");
+        }
+        _fFirstEvent = false;
+    }
+}
+#endif
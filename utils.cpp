@@ -2,6 +2,11 @@
 #include "include/utils.h"
 #include "SDL_image.h"
 #include <stdio.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
 
 namespace XplatGameTutorial
 {
@@ -61,8 +66,8 @@ namespace PacManClone
         return pTextureOut;
     }
 
-    // Setup SDL and our window
-    bool InitializeSDL(SDL_Window **ppSDLWindow, SDL_Renderer **ppSDLRenderer)
+    // Setup SDL and our window.  With fVsync the presents wait for the display (if the driver will)
+    bool InitializeSDL(SDL_Window **ppSDLWindow, SDL_Renderer **ppSDLRenderer, bool fVsync)
     {
         bool fResult = true;
         *ppSDLWindow = nullptr;
@@ -87,7 +92,14 @@ namespace PacManClone
             {
                 // We now need a renderer to make use of textures, so create one based on the window and we'll use this to update what
                 // the user sees rather than drawing to the SDL_Surface like last time
-                *ppSDLRenderer = SDL_CreateRenderer(*ppSDLWindow, -1, SDL_RENDERER_ACCELERATED);
+                Uint32 vsyncFlag = fVsync ? SDL_RENDERER_PRESENTVSYNC : 0;
+                *ppSDLRenderer = SDL_CreateRenderer(*ppSDLWindow, -1, SDL_RENDERER_ACCELERATED | vsyncFlag);
+                if (*ppSDLRenderer == nullptr)
+                {
+                    // No GPU (a VM or remote desktop, say), SDL can still draw into the window itself
+                    printf("No accelerated renderer (%s), falling back to software\n", SDL_GetError());
+                    *ppSDLRenderer = SDL_CreateRenderer(*ppSDLWindow, -1, SDL_RENDERER_SOFTWARE | vsyncFlag);
+                }
                 if (*ppSDLRenderer == nullptr)
                 {
                     printf("SDL_CreateRender() failed, error = %s\n", SDL_GetError());
@@ -119,6 +131,73 @@ namespace PacManClone
         return fResult;
     }
 
+    // For benchmarks and tools, everything renders to memory so there's no need for a window or even a display.
+    // Textures still load as normal so the game code can't tell the difference
+    bool InitializeSDLHeadless(SDL_Surface **ppSDLSurface, SDL_Renderer **ppSDLRenderer)
+    {
+        bool fResult = true;
+        *ppSDLSurface = nullptr;
+        *ppSDLRenderer = nullptr;
+
+        if (SDL_Init(0) < 0)
+        {
+            printf("SDL_Init() failed, error = %s\n", SDL_GetError());
+            fResult = false;
+        }
+        else
+        {
+            *ppSDLSurface = SDL_CreateRGBSurface(0, Constants::ScreenWidth, Constants::ScreenHeight, 32,
+                0x00FF0000, 0x0000FF00, 0x000000FF, 0xFF000000);
+            if (*ppSDLSurface == nullptr)
+            {
+                printf("SDL_CreateRGBSurface() failed, error = %s\n", SDL_GetError());
+                fResult = false;
+            }
+            else
+            {
+                *ppSDLRenderer = SDL_CreateSoftwareRenderer(*ppSDLSurface);
+                if (*ppSDLRenderer == nullptr)
+                {
+                    printf("SDL_CreateSoftwareRenderer() failed, error = %s\n", SDL_GetError());
+                    fResult = false;
+                }
+                else
+                {
+                    SDL_SetRenderDrawColor(*ppSDLRenderer, Constants::RenderDrawColor.r, Constants::RenderDrawColor.g,
+                        Constants::RenderDrawColor.b, Constants::RenderDrawColor.a);
+
+                    const int cFlagsNeeded = IMG_INIT_PNG | IMG_INIT_JPG;
+                    int iFlagsInitted = IMG_Init(cFlagsNeeded);
+                    if ((iFlagsInitted & (cFlagsNeeded)) != (cFlagsNeeded))
+                    {
+                        printf("IMG_Init() failed, error = %s\n", IMG_GetError());
+                        fResult = false;
+                    }
+                }
+            }
+        }
+        return fResult;
+    }
+
+    double ProcessCpuSeconds()
+    {
+#ifdef _WIN32
+        FILETIME creationTime;
+        FILETIME exitTime;
+        FILETIME kernelTime;
+        FILETIME userTime;
+        GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime);
+        // 100ns units
+        Uint64 kernel = (static_cast<Uint64>(kernelTime.dwHighDateTime) << 32) | kernelTime.dwLowDateTime;
+        Uint64 user = (static_cast<Uint64>(userTime.dwHighDateTime) << 32) | userTime.dwLowDateTime;
+        return (kernel + user) / 10000000.0;
+#else
+        struct rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        return (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + ((usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1000000.0);
+#endif
+    }
+
     // Modified from StackOverflow answer
     double Distance(Uint16 row1, Uint16 col1, Uint16 row2, Uint16 col2)
     {